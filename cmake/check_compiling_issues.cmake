@@ -45,7 +45,7 @@ if(NOT MSVC_VERSION)
 		NO_GCC_VARIADIC_TEMPLATE_BUG)
 
 	if(NOT NO_GCC_VARIADIC_TEMPLATE_BUG)
-		if(TEST_ARRAY OR TEST_VECTOR OR TEST_STRING OR TEST_CONCURRENT_HASHMAP OR TEST_SEGMENT_VECTOR_ARRAY_EXPSIZE OR TEST_SEGMENT_VECTOR_VECTOR_EXPSIZE OR TEST_SEGMENT_VECTOR_VECTOR_FIXEDSIZE OR TEST_ENUMERABLE_THREAD_SPECIFIC)
+		if(TEST_ARRAY OR TEST_VECTOR OR TEST_STRING OR TEST_CONCURRENT_HASHMAP OR TEST_SEGMENT_VECTOR_ARRAY_EXPSIZE OR TEST_SEGMENT_VECTOR_VECTOR_EXPSIZE OR TEST_SEGMENT_VECTOR_VECTOR_FIXEDSIZE OR TEST_ENUMERABLE_THREAD_SPECIFIC OR TEST_CONCURRENT_SEGMENT_VECTOR)
 			message(FATAL_ERROR
 				"Compiler does not support expanding variadic template variables in lambda expressions. "
 				"For more information about compiler requirements, check README.md.")
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * allocation_class - registers allocation classes tailored to persistent types
+ */
+
+#ifndef LIBPMEMOBJ_CPP_ALLOCATION_CLASS_HPP
+#define LIBPMEMOBJ_CPP_ALLOCATION_CLASS_HPP
+
+#include <libpmemobj++/allocation_flag.hpp>
+#include <libpmemobj++/detail/ctl.hpp>
+#include <libpmemobj++/detail/pool_data.hpp>
+#include <libpmemobj++/pexceptions.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj/ctl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+/**
+ * Allocation class sized and aligned for objects of type T.
+ *
+ * libpmemobj serves small allocations from a set of default allocation
+ * classes, which round the size up and prepend a 16-byte header to each
+ * object. For objects which are allocated at very high rates (e.g. nodes
+ * of containers), a class with units of exactly the size of the object
+ * reduces both the per-object overhead and the fragmentation.
+ *
+ * The class is registered through the "heap.alloc_class.new.desc" ctl
+ * on first use in a given pool and its id is cached for as long as the
+ * pool is open. Types with the same unit size and alignment share a class.
+ * Allocation classes are not persistent, the class is registered again
+ * after the pool is reopened. Objects allocated from it are freed as any
+ * other object.
+ *
+ * The pool must have been opened or created by pool_base (or pool<T>).
+ *
+ * The typical usage example would be:
+ * @code
+ * auto flag = allocation_class<node>::flag(pop);
+ * transaction::run(pop, [&] { ptr = make_persistent<node>(flag); });
+ * @endcode
+ */
+template <typename T>
+class allocation_class {
+public:
+	/**
+	 * Size of the header of an object (POBJ_HEADER_COMPACT), which is
+	 * kept in the same unit as the object itself.
+	 */
+	static constexpr std::size_t header_size = 16;
+
+	/**
+	 * @return alignment of the class, 0 if the default one is enough.
+	 */
+	static constexpr std::size_t
+	alignment() noexcept
+	{
+		return alignof(T) > header_size ? alignof(T) : 0;
+	}
+
+	/**
+	 * @return size of a single unit of the class, an object and its
+	 * header rounded up to the alignment.
+	 */
+	static constexpr std::size_t
+	unit_size() noexcept
+	{
+		return round_up(sizeof(T) + header_size,
+				alignment() ? alignment() : header_size);
+	}
+
+	/**
+	 * @return number of units in a single run of the class, so that
+	 * a run takes roughly one chunk (256 KiB) of the heap.
+	 */
+	static constexpr unsigned
+	units_per_block() noexcept
+	{
+		return chunk_size / unit_size() > max_units_per_block
+			? max_units_per_block
+			: (unit_size() > chunk_size
+				   ? 1
+				   : static_cast<unsigned>(chunk_size /
+							   unit_size()));
+	}
+
+	/**
+	 * Returns id of the allocation class, registering it if this is its
+	 * first use in the pool. Thread safe.
+	 *
+	 * @param[in] pop pool in which objects will be allocated.
+	 *
+	 * @return id of the allocation class.
+	 *
+	 * @throw pmem::pool_error if the pool was not opened by libpmemobj-cpp.
+	 * @throw pmem::ctl_error if the class could not be registered.
+	 */
+	static unsigned
+	id(pool_base &pop)
+	{
+		auto *data = static_cast<detail::pool_data *>(
+			pmemobj_get_user_data(pop.handle()));
+		if (data == nullptr)
+			throw pmem::pool_error(
+				"Pool was not opened by libpmemobj-cpp");
+
+		/* the last pool used by this thread, hit on every allocation
+		 * in a single-pool application */
+		static thread_local struct {
+			std::uint64_t generation = 0;
+			unsigned id = 0;
+		} last;
+
+		if (last.generation == data->generation)
+			return last.id;
+
+		unsigned ret;
+		{
+			std::unique_lock<std::mutex> lock(
+				data->alloc_classes_mutex);
+
+			auto key = std::make_pair(unit_size(), alignment());
+			auto it = data->alloc_classes.find(key);
+			if (it != data->alloc_classes.end()) {
+				ret = it->second;
+			} else {
+				pobj_alloc_class_desc desc;
+				desc.unit_size = unit_size();
+				desc.alignment = alignment();
+				desc.units_per_block = units_per_block();
+				desc.header_type = POBJ_HEADER_COMPACT;
+				desc.class_id = 0;
+
+				desc = ctl_set_detail(
+					pop.handle(),
+					"heap.alloc_class.new.desc", desc);
+
+				ret = desc.class_id;
+				data->alloc_classes.emplace(key, ret);
+			}
+		}
+
+		last.generation = data->generation;
+		last.id = ret;
+
+		return ret;
+	}
+
+	/**
+	 * @return flag for make_persistent() which allocates the object from
+	 * the allocation class, see id().
+	 */
+	static allocation_flag
+	flag(pool_base &pop)
+	{
+		return allocation_flag::class_id(id(pop));
+	}
+
+	/**
+	 * @return flag for make_persistent_atomic() which allocates the object
+	 * from the allocation class, see id().
+	 */
+	static allocation_flag_atomic
+	flag_atomic(pool_base &pop)
+	{
+		return allocation_flag_atomic::class_id(id(pop));
+	}
+
+	allocation_class() = delete;
+
+private:
+	static constexpr std::size_t chunk_size = 256 * 1024;
+	static constexpr unsigned max_units_per_block = 1024;
+
+	static constexpr std::size_t
+	round_up(std::size_t size, std::size_t align) noexcept
+	{
+		return (size + align - 1) / align * align;
+	}
+};
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_ALLOCATION_CLASS_HPP */
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2016-2020, Intel Corporation */
+/* Copyright 2016-2021, Intel Corporation */
 
 /**
  * @file
@@ -261,6 +261,10 @@ public:
 			}
 		}
 
+		detail::tx_snapshot_cache::get().insert_allocation(
+			ptr.get(), sizeof(value_type) * cnt);
+		detail::tx_stats_on_alloc(sizeof(value_type) * cnt);
+
 		return ptr;
 	}
 
@@ -278,10 +282,13 @@ public:
 			throw pmem::transaction_scope_error(
 				"refusing to free memory outside of transaction scope");
 
+		detail::tx_stats_on_free(*p.raw_ptr());
 		if (pmemobj_tx_free(*p.raw_ptr()) != 0)
 			throw pmem::transaction_free_error(
 				"failed to delete persistent memory object")
 				.with_pmemobj_errormsg();
+
+		detail::tx_snapshot_cache::get().invalidate();
 	}
 
 	/**
@@ -375,6 +382,8 @@ public:
 			}
 		}
 
+		detail::tx_stats_on_alloc(cnt);
+
 		return ptr;
 	}
 
@@ -392,10 +401,13 @@ public:
 			throw pmem::transaction_scope_error(
 				"refusing to free memory outside of transaction scope");
 
+		detail::tx_stats_on_free(p.raw());
 		if (pmemobj_tx_free(p.raw()) != 0)
 			throw pmem::transaction_free_error(
 				"failed to delete persistent memory object")
 				.with_pmemobj_errormsg();
+
+		detail::tx_snapshot_cache::get().invalidate();
 	}
 
 	/**
@@ -486,6 +498,13 @@ public:
 	{
 	}
 
+	/**
+	 * Constructs allocator with the given allocation policy.
+	 */
+	explicit allocator(Policy const &policy) : Policy(policy)
+	{
+	}
+
 	/**
 	 * Type converting constructor.
 	 */
@@ -495,11 +514,11 @@ public:
 	}
 
 	/**
-	 * Type converting constructor.
+	 * Type converting constructor. Traits are stateless, so only
+	 * the policy is converted.
 	 */
 	template <typename U, typename P, typename T2>
-	explicit allocator(allocator<U, P, T2> const &rhs)
-	    : Policy(rhs), Traits(rhs)
+	explicit allocator(allocator<U, P, T2> const &rhs) : Policy(rhs)
 	{
 	}
 };
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * arena - typed interface to allocator arenas of a pool
+ */
+
+#ifndef LIBPMEMOBJ_CPP_ARENA_HPP
+#define LIBPMEMOBJ_CPP_ARENA_HPP
+
+#include <libpmemobj++/detail/ctl.hpp>
+#include <libpmemobj++/detail/enumerable_thread_specific.hpp>
+#include <libpmemobj++/detail/pool_data.hpp>
+#include <libpmemobj++/pexceptions.hpp>
+#include <libpmemobj++/pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+/**
+ * Arena of the allocator of a pool.
+ *
+ * libpmemobj serves allocations from a number of arenas, each with its own
+ * lock and free lists. By default, threads are assigned to automatic arenas
+ * in a round-robin fashion, so at high thread counts many threads share an
+ * arena and contend on it. This class wraps the heap.arena.*,
+ * heap.narenas.* and heap.thread.arena_id ctl entry points, which allow
+ * creating new arenas and binding threads to them explicitly.
+ *
+ * All methods throw pmem::ctl_error if the underlying ctl call fails.
+ *
+ * The typical usage example would be:
+ * @code
+ * auto a = arena::create(pop);
+ * a.bind(); // allocations of this thread are served from a
+ * @endcode
+ *
+ * For more details, see:
+ * https://pmem.io/pmdk/manpages/linux/master/libpmemobj/pmemobj_ctl_get.3
+ */
+class arena {
+public:
+	/**
+	 * RAII binding of the current thread to an arena, which restores
+	 * the previous binding at the end of the scope.
+	 */
+	class scoped_binding {
+	public:
+		/**
+		 * Binds the current thread to the arena.
+		 */
+		explicit scoped_binding(const arena &a)
+		    : pool(a.pool),
+		      prev(ctl_get_detail<unsigned>(pool,
+						    "heap.thread.arena_id"))
+		{
+			a.bind();
+		}
+
+		/**
+		 * Binds the current thread back to the previous arena.
+		 */
+		~scoped_binding()
+		{
+			try {
+				ctl_set_detail(pool, "heap.thread.arena_id",
+					       prev);
+			} catch (...) {
+				/* the binding is only a hint for the
+				 * allocator */
+			}
+		}
+
+		scoped_binding(const scoped_binding &) = delete;
+		scoped_binding &operator=(const scoped_binding &) = delete;
+
+	private:
+		PMEMobjpool *pool;
+		unsigned prev;
+	};
+
+	/**
+	 * Refers to an existing arena.
+	 *
+	 * @param[in] pop pool of the arena.
+	 * @param[in] id id of the arena, starting from 1.
+	 */
+	arena(pool_base &pop, unsigned id) : arena(pop.handle(), id)
+	{
+	}
+
+	/**
+	 * Creates a new arena in the pool. The new arena is not automatic,
+	 * i.e. it is used only by threads bound to it explicitly.
+	 *
+	 * @param[in] pop pool in which the arena is created.
+	 *
+	 * @return the new arena.
+	 */
+	static arena
+	create(pool_base &pop)
+	{
+		unsigned id = 0;
+		id = ctl_exec_detail(pop.handle(), "heap.arena.create", id);
+
+		return arena(pop, id);
+	}
+
+	/**
+	 * @return the arena from which the current thread allocates.
+	 */
+	static arena
+	current(pool_base &pop)
+	{
+		return arena(pop,
+			     ctl_get_detail<unsigned>(pop.handle(),
+						      "heap.thread.arena_id"));
+	}
+
+	/**
+	 * @return number of all arenas in the pool.
+	 */
+	static unsigned
+	count(pool_base &pop)
+	{
+		return ctl_get_detail<unsigned>(pop.handle(),
+						"heap.narenas.total");
+	}
+
+	/**
+	 * @return number of automatic arenas in the pool.
+	 */
+	static unsigned
+	automatic_count(pool_base &pop)
+	{
+		return ctl_get_detail<unsigned>(pop.handle(),
+						"heap.narenas.automatic");
+	}
+
+	/**
+	 * @return id of the arena.
+	 */
+	unsigned
+	id() const noexcept
+	{
+		return arena_id;
+	}
+
+	/**
+	 * @return number of bytes allocated from the arena.
+	 */
+	std::uint64_t
+	size() const
+	{
+		return ctl_get_detail<std::uint64_t>(pool, entry("size"));
+	}
+
+	/**
+	 * @return true if the arena is assigned to threads automatically.
+	 */
+	bool
+	automatic() const
+	{
+		return ctl_get_detail<int>(pool, entry("automatic")) != 0;
+	}
+
+	/**
+	 * Sets whether the arena is assigned to threads automatically.
+	 *
+	 * @param[in] value whether the arena is automatic.
+	 */
+	void
+	automatic(bool value) const
+	{
+		ctl_set_detail(pool, entry("automatic"), value ? 1 : 0);
+	}
+
+	/**
+	 * Binds the current thread to the arena, all subsequent allocations
+	 * of the thread in the pool are served from it.
+	 */
+	void
+	bind() const
+	{
+		ctl_set_detail(pool, "heap.thread.arena_id", arena_id);
+	}
+
+private:
+	arena(PMEMobjpool *pop, unsigned id) : pool(pop), arena_id(id)
+	{
+	}
+
+	std::string
+	entry(const char *name) const
+	{
+		return "heap.arena." + std::to_string(arena_id) + "." + name;
+	}
+
+	PMEMobjpool *pool;
+	unsigned arena_id;
+};
+
+/**
+ * One arena per worker thread policy.
+ *
+ * Every thread which calls bind() gets its own, non-automatic arena, so
+ * threads do not contend on the allocator. Arenas are assigned by the same
+ * thread indexes as used by enumerable_thread_specific, which are reused
+ * after a thread exits, so the number of arenas does not exceed the
+ * maximal number of threads running at the same time.
+ *
+ * The pool must have been opened or created by pool_base (or pool<T>).
+ */
+class arena_per_thread {
+public:
+	/**
+	 * Returns arena of the current thread, creating it if needed.
+	 * Thread safe.
+	 *
+	 * @param[in] pop pool of the arena.
+	 *
+	 * @throw pmem::pool_error if the pool was not opened by libpmemobj-cpp.
+	 * @throw pmem::ctl_error if the arena could not be created.
+	 */
+	static arena
+	get(pool_base &pop)
+	{
+		auto &data = get_pool_data(pop);
+		auto index = detail::this_thread_index();
+
+		std::unique_lock<std::mutex> lock(data.thread_arenas_mutex);
+
+		auto &arenas = data.thread_arenas;
+		if (index >= arenas.size())
+			arenas.resize(index + 1, 0);
+
+		if (arenas[index] == 0)
+			arenas[index] = arena::create(pop).id();
+
+		return arena(pop, arenas[index]);
+	}
+
+	/**
+	 * Binds the current thread to its arena (see get()). Does nothing
+	 * if the thread is already bound in this pool, so it is cheap enough
+	 * to be called before every allocation. Thread safe.
+	 *
+	 * @param[in] pop pool of the arena.
+	 *
+	 * @throw pmem::pool_error if the pool was not opened by libpmemobj-cpp.
+	 * @throw pmem::ctl_error if the arena could not be created.
+	 */
+	static void
+	bind(pool_base &pop)
+	{
+		/* the last pool in which this thread was bound */
+		static thread_local std::uint64_t bound = 0;
+
+		auto &data = get_pool_data(pop);
+		if (bound == data.generation)
+			return;
+
+		get(pop).bind();
+		bound = data.generation;
+	}
+
+	arena_per_thread() = delete;
+
+private:
+	static detail::pool_data &
+	get_pool_data(pool_base &pop)
+	{
+		auto *data = static_cast<detail::pool_data *>(
+			pmemobj_get_user_data(pop.handle()));
+		if (data == nullptr)
+			throw pmem::pool_error(
+				"Pool was not opened by libpmemobj-cpp");
+
+		return *data;
+	}
+};
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_ARENA_HPP */
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2016-2020, Intel Corporation */
+/* Copyright 2016-2021, Intel Corporation */
 
 /**
  * @file
@@ -13,6 +13,7 @@
 #include <condition_variable>
 
 #include <libpmemobj++/detail/conversions.hpp>
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
 #include <libpmemobj++/mutex.hpp>
 #include <libpmemobj/thread.h>
 
@@ -70,7 +71,7 @@ public:
 	void
 	notify_one()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_cond_signal(pop, &this->pcond))
 			throw pmem::lock_error(
 				ret, std::system_category(),
@@ -86,7 +87,7 @@ public:
 	void
 	notify_all()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_cond_broadcast(pop, &this->pcond))
 			throw pmem::lock_error(
 				ret, std::system_category(),
@@ -475,7 +476,7 @@ private:
 	void
 	wait_impl(mutex &lock)
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_cond_wait(pop, &this->pcond,
 						lock.native_handle()))
 			throw pmem::lock_error(
@@ -504,7 +505,7 @@ private:
 		mutex &lock,
 		const std::chrono::time_point<Clock, Duration> &abs_timeout)
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 
 		/* convert to my clock */
 		const typename Clock::time_point their_now = Clock::now();
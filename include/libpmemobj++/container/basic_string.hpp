@@ -20,6 +20,7 @@
 #include <libpmemobj++/detail/common.hpp>
 #include <libpmemobj++/detail/iterator_traits.hpp>
 #include <libpmemobj++/detail/life.hpp>
+#include <libpmemobj++/detail/string_search.hpp>
 #include <libpmemobj++/persistent_ptr.hpp>
 #include <libpmemobj++/pext.hpp>
 #include <libpmemobj++/slice.hpp>
@@ -39,10 +40,18 @@ namespace obj
  *
  * The implementation is still missing some methods.
  *
+ * Strings of length up to N are stored inline, inside of the object itself
+ * (small string optimization). Longer strings are kept in a separately
+ * allocated buffer. By default, N is chosen so that the whole object fits in
+ * 32 bytes. Bigger N makes the object bigger, but allows to keep longer
+ * strings (e.g. hash map keys) in the same cache line as the rest of the
+ * object, saving an allocation and a pointer dereference on every access.
+ *
  * Simple example of pmem::obj::string usage
  * @snippet string/string.cpp string_example
  */
-template <typename CharT, typename Traits = std::char_traits<CharT>>
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+	  std::size_t N = (32 - 8) / sizeof(CharT) - 1>
 class basic_string {
 public:
 	/* Member types */
@@ -64,7 +73,9 @@ public:
 		std::function<void(persistent_ptr_base &)>;
 
 	/* Number of characters which can be stored using sso */
-	static constexpr size_type sso_capacity = (32 - 8) / sizeof(CharT) - 1;
+	static constexpr size_type sso_capacity = N;
+
+	static_assert(N > 0, "SSO capacity must be greater than 0");
 
 	/* Constructors */
 	basic_string();
@@ -412,11 +423,12 @@ private:
 	void set_sso_size(size_type new_size);
 	void sso_to_large(size_t new_capacity);
 	void large_to_sso();
-	typename basic_string<CharT, Traits>::non_sso_type &non_sso_data();
-	typename basic_string<CharT, Traits>::sso_type &sso_data();
-	const typename basic_string<CharT, Traits>::non_sso_type &
+	typename basic_string<CharT, Traits, N>::non_sso_type &non_sso_data();
+	typename basic_string<CharT, Traits, N>::sso_type &sso_data();
+	const typename basic_string<CharT, Traits, N>::non_sso_type &
 	non_sso_data() const;
-	const typename basic_string<CharT, Traits>::sso_type &sso_data() const;
+	const typename basic_string<CharT, Traits, N>::sso_type &
+	sso_data() const;
 };
 
 /**
@@ -428,8 +440,8 @@ private:
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string()
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string()
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -452,8 +464,8 @@ basic_string<CharT, Traits>::basic_string()
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(size_type count, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(size_type count, CharT ch)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -479,9 +491,9 @@ basic_string<CharT, Traits>::basic_string(size_type count, CharT ch)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(const basic_string &other,
-					  size_type pos, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(const basic_string &other,
+					     size_type pos, size_type count)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -517,9 +529,9 @@ basic_string<CharT, Traits>::basic_string(const basic_string &other,
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(const std::basic_string<CharT> &other,
-					  size_type pos, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(
+	const std::basic_string<CharT> &other, size_type pos, size_type count)
     : basic_string(basic_string_view<CharT>(other), pos, count)
 {
 }
@@ -539,8 +551,8 @@ basic_string<CharT, Traits>::basic_string(const std::basic_string<CharT> &other,
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(const CharT *s, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(const CharT *s, size_type count)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -562,8 +574,8 @@ basic_string<CharT, Traits>::basic_string(const CharT *s, size_type count)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(const CharT *s)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -590,9 +602,9 @@ basic_string<CharT, Traits>::basic_string(const CharT *s)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-basic_string<CharT, Traits>::basic_string(InputIt first, InputIt last)
+basic_string<CharT, Traits, N>::basic_string(InputIt first, InputIt last)
 {
 	auto len = std::distance(first, last);
 	assert(len >= 0);
@@ -618,8 +630,8 @@ basic_string<CharT, Traits>::basic_string(InputIt first, InputIt last)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(const basic_string &other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(const basic_string &other)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -643,8 +655,9 @@ basic_string<CharT, Traits>::basic_string(const basic_string &other)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(const std::basic_string<CharT> &other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(
+	const std::basic_string<CharT> &other)
     : basic_string(other.cbegin(), other.cend())
 {
 }
@@ -663,8 +676,8 @@ basic_string<CharT, Traits>::basic_string(const std::basic_string<CharT> &other)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(basic_string &&other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(basic_string &&other)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -686,8 +699,8 @@ basic_string<CharT, Traits>::basic_string(basic_string &&other)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::basic_string(std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::basic_string(std::initializer_list<CharT> ilist)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -711,9 +724,9 @@ basic_string<CharT, Traits>::basic_string(std::initializer_list<CharT> ilist)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <class T, typename Enable>
-basic_string<CharT, Traits>::basic_string(const T &t)
+basic_string<CharT, Traits, N>::basic_string(const T &t)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -741,10 +754,10 @@ basic_string<CharT, Traits>::basic_string(const T &t)
  * @throw pmem::transaction_scope_error if constructor wasn't called in
  * transaction.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <class T, typename Enable>
-basic_string<CharT, Traits>::basic_string(const T &t, size_type pos,
-					  size_type n)
+basic_string<CharT, Traits, N>::basic_string(const T &t, size_type pos,
+					     size_type n)
 {
 	check_pmem_tx();
 	sso._size = 0;
@@ -767,8 +780,8 @@ basic_string<CharT, Traits>::basic_string(const T &t, size_type pos,
 /**
  * Destructor.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::~basic_string()
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::~basic_string()
 {
 	try {
 		free_data();
@@ -786,9 +799,9 @@ basic_string<CharT, Traits>::~basic_string()
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(const basic_string &other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(const basic_string &other)
 {
 	return assign(other);
 }
@@ -803,9 +816,9 @@ basic_string<CharT, Traits>::operator=(const basic_string &other)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(const std::basic_string<CharT> &other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(const std::basic_string<CharT> &other)
 {
 	return assign(other);
 }
@@ -819,9 +832,9 @@ basic_string<CharT, Traits>::operator=(const std::basic_string<CharT> &other)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(basic_string &&other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(basic_string &&other)
 {
 	return assign(std::move(other));
 }
@@ -834,9 +847,9 @@ basic_string<CharT, Traits>::operator=(basic_string &&other)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(const CharT *s)
 {
 	return assign(s);
 }
@@ -849,9 +862,9 @@ basic_string<CharT, Traits>::operator=(const CharT *s)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(CharT ch)
 {
 	return assign(1, ch);
 }
@@ -865,9 +878,9 @@ basic_string<CharT, Traits>::operator=(CharT ch)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(std::initializer_list<CharT> ilist)
 {
 	return assign(ilist);
 }
@@ -881,10 +894,10 @@ basic_string<CharT, Traits>::operator=(std::initializer_list<CharT> ilist)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <class T, typename Enable>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator=(const T &t)
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator=(const T &t)
 {
 	basic_string_view<CharT, Traits> sv(t);
 	return assign(sv.data(), sv.size());
@@ -900,9 +913,9 @@ basic_string<CharT, Traits>::operator=(const T &t)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(size_type count, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(size_type count, CharT ch)
 {
 	auto pop = get_pool();
 
@@ -920,9 +933,9 @@ basic_string<CharT, Traits>::assign(size_type count, CharT ch)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(const basic_string &other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(const basic_string &other)
 {
 	if (&other == this)
 		return *this;
@@ -945,9 +958,9 @@ basic_string<CharT, Traits>::assign(const basic_string &other)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(const std::basic_string<CharT> &other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(const std::basic_string<CharT> &other)
 {
 	return assign(other.cbegin(), other.cend());
 }
@@ -964,10 +977,10 @@ basic_string<CharT, Traits>::assign(const std::basic_string<CharT> &other)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(const basic_string &other, size_type pos,
-				    size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(const basic_string &other, size_type pos,
+				       size_type count)
 {
 	if (pos > other.size())
 		throw std::out_of_range("Index out of range.");
@@ -1000,10 +1013,10 @@ basic_string<CharT, Traits>::assign(const basic_string &other, size_type pos,
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(const std::basic_string<CharT> &other,
-				    size_type pos, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(const std::basic_string<CharT> &other,
+				       size_type pos, size_type count)
 {
 	if (pos > other.size())
 		throw std::out_of_range("Index out of range.");
@@ -1024,9 +1037,9 @@ basic_string<CharT, Traits>::assign(const std::basic_string<CharT> &other,
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(const CharT *s, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(const CharT *s, size_type count)
 {
 	auto pop = get_pool();
 
@@ -1043,9 +1056,9 @@ basic_string<CharT, Traits>::assign(const CharT *s, size_type count)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(const CharT *s)
 {
 	auto pop = get_pool();
 
@@ -1067,10 +1080,10 @@ basic_string<CharT, Traits>::assign(const CharT *s)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(InputIt first, InputIt last)
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(InputIt first, InputIt last)
 {
 	auto pop = get_pool();
 
@@ -1088,9 +1101,9 @@ basic_string<CharT, Traits>::assign(InputIt first, InputIt last)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(basic_string &&other)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(basic_string &&other)
 {
 	if (&other == this)
 		return *this;
@@ -1114,9 +1127,9 @@ basic_string<CharT, Traits>::assign(basic_string &&other)
  * @throw pmem::transaction_alloc_error when allocating memory for
  * underlying storage in transaction failed.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::assign(std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::assign(std::initializer_list<CharT> ilist)
 {
 	return assign(ilist.begin(), ilist.end());
 }
@@ -1128,9 +1141,9 @@ basic_string<CharT, Traits>::assign(std::initializer_list<CharT> ilist)
  *
  * @param func callback function to call on internal pointer.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::for_each_ptr(for_each_ptr_function func)
+basic_string<CharT, Traits, N>::for_each_ptr(for_each_ptr_function func)
 {
 	if (!is_sso_used()) {
 		non_sso._data.for_each_ptr(func);
@@ -1142,9 +1155,9 @@ basic_string<CharT, Traits>::for_each_ptr(for_each_ptr_function func)
  *
  * @return an iterator pointing to the first element in the string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::begin()
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::begin()
 {
 	return is_sso_used() ? iterator(&*sso_data().begin())
 			     : iterator(&*non_sso_data().begin());
@@ -1155,9 +1168,9 @@ basic_string<CharT, Traits>::begin()
  *
  * @return const iterator pointing to the first element in the string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_iterator
-basic_string<CharT, Traits>::begin() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_iterator
+basic_string<CharT, Traits, N>::begin() const noexcept
 {
 	return cbegin();
 }
@@ -1167,9 +1180,9 @@ basic_string<CharT, Traits>::begin() const noexcept
  *
  * @return const iterator pointing to the first element in the string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_iterator
-basic_string<CharT, Traits>::cbegin() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_iterator
+basic_string<CharT, Traits, N>::cbegin() const noexcept
 {
 	return is_sso_used() ? const_iterator(&*sso_data().cbegin())
 			     : const_iterator(&*non_sso_data().cbegin());
@@ -1180,9 +1193,9 @@ basic_string<CharT, Traits>::cbegin() const noexcept
  *
  * @return iterator referring to the past-the-end element in the string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::end()
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::end()
 {
 	return begin() + static_cast<difference_type>(size());
 }
@@ -1193,9 +1206,9 @@ basic_string<CharT, Traits>::end()
  * @return const_iterator referring to the past-the-end element in the
  * string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_iterator
-basic_string<CharT, Traits>::end() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_iterator
+basic_string<CharT, Traits, N>::end() const noexcept
 {
 	return cbegin() + static_cast<difference_type>(size());
 }
@@ -1206,9 +1219,9 @@ basic_string<CharT, Traits>::end() const noexcept
  * @return const_iterator referring to the past-the-end element in the
  * string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_iterator
-basic_string<CharT, Traits>::cend() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_iterator
+basic_string<CharT, Traits, N>::cend() const noexcept
 {
 	return cbegin() + static_cast<difference_type>(size());
 }
@@ -1219,9 +1232,9 @@ basic_string<CharT, Traits>::cend() const noexcept
  * @return a reverse iterator pointing to the last element in
  * non-reversed string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::reverse_iterator
-basic_string<CharT, Traits>::rbegin()
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::reverse_iterator
+basic_string<CharT, Traits, N>::rbegin()
 {
 	return reverse_iterator(end());
 }
@@ -1232,9 +1245,9 @@ basic_string<CharT, Traits>::rbegin()
  * @return a const reverse iterator pointing to the last element in
  * non-reversed string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reverse_iterator
-basic_string<CharT, Traits>::rbegin() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reverse_iterator
+basic_string<CharT, Traits, N>::rbegin() const noexcept
 {
 	return crbegin();
 }
@@ -1245,9 +1258,9 @@ basic_string<CharT, Traits>::rbegin() const noexcept
  * @return a const reverse iterator pointing to the last element in
  * non-reversed string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reverse_iterator
-basic_string<CharT, Traits>::crbegin() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reverse_iterator
+basic_string<CharT, Traits, N>::crbegin() const noexcept
 {
 	return const_reverse_iterator(cend());
 }
@@ -1258,9 +1271,9 @@ basic_string<CharT, Traits>::crbegin() const noexcept
  * @return reverse iterator referring to character preceding first
  * character in the non-reversed string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::reverse_iterator
-basic_string<CharT, Traits>::rend()
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::reverse_iterator
+basic_string<CharT, Traits, N>::rend()
 {
 	return reverse_iterator(begin());
 }
@@ -1271,9 +1284,9 @@ basic_string<CharT, Traits>::rend()
  * @return const reverse iterator referring to character preceding
  * first character in the non-reversed string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reverse_iterator
-basic_string<CharT, Traits>::rend() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reverse_iterator
+basic_string<CharT, Traits, N>::rend() const noexcept
 {
 	return crend();
 }
@@ -1284,9 +1297,9 @@ basic_string<CharT, Traits>::rend() const noexcept
  * @return const reverse iterator referring to character preceding
  * first character in the non-reversed string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reverse_iterator
-basic_string<CharT, Traits>::crend() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reverse_iterator
+basic_string<CharT, Traits, N>::crend() const noexcept
 {
 	return const_reverse_iterator(cbegin());
 }
@@ -1304,9 +1317,9 @@ basic_string<CharT, Traits>::crend() const noexcept
  * @throw pmem::transaction_error when adding the object to the
  * transaction failed.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::reference
-basic_string<CharT, Traits>::at(size_type n)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::reference
+basic_string<CharT, Traits, N>::at(size_type n)
 {
 	if (n >= size())
 		throw std::out_of_range("string::at");
@@ -1324,9 +1337,9 @@ basic_string<CharT, Traits>::at(size_type n)
  * @throw std::out_of_range if n is not within the range of the
  * container.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reference
-basic_string<CharT, Traits>::at(size_type n) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reference
+basic_string<CharT, Traits, N>::at(size_type n) const
 {
 	return const_at(n);
 }
@@ -1344,9 +1357,9 @@ basic_string<CharT, Traits>::at(size_type n) const
  * @throw std::out_of_range if n is not within the range of the
  * container.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reference
-basic_string<CharT, Traits>::const_at(size_type n) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reference
+basic_string<CharT, Traits, N>::const_at(size_type n) const
 {
 	if (n >= size())
 		throw std::out_of_range("string::const_at");
@@ -1367,9 +1380,9 @@ basic_string<CharT, Traits>::const_at(size_type n) const
  * @throw pmem::transaction_error when adding the object to the
  * transaction failed.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::reference
-	basic_string<CharT, Traits>::operator[](size_type n)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::reference
+	basic_string<CharT, Traits, N>::operator[](size_type n)
 {
 	return is_sso_used() ? sso_data()[n] : non_sso_data()[n];
 }
@@ -1381,9 +1394,9 @@ typename basic_string<CharT, Traits>::reference
  *
  * @return const_reference to element number n in underlying array.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::const_reference
-	basic_string<CharT, Traits>::operator[](size_type n) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::const_reference
+	basic_string<CharT, Traits, N>::operator[](size_type n) const
 {
 	return is_sso_used() ? sso_data()[n] : non_sso_data()[n];
 }
@@ -1401,9 +1414,9 @@ typename basic_string<CharT, Traits>::const_reference
  * string.
  * @throw pmem::transaction_error when snapshotting failed.
  */
-template <typename CharT, typename Traits>
-slice<typename basic_string<CharT, Traits>::pointer>
-basic_string<CharT, Traits>::range(size_type start, size_type n)
+template <typename CharT, typename Traits, std::size_t N>
+slice<typename basic_string<CharT, Traits, N>::pointer>
+basic_string<CharT, Traits, N>::range(size_type start, size_type n)
 {
 	if (start + n > size())
 		throw std::out_of_range("basic_string::range");
@@ -1428,10 +1441,10 @@ basic_string<CharT, Traits>::range(size_type start, size_type n)
  * string.
  * @throw pmem::transaction_error when snapshotting failed.
  */
-template <typename CharT, typename Traits>
-slice<typename basic_string<CharT, Traits>::range_snapshotting_iterator>
-basic_string<CharT, Traits>::range(size_type start, size_type n,
-				   size_type snapshot_size)
+template <typename CharT, typename Traits, std::size_t N>
+slice<typename basic_string<CharT, Traits, N>::range_snapshotting_iterator>
+basic_string<CharT, Traits, N>::range(size_type start, size_type n,
+				      size_type snapshot_size)
 {
 	if (start + n > size())
 		throw std::out_of_range("basic_string::range");
@@ -1454,9 +1467,9 @@ basic_string<CharT, Traits>::range(size_type start, size_type n,
  * @throw std::out_of_range if any element of the range would be outside of the
  * string.
  */
-template <typename CharT, typename Traits>
-slice<typename basic_string<CharT, Traits>::const_iterator>
-basic_string<CharT, Traits>::range(size_type start, size_type n) const
+template <typename CharT, typename Traits, std::size_t N>
+slice<typename basic_string<CharT, Traits, N>::const_iterator>
+basic_string<CharT, Traits, N>::range(size_type start, size_type n) const
 {
 	return crange(start, n);
 }
@@ -1472,9 +1485,9 @@ basic_string<CharT, Traits>::range(size_type start, size_type n) const
  * @throw std::out_of_range if any element of the range would be outside of the
  * string.
  */
-template <typename CharT, typename Traits>
-slice<typename basic_string<CharT, Traits>::const_iterator>
-basic_string<CharT, Traits>::crange(size_type start, size_type n) const
+template <typename CharT, typename Traits, std::size_t N>
+slice<typename basic_string<CharT, Traits, N>::const_iterator>
+basic_string<CharT, Traits, N>::crange(size_type start, size_type n) const
 {
 	if (start + n > size())
 		throw std::out_of_range("basic_string::range");
@@ -1492,9 +1505,9 @@ basic_string<CharT, Traits>::crange(size_type start, size_type n) const
  * @throw pmem::transaction_error when adding the object to the
  * transaction failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 CharT &
-basic_string<CharT, Traits>::front()
+basic_string<CharT, Traits, N>::front()
 {
 	return (*this)[0];
 }
@@ -1504,9 +1517,9 @@ basic_string<CharT, Traits>::front()
  *
  * @return const reference to first element in string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT &
-basic_string<CharT, Traits>::front() const
+basic_string<CharT, Traits, N>::front() const
 {
 	return cfront();
 }
@@ -1519,9 +1532,9 @@ basic_string<CharT, Traits>::front() const
  *
  * @return const reference to first element in string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT &
-basic_string<CharT, Traits>::cfront() const
+basic_string<CharT, Traits, N>::cfront() const
 {
 	return static_cast<const basic_string &>(*this)[0];
 }
@@ -1535,9 +1548,9 @@ basic_string<CharT, Traits>::cfront() const
  * @throw pmem::transaction_error when adding the object to the
  * transaction failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 CharT &
-basic_string<CharT, Traits>::back()
+basic_string<CharT, Traits, N>::back()
 {
 	return (*this)[size() - 1];
 }
@@ -1547,9 +1560,9 @@ basic_string<CharT, Traits>::back()
  *
  * @return const reference to last element in string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT &
-basic_string<CharT, Traits>::back() const
+basic_string<CharT, Traits, N>::back() const
 {
 	return cback();
 }
@@ -1562,9 +1575,9 @@ basic_string<CharT, Traits>::back() const
  *
  * @return const reference to last element in string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT &
-basic_string<CharT, Traits>::cback() const
+basic_string<CharT, Traits, N>::cback() const
 {
 	return static_cast<const basic_string &>(*this)[size() - 1];
 }
@@ -1572,9 +1585,9 @@ basic_string<CharT, Traits>::cback() const
 /**
  * @return number of CharT elements in the string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::size() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::size() const noexcept
 {
 	if (is_sso_used())
 		return get_sso_size();
@@ -1590,9 +1603,9 @@ basic_string<CharT, Traits>::size() const noexcept
  * @throw transaction_error when adding data to the
  * transaction failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 CharT *
-basic_string<CharT, Traits>::data()
+basic_string<CharT, Traits, N>::data()
 {
 	return is_sso_used() ? sso_data().range(0, get_sso_size() + 1).begin()
 			     : non_sso_data().data();
@@ -1616,9 +1629,9 @@ basic_string<CharT, Traits>::data()
  * @throw pmem::transaction_error when snapshotting failed.
  * @throw rethrows destructor exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::erase(size_type index, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::erase(size_type index, size_type count)
 {
 	auto sz = size();
 
@@ -1673,9 +1686,9 @@ basic_string<CharT, Traits>::erase(size_type index, size_type count)
  * @throw pmem::transaction_error when snapshotting failed.
  * @throw rethrows destructor exception.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::erase(const_iterator pos)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::erase(const_iterator pos)
 {
 	return erase(pos, pos + 1);
 }
@@ -1698,9 +1711,9 @@ basic_string<CharT, Traits>::erase(const_iterator pos)
  * @throw pmem::transaction_error when snapshotting failed.
  * @throw rethrows destructor exception.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::erase(const_iterator first, const_iterator last)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::erase(const_iterator first, const_iterator last)
 {
 	size_type index =
 		static_cast<size_type>(std::distance(cbegin(), first));
@@ -1721,9 +1734,9 @@ basic_string<CharT, Traits>::erase(const_iterator first, const_iterator last)
  * @throw pmem::transaction_error when snapshotting failed.
  * @throw rethrows destructor exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::pop_back()
+basic_string<CharT, Traits, N>::pop_back()
 {
 	erase(size() - 1, 1);
 }
@@ -1747,9 +1760,9 @@ basic_string<CharT, Traits>::pop_back()
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(size_type count, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(size_type count, CharT ch)
 {
 	auto sz = size();
 	auto new_size = sz + count;
@@ -1806,9 +1819,9 @@ basic_string<CharT, Traits>::append(size_type count, CharT ch)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(const basic_string &str)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(const basic_string &str)
 {
 	return append(str.data(), str.size());
 }
@@ -1838,10 +1851,10 @@ basic_string<CharT, Traits>::append(const basic_string &str)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(const basic_string &str, size_type pos,
-				    size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(const basic_string &str, size_type pos,
+				       size_type count)
 {
 	auto sz = str.size();
 
@@ -1874,9 +1887,9 @@ basic_string<CharT, Traits>::append(const basic_string &str, size_type pos,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(const CharT *s, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(const CharT *s, size_type count)
 {
 	return append(s, s + count);
 }
@@ -1900,9 +1913,9 @@ basic_string<CharT, Traits>::append(const CharT *s, size_type count)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(const CharT *s)
 {
 	return append(s, traits_type::length(s));
 }
@@ -1928,10 +1941,10 @@ basic_string<CharT, Traits>::append(const CharT *s)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(InputIt first, InputIt last)
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(InputIt first, InputIt last)
 {
 	auto sz = size();
 	auto count = static_cast<size_type>(std::distance(first, last));
@@ -1997,9 +2010,9 @@ basic_string<CharT, Traits>::append(InputIt first, InputIt last)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::append(std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::append(std::initializer_list<CharT> ilist)
 {
 	return append(ilist.begin(), ilist.end());
 }
@@ -2020,9 +2033,9 @@ basic_string<CharT, Traits>::append(std::initializer_list<CharT> ilist)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::push_back(CharT ch)
+basic_string<CharT, Traits, N>::push_back(CharT ch)
 {
 	append(static_cast<size_type>(1), ch);
 }
@@ -2045,9 +2058,9 @@ basic_string<CharT, Traits>::push_back(CharT ch)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator+=(const basic_string &str)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator+=(const basic_string &str)
 {
 	return append(str);
 }
@@ -2071,9 +2084,9 @@ basic_string<CharT, Traits>::operator+=(const basic_string &str)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator+=(const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator+=(const CharT *s)
 {
 	return append(s);
 }
@@ -2094,9 +2107,9 @@ basic_string<CharT, Traits>::operator+=(const CharT *s)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator+=(CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator+=(CharT ch)
 {
 	push_back(ch);
 
@@ -2121,9 +2134,9 @@ basic_string<CharT, Traits>::operator+=(CharT ch)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::operator+=(std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::operator+=(std::initializer_list<CharT> ilist)
 {
 	return append(ilist);
 }
@@ -2149,9 +2162,10 @@ basic_string<CharT, Traits>::operator+=(std::initializer_list<CharT> ilist)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::insert(size_type index, size_type count, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::insert(size_type index, size_type count,
+				       CharT ch)
 {
 	if (index > size())
 		throw std::out_of_range("Index out of range.");
@@ -2184,9 +2198,9 @@ basic_string<CharT, Traits>::insert(size_type index, size_type count, CharT ch)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::insert(size_type index, const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::insert(size_type index, const CharT *s)
 {
 	return insert(index, s, traits_type::length(s));
 }
@@ -2212,10 +2226,10 @@ basic_string<CharT, Traits>::insert(size_type index, const CharT *s)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::insert(size_type index, const CharT *s,
-				    size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::insert(size_type index, const CharT *s,
+				       size_type count)
 {
 	if (index > size())
 		throw std::out_of_range("Index out of range.");
@@ -2247,9 +2261,9 @@ basic_string<CharT, Traits>::insert(size_type index, const CharT *s,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::insert(size_type index, const basic_string &str)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::insert(size_type index, const basic_string &str)
 {
 	return insert(index, str.data(), str.size());
 }
@@ -2276,10 +2290,11 @@ basic_string<CharT, Traits>::insert(size_type index, const basic_string &str)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::insert(size_type index1, const basic_string &str,
-				    size_type index2, size_type count)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::insert(size_type index1,
+				       const basic_string &str,
+				       size_type index2, size_type count)
 {
 	auto sz = str.size();
 
@@ -2313,9 +2328,9 @@ basic_string<CharT, Traits>::insert(size_type index1, const basic_string &str,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::insert(const_iterator pos, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::insert(const_iterator pos, CharT ch)
 {
 	return insert(pos, 1, ch);
 }
@@ -2344,10 +2359,10 @@ basic_string<CharT, Traits>::insert(const_iterator pos, CharT ch)
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::insert(const_iterator pos, size_type count,
-				    CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::insert(const_iterator pos, size_type count,
+				       CharT ch)
 {
 	auto sz = size();
 
@@ -2412,11 +2427,11 @@ basic_string<CharT, Traits>::insert(const_iterator pos, size_type count,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::insert(const_iterator pos, InputIt first,
-				    InputIt last)
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::insert(const_iterator pos, InputIt first,
+				       InputIt last)
 {
 	auto sz = size();
 
@@ -2498,10 +2513,10 @@ basic_string<CharT, Traits>::insert(const_iterator pos, InputIt first,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::insert(const_iterator pos,
-				    std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::insert(const_iterator pos,
+				       std::initializer_list<CharT> ilist)
 {
 	return insert(pos, ilist.begin(), ilist.end());
 }
@@ -2528,10 +2543,10 @@ basic_string<CharT, Traits>::insert(const_iterator pos,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(size_type index, size_type count,
-				     const basic_string &str)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(size_type index, size_type count,
+					const basic_string &str)
 {
 	return replace(index, count, str.data(), str.size());
 }
@@ -2556,10 +2571,11 @@ basic_string<CharT, Traits>::replace(size_type index, size_type count,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
-				     const basic_string &str)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(const_iterator first,
+					const_iterator last,
+					const basic_string &str)
 {
 	return replace(first, last, str.data(), str.data() + str.size());
 }
@@ -2590,11 +2606,11 @@ basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(size_type index, size_type count,
-				     const basic_string &str, size_type index2,
-				     size_type count2)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(size_type index, size_type count,
+					const basic_string &str,
+					size_type index2, size_type count2)
 {
 	auto sz = str.size();
 
@@ -2631,11 +2647,12 @@ basic_string<CharT, Traits>::replace(size_type index, size_type count,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
-				     InputIt first2, InputIt last2)
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(const_iterator first,
+					const_iterator last, InputIt first2,
+					InputIt last2)
 {
 	auto sz = size();
 	auto index = static_cast<size_type>(std::distance(cbegin(), first));
@@ -2714,10 +2731,11 @@ basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
-				     const CharT *s, size_type count2)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(const_iterator first,
+					const_iterator last, const CharT *s,
+					size_type count2)
 {
 	return replace(first, last, s, s + count2);
 }
@@ -2745,10 +2763,10 @@ basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(size_type index, size_type count,
-				     const CharT *s, size_type count2)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(size_type index, size_type count,
+					const CharT *s, size_type count2)
 {
 	if (index > size())
 		throw std::out_of_range("Index out of range.");
@@ -2782,10 +2800,10 @@ basic_string<CharT, Traits>::replace(size_type index, size_type count,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(size_type index, size_type count,
-				     const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(size_type index, size_type count,
+					const CharT *s)
 {
 	return replace(index, count, s, traits_type::length(s));
 }
@@ -2813,10 +2831,10 @@ basic_string<CharT, Traits>::replace(size_type index, size_type count,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(size_type index, size_type count,
-				     size_type count2, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(size_type index, size_type count,
+					size_type count2, CharT ch)
 {
 	if (index > size())
 		throw std::out_of_range("Index out of range.");
@@ -2849,10 +2867,11 @@ basic_string<CharT, Traits>::replace(size_type index, size_type count,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
-				     size_type count2, CharT ch)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(const_iterator first,
+					const_iterator last, size_type count2,
+					CharT ch)
 {
 	auto sz = size();
 	auto index = static_cast<size_type>(std::distance(cbegin(), first));
@@ -2920,10 +2939,10 @@ basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
-				     const CharT *s)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(const_iterator first,
+					const_iterator last, const CharT *s)
 {
 	return replace(first, last, s, traits_type::length(s));
 }
@@ -2950,10 +2969,11 @@ basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
  * @throw pmem::transaction_free_error when freeing old underlying array failed.
  * @throw rethrows constructor's exception.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
-				     std::initializer_list<CharT> ilist)
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::replace(const_iterator first,
+					const_iterator last,
+					std::initializer_list<CharT> ilist)
 {
 	return replace(first, last, ilist.begin(), ilist.end());
 }
@@ -2971,10 +2991,10 @@ basic_string<CharT, Traits>::replace(const_iterator first, const_iterator last,
  *
  * @throw std::out_of_range if index > size().
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::copy(CharT *s, size_type count,
-				  size_type index) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::copy(CharT *s, size_type count,
+				     size_type index) const
 {
 	auto sz = size();
 
@@ -3005,10 +3025,10 @@ basic_string<CharT, Traits>::copy(CharT *s, size_type count,
  *
  * @throw std::out_of_range is pos > size()
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(size_type pos, size_type count1,
-				     const CharT *s, size_type count2) const
+basic_string<CharT, Traits, N>::compare(size_type pos, size_type count1,
+					const CharT *s, size_type count2) const
 {
 	if (pos > size())
 		throw std::out_of_range("Index out of range.");
@@ -3039,9 +3059,10 @@ basic_string<CharT, Traits>::compare(size_type pos, size_type count1,
  * @return Position of the first character of the found substring or
  * npos if no such substring is found.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find(const basic_string &str, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find(const basic_string &str,
+				     size_type pos) const
 	noexcept
 {
 	return find(str.data(), pos, str.size());
@@ -3058,11 +3079,16 @@ basic_string<CharT, Traits>::find(const basic_string &str, size_type pos) const
  * @return Position of the first character of the found substring or
  * npos if no such substring is found.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find(const CharT *s, size_type pos,
-				  size_type count) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find(const CharT *s, size_type pos,
+				     size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find(
+			reinterpret_cast<const char *>(cdata()), size(),
+			reinterpret_cast<const char *>(s), pos, count);
+
 	return operator basic_string_view<CharT, Traits>().find(s, pos, count);
 }
 
@@ -3076,9 +3102,9 @@ basic_string<CharT, Traits>::find(const CharT *s, size_type pos,
  * @return Position of the first character of the found substring or
  * npos if no such substring is found.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find(const CharT *s, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find(const CharT *s, size_type pos) const
 {
 	return find(s, pos, traits_type::length(s));
 }
@@ -3092,9 +3118,9 @@ basic_string<CharT, Traits>::find(const CharT *s, size_type pos) const
  * @return Position of the first character equal to ch, or npos if no such
  * character is found.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find(CharT ch, size_type pos) const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find(CharT ch, size_type pos) const noexcept
 {
 	return find(&ch, pos, 1);
 }
@@ -3109,9 +3135,10 @@ basic_string<CharT, Traits>::find(CharT ch, size_type pos) const noexcept
  * @return Position (as an offset from the start of the string) of the first
  * character of the found substring or npos if no such substring is found
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::rfind(const basic_string &str, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::rfind(const basic_string &str,
+				      size_type pos) const
 	noexcept
 {
 	return rfind(str.cdata(), pos, str.size());
@@ -3133,11 +3160,16 @@ basic_string<CharT, Traits>::rfind(const basic_string &str, size_type pos) const
  * searching for an empty string returns pos unless pos > size(), in which
  * case returns size().
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::rfind(const CharT *s, size_type pos,
-				   size_type count) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::rfind(const CharT *s, size_type pos,
+				      size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_rfind(
+			reinterpret_cast<const char *>(cdata()), size(),
+			reinterpret_cast<const char *>(s), pos, count);
+
 	return operator basic_string_view<CharT, Traits>().rfind(s, pos, count);
 }
 
@@ -3153,9 +3185,9 @@ basic_string<CharT, Traits>::rfind(const CharT *s, size_type pos,
  * @return Position (as an offset from the start of the string) of the first
  * character of the found substring or npos if no such substring is found
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::rfind(const CharT *s, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::rfind(const CharT *s, size_type pos) const
 {
 	return rfind(s, pos, traits_type::length(s));
 }
@@ -3171,9 +3203,9 @@ basic_string<CharT, Traits>::rfind(const CharT *s, size_type pos) const
  * @return Position (as an offset from the start of the string) of the first
  * character equal to ch or npos if no such character is found
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::rfind(CharT ch, size_type pos) const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::rfind(CharT ch, size_type pos) const noexcept
 {
 	return rfind(&ch, pos, 1);
 }
@@ -3187,10 +3219,10 @@ basic_string<CharT, Traits>::rfind(CharT ch, size_type pos) const noexcept
  * @return The position of the first character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_of(const basic_string &str,
-					   size_type pos) const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_of(const basic_string &str,
+					      size_type pos) const noexcept
 {
 	return find_first_of(str.cdata(), pos, str.size());
 }
@@ -3208,11 +3240,16 @@ basic_string<CharT, Traits>::find_first_of(const basic_string &str,
  * @return The position of the first character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_of(const CharT *s, size_type pos,
-					   size_type count) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_of(const CharT *s, size_type pos,
+					      size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_first_of(
+			reinterpret_cast<const char *>(cdata()), size(),
+			reinterpret_cast<const char *>(s), pos, count, false);
+
 	return operator basic_string_view<CharT, Traits>().find_first_of(s, pos,
 									 count);
 }
@@ -3229,9 +3266,10 @@ basic_string<CharT, Traits>::find_first_of(const CharT *s, size_type pos,
  * @return The position of the first character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_of(const CharT *s, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_of(const CharT *s,
+					      size_type pos) const
 {
 	return find_first_of(s, pos, traits_type::length(s));
 }
@@ -3245,9 +3283,9 @@ basic_string<CharT, Traits>::find_first_of(const CharT *s, size_type pos) const
  * @return The position of the first character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_of(CharT ch, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_of(CharT ch, size_type pos) const
 	noexcept
 {
 	return find(ch, pos);
@@ -3262,10 +3300,10 @@ basic_string<CharT, Traits>::find_first_of(CharT ch, size_type pos) const
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_not_of(const basic_string &str,
-					       size_type pos) const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_not_of(const basic_string &str,
+						  size_type pos) const noexcept
 {
 	return find_first_not_of(str.cdata(), pos, str.size());
 }
@@ -3283,11 +3321,16 @@ basic_string<CharT, Traits>::find_first_not_of(const basic_string &str,
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_not_of(const CharT *s, size_type pos,
-					       size_type count) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_not_of(const CharT *s, size_type pos,
+						  size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_first_of(
+			reinterpret_cast<const char *>(cdata()), size(),
+			reinterpret_cast<const char *>(s), pos, count, true);
+
 	return operator basic_string_view<CharT, Traits>().find_first_not_of(
 		s, pos, count);
 }
@@ -3304,10 +3347,10 @@ basic_string<CharT, Traits>::find_first_not_of(const CharT *s, size_type pos,
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_not_of(const CharT *s,
-					       size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_not_of(const CharT *s,
+						  size_type pos) const
 {
 	return find_first_not_of(s, pos, traits_type::length(s));
 }
@@ -3321,9 +3364,9 @@ basic_string<CharT, Traits>::find_first_not_of(const CharT *s,
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_first_not_of(CharT ch, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_first_not_of(CharT ch, size_type pos) const
 	noexcept
 {
 	return find_first_not_of(&ch, pos, 1);
@@ -3338,10 +3381,10 @@ basic_string<CharT, Traits>::find_first_not_of(CharT ch, size_type pos) const
  * @return The position of the last character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_of(const basic_string &str,
-					  size_type pos) const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_of(const basic_string &str,
+					     size_type pos) const noexcept
 {
 	return find_last_of(str.cdata(), pos, str.size());
 }
@@ -3359,11 +3402,16 @@ basic_string<CharT, Traits>::find_last_of(const basic_string &str,
  * @return The position of the last character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_of(const CharT *s, size_type pos,
-					  size_type count) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_of(const CharT *s, size_type pos,
+					     size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_last_of(
+			reinterpret_cast<const char *>(cdata()), size(),
+			reinterpret_cast<const char *>(s), pos, count, false);
+
 	return operator basic_string_view<CharT, Traits>().find_last_of(s, pos,
 									count);
 }
@@ -3380,9 +3428,10 @@ basic_string<CharT, Traits>::find_last_of(const CharT *s, size_type pos,
  * @return The position of the last character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_of(const CharT *s, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_of(const CharT *s,
+					     size_type pos) const
 {
 	return find_last_of(s, pos, traits_type::length(s));
 }
@@ -3396,9 +3445,9 @@ basic_string<CharT, Traits>::find_last_of(const CharT *s, size_type pos) const
  * @return The position of the last character that matches.
  * If no matches are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_of(CharT ch, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_of(CharT ch, size_type pos) const
 	noexcept
 {
 	return rfind(ch, pos);
@@ -3413,10 +3462,10 @@ basic_string<CharT, Traits>::find_last_of(CharT ch, size_type pos) const
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_not_of(const basic_string &str,
-					      size_type pos) const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_not_of(const basic_string &str,
+						 size_type pos) const noexcept
 {
 	return find_last_not_of(str.cdata(), pos, str.size());
 }
@@ -3434,11 +3483,16 @@ basic_string<CharT, Traits>::find_last_not_of(const basic_string &str,
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_not_of(const CharT *s, size_type pos,
-					      size_type count) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_not_of(const CharT *s, size_type pos,
+						 size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_last_of(
+			reinterpret_cast<const char *>(cdata()), size(),
+			reinterpret_cast<const char *>(s), pos, count, true);
+
 	return operator basic_string_view<CharT, Traits>().find_last_not_of(
 		s, pos, count);
 }
@@ -3455,10 +3509,10 @@ basic_string<CharT, Traits>::find_last_not_of(const CharT *s, size_type pos,
  * @return Position of the first character not equal to any of the characters
  * in the given string, or npos if no such character is found.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_not_of(const CharT *s,
-					      size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_not_of(const CharT *s,
+						 size_type pos) const
 {
 	return find_last_not_of(s, pos, traits_type::length(s));
 }
@@ -3472,9 +3526,9 @@ basic_string<CharT, Traits>::find_last_not_of(const CharT *s,
  * @return The position of the first character that does not match.
  * If no such characters are found, the function returns npos.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::find_last_not_of(CharT ch, size_type pos) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::find_last_not_of(CharT ch, size_type pos) const
 	noexcept
 {
 	return find_last_not_of(&ch, pos, 1);
@@ -3488,9 +3542,9 @@ basic_string<CharT, Traits>::find_last_not_of(CharT ch, size_type pos) const
  * @return negative value if *this < other in lexicographical order,
  * zero if *this == other and positive value if *this > other.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(const basic_string &other) const
+basic_string<CharT, Traits, N>::compare(const basic_string &other) const
 {
 	return compare(0, size(), other.cdata(), other.size());
 }
@@ -3503,9 +3557,9 @@ basic_string<CharT, Traits>::compare(const basic_string &other) const
  * @return negative value if *this < other in lexicographical order,
  * zero if *this == other and positive value if *this > other.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(
+basic_string<CharT, Traits, N>::compare(
 	const std::basic_string<CharT> &other) const
 {
 	return compare(0, size(), other.data(), other.size());
@@ -3524,10 +3578,10 @@ basic_string<CharT, Traits>::compare(
  *
  * @throw std::out_of_range is pos > size()
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(size_type pos, size_type count,
-				     const basic_string &other) const
+basic_string<CharT, Traits, N>::compare(size_type pos, size_type count,
+					const basic_string &other) const
 {
 	return compare(pos, count, other.cdata(), other.size());
 }
@@ -3546,9 +3600,9 @@ basic_string<CharT, Traits>::compare(size_type pos, size_type count,
  *
  * @throw std::out_of_range is pos > size()
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(
+basic_string<CharT, Traits, N>::compare(
 	size_type pos, size_type count,
 	const std::basic_string<CharT> &other) const
 {
@@ -3573,11 +3627,11 @@ basic_string<CharT, Traits>::compare(
  *
  * @throw std::out_of_range is pos1 > size() or pos2 > other.size()
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(size_type pos1, size_type count1,
-				     const basic_string &other, size_type pos2,
-				     size_type count2) const
+basic_string<CharT, Traits, N>::compare(size_type pos1, size_type count1,
+					const basic_string &other,
+					size_type pos2, size_type count2) const
 {
 	if (pos2 > other.size())
 		throw std::out_of_range("Index out of range.");
@@ -3606,11 +3660,11 @@ basic_string<CharT, Traits>::compare(size_type pos1, size_type count1,
  *
  * @throw std::out_of_range is pos1 > size() or pos2 > other.size()
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(size_type pos1, size_type count1,
-				     const std::basic_string<CharT> &other,
-				     size_type pos2, size_type count2) const
+basic_string<CharT, Traits, N>::compare(size_type pos1, size_type count1,
+					const std::basic_string<CharT> &other,
+					size_type pos2, size_type count2) const
 {
 	if (pos2 > other.size())
 		throw std::out_of_range("Index out of range.");
@@ -3629,9 +3683,9 @@ basic_string<CharT, Traits>::compare(size_type pos1, size_type count1,
  * @return negative value if *this < s in lexicographical order,
  * zero if *this == s and positive value if *this > s.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(const CharT *s) const
+basic_string<CharT, Traits, N>::compare(const CharT *s) const
 {
 	return compare(0, size(), s, traits_type::length(s));
 }
@@ -3649,10 +3703,10 @@ basic_string<CharT, Traits>::compare(const CharT *s) const
  *
  * @throw std::out_of_range is pos > size()
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 int
-basic_string<CharT, Traits>::compare(size_type pos, size_type count,
-				     const CharT *s) const
+basic_string<CharT, Traits, N>::compare(size_type pos, size_type count,
+					const CharT *s) const
 {
 	return compare(pos, count, s, traits_type::length(s));
 }
@@ -3660,9 +3714,9 @@ basic_string<CharT, Traits>::compare(size_type pos, size_type count,
 /**
  * @return const pointer to underlying data.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT *
-basic_string<CharT, Traits>::cdata() const noexcept
+basic_string<CharT, Traits, N>::cdata() const noexcept
 {
 	return is_sso_used() ? sso_data().cdata() : non_sso_data().cdata();
 }
@@ -3670,9 +3724,9 @@ basic_string<CharT, Traits>::cdata() const noexcept
 /**
  * @return pointer to underlying data.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT *
-basic_string<CharT, Traits>::data() const noexcept
+basic_string<CharT, Traits, N>::data() const noexcept
 {
 	return cdata();
 }
@@ -3680,9 +3734,9 @@ basic_string<CharT, Traits>::data() const noexcept
 /**
  * @return pointer to underlying data.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 const CharT *
-basic_string<CharT, Traits>::c_str() const noexcept
+basic_string<CharT, Traits, N>::c_str() const noexcept
 {
 	return cdata();
 }
@@ -3690,9 +3744,9 @@ basic_string<CharT, Traits>::c_str() const noexcept
 /**
  * @return number of CharT elements in the string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::length() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::length() const noexcept
 {
 	return size();
 }
@@ -3700,9 +3754,9 @@ basic_string<CharT, Traits>::length() const noexcept
 /**
  * @return maximum number of elements the string is able to hold.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::max_size() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::max_size() const noexcept
 {
 	return PMEMOBJ_MAX_ALLOC_SIZE / sizeof(CharT) - 1;
 }
@@ -3711,9 +3765,9 @@ basic_string<CharT, Traits>::max_size() const noexcept
  * @return number of characters that can be held in currently allocated
  * storage.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::capacity() const noexcept
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::capacity() const noexcept
 {
 	return is_sso_used() ? sso_capacity : non_sso_data().capacity() - 1;
 }
@@ -3737,9 +3791,9 @@ basic_string<CharT, Traits>::capacity() const noexcept
  * @throw pmem::transaction_free_error when freeing old underlying array
  * failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::resize(size_type count, CharT ch)
+basic_string<CharT, Traits, N>::resize(size_type count, CharT ch)
 {
 	if (count > max_size())
 		throw std::length_error("Count exceeds max size.");
@@ -3779,9 +3833,9 @@ basic_string<CharT, Traits>::resize(size_type count, CharT ch)
  * @throw pmem::transaction_free_error when freeing old underlying array
  * failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::resize(size_type count)
+basic_string<CharT, Traits, N>::resize(size_type count)
 {
 	resize(count, CharT());
 }
@@ -3806,9 +3860,9 @@ basic_string<CharT, Traits>::resize(size_type count)
  * @throw pmem::transaction_free_error when freeing old underlying array
  * failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::reserve(size_type new_cap)
+basic_string<CharT, Traits, N>::reserve(size_type new_cap)
 {
 	if (new_cap > max_size())
 		throw std::length_error("New capacity exceeds max size.");
@@ -3838,9 +3892,9 @@ basic_string<CharT, Traits>::reserve(size_type new_cap)
  * @throw rethrows constructor's exception.
  * @throw rethrows destructor exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::shrink_to_fit()
+basic_string<CharT, Traits, N>::shrink_to_fit()
 {
 	if (is_sso_used())
 		return;
@@ -3863,9 +3917,9 @@ basic_string<CharT, Traits>::shrink_to_fit()
  * @throw pmem::transaction_error when snapshotting failed.
  * @throw rethrows destructor exception.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::clear()
+basic_string<CharT, Traits, N>::clear()
 {
 	erase(begin(), end());
 }
@@ -3882,9 +3936,9 @@ basic_string<CharT, Traits>::clear()
  * @throw pmem::transaction_free_error when freeing of underlying structure
  * failed.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::free_data()
+basic_string<CharT, Traits, N>::free_data()
 {
 	auto pop = get_pool();
 
@@ -3904,23 +3958,23 @@ basic_string<CharT, Traits>::free_data()
 /**
  * @return true if string is empty, false otherwise.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 bool
-basic_string<CharT, Traits>::empty() const noexcept
+basic_string<CharT, Traits, N>::empty() const noexcept
 {
 	return size() == 0;
 }
 
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 bool
-basic_string<CharT, Traits>::is_sso_used() const
+basic_string<CharT, Traits, N>::is_sso_used() const
 {
 	return (sso._size & _sso_mask) != 0;
 }
 
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::destroy_data()
+basic_string<CharT, Traits, N>::destroy_data()
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -3939,10 +3993,10 @@ basic_string<CharT, Traits>::destroy_data()
  *
  * Return std::distance(first, last) for pair of iterators.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::get_size(InputIt first, InputIt last) const
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::get_size(InputIt first, InputIt last) const
 {
 	return static_cast<size_type>(std::distance(first, last));
 }
@@ -3953,9 +4007,9 @@ basic_string<CharT, Traits>::get_size(InputIt first, InputIt last) const
  *
  * Return count for (count, value)
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::get_size(size_type count, value_type ch) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::get_size(size_type count, value_type ch) const
 {
 	return count;
 }
@@ -3966,9 +4020,9 @@ basic_string<CharT, Traits>::get_size(size_type count, value_type ch) const
  *
  * Return size of other basic_string
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::get_size(const basic_string &other) const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::get_size(const basic_string &other) const
 {
 	return other.size();
 }
@@ -3979,10 +4033,10 @@ basic_string<CharT, Traits>::get_size(const basic_string &other) const
  * - size_type count, CharT value
  * - InputIt first, InputIt last
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename... Args>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::replace_content(Args &&... args)
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::replace_content(Args &&... args)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -4008,10 +4062,10 @@ basic_string<CharT, Traits>::replace_content(Args &&... args)
  * @pre must be called in transaction scope.
  * @pre memory must be allocated before initialization.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename... Args>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::initialize(Args &&... args)
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::initialize(Args &&... args)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -4031,9 +4085,9 @@ basic_string<CharT, Traits>::initialize(Args &&... args)
  *
  * @param[in] n elements to allocate.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::allocate(size_type n)
+basic_string<CharT, Traits, N>::allocate(size_type n)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -4058,10 +4112,10 @@ basic_string<CharT, Traits>::allocate(size_type n)
 /**
  * Initialize sso data. Overload for pair of iterators
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::assign_sso_data(InputIt first, InputIt last)
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::assign_sso_data(InputIt first, InputIt last)
 {
 	auto size = static_cast<size_type>(std::distance(first, last));
 
@@ -4081,9 +4135,9 @@ basic_string<CharT, Traits>::assign_sso_data(InputIt first, InputIt last)
 /**
  * Initialize sso data. Overload for (count, value).
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::assign_sso_data(size_type count, value_type ch)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::assign_sso_data(size_type count, value_type ch)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 	assert(count <= sso_capacity);
@@ -4102,10 +4156,10 @@ basic_string<CharT, Traits>::assign_sso_data(size_type count, value_type ch)
  * Initialize non_sso.data - call constructor of non_sso.data.
  * Overload for pair of iterators.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename InputIt, typename Enable>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::assign_large_data(InputIt first, InputIt last)
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::assign_large_data(InputIt first, InputIt last)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -4122,9 +4176,10 @@ basic_string<CharT, Traits>::assign_large_data(InputIt first, InputIt last)
  * Initialize non_sso.data - call constructor of non_sso.data.
  * Overload for (count, value).
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::assign_large_data(size_type count, value_type ch)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::assign_large_data(size_type count,
+						  value_type ch)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -4139,9 +4194,9 @@ basic_string<CharT, Traits>::assign_large_data(size_type count, value_type ch)
  * Move initialize for basic_string. Expects data is not
  * initialized.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::pointer
-basic_string<CharT, Traits>::move_data(basic_string &&other)
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::pointer
+basic_string<CharT, Traits, N>::move_data(basic_string &&other)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
@@ -4171,9 +4226,9 @@ basic_string<CharT, Traits>::move_data(basic_string &&other)
 /**
  * Swap the content of persistent strings.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::swap(basic_string &other)
+basic_string<CharT, Traits, N>::swap(basic_string &other)
 {
 	pool_base pb = get_pool();
 	flat_transaction::run(pb, [&] {
@@ -4203,8 +4258,9 @@ basic_string<CharT, Traits>::swap(basic_string &other)
 /**
  * Return new view from this string object.
  */
-template <typename CharT, typename Traits>
-basic_string<CharT, Traits>::operator basic_string_view<CharT, Traits>() const
+template <typename CharT, typename Traits, std::size_t N>
+basic_string<CharT, Traits, N>::
+operator basic_string_view<CharT, Traits>() const
 {
 	return basic_string_view<CharT, Traits>(cdata(), length());
 }
@@ -4212,9 +4268,9 @@ basic_string<CharT, Traits>::operator basic_string_view<CharT, Traits>() const
 /**
  * Return pool_base instance and assert that object is on pmem.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 pool_base
-basic_string<CharT, Traits>::get_pool() const
+basic_string<CharT, Traits, N>::get_pool() const
 {
 	return pmem::obj::pool_by_vptr(this);
 }
@@ -4222,9 +4278,9 @@ basic_string<CharT, Traits>::get_pool() const
 /**
  * @throw pmem::pool_error if an object is not in persistent memory.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::check_pmem() const
+basic_string<CharT, Traits, N>::check_pmem() const
 {
 	if (pmemobj_pool_by_ptr(this) == nullptr)
 		throw pmem::pool_error("Object is not on pmem.");
@@ -4233,9 +4289,9 @@ basic_string<CharT, Traits>::check_pmem() const
 /**
  * @throw pmem::transaction_scope_error if called outside of a transaction.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::check_tx_stage_work() const
+basic_string<CharT, Traits, N>::check_tx_stage_work() const
 {
 	if (pmemobj_tx_stage() != TX_STAGE_WORK)
 		throw pmem::transaction_scope_error(
@@ -4246,9 +4302,9 @@ basic_string<CharT, Traits>::check_tx_stage_work() const
  * @throw pmem::pool_error if an object is not in persistent memory.
  * @throw pmem::transaction_scope_error if called outside of a transaction.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::check_pmem_tx() const
+basic_string<CharT, Traits, N>::check_pmem_tx() const
 {
 	check_pmem();
 	check_tx_stage_work();
@@ -4257,10 +4313,10 @@ basic_string<CharT, Traits>::check_pmem_tx() const
 /**
  * Snapshot sso data.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::add_sso_to_tx(size_type idx_first,
-					   size_type num) const
+basic_string<CharT, Traits, N>::add_sso_to_tx(size_type idx_first,
+					      size_type num) const
 {
 	assert(idx_first + num <= sso_capacity + 1);
 	assert(is_sso_used());
@@ -4282,9 +4338,9 @@ basic_string<CharT, Traits>::add_sso_to_tx(size_type idx_first,
 /**
  * Return size of sso string.
  */
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::size_type
-basic_string<CharT, Traits>::get_sso_size() const
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::size_type
+basic_string<CharT, Traits, N>::get_sso_size() const
 {
 	return sso._size & ~_sso_mask;
 }
@@ -4292,9 +4348,9 @@ basic_string<CharT, Traits>::get_sso_size() const
 /**
  * Enable sso string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::enable_sso()
+basic_string<CharT, Traits, N>::enable_sso()
 {
 	/* temporary size_type must be created to avoid undefined reference
 	 * linker error */
@@ -4304,9 +4360,9 @@ basic_string<CharT, Traits>::enable_sso()
 /**
  * Disable sso string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::disable_sso()
+basic_string<CharT, Traits, N>::disable_sso()
 {
 	sso._size &= ~_sso_mask;
 }
@@ -4314,9 +4370,9 @@ basic_string<CharT, Traits>::disable_sso()
 /**
  * Set size for sso.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::set_sso_size(size_type new_size)
+basic_string<CharT, Traits, N>::set_sso_size(size_type new_size)
 {
 	sso._size = new_size | _sso_mask;
 }
@@ -4332,9 +4388,9 @@ basic_string<CharT, Traits>::set_sso_size(size_type new_size)
  *
  * @param[in] new_capacity capacity of constructed large string.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::sso_to_large(size_t new_capacity)
+basic_string<CharT, Traits, N>::sso_to_large(size_t new_capacity)
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 	assert(new_capacity > sso_capacity);
@@ -4366,9 +4422,9 @@ basic_string<CharT, Traits>::sso_to_large(size_t new_capacity)
  *
  * @post sso is used.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 void
-basic_string<CharT, Traits>::large_to_sso()
+basic_string<CharT, Traits, N>::large_to_sso()
 {
 	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 	assert(!is_sso_used());
@@ -4392,33 +4448,33 @@ basic_string<CharT, Traits>::large_to_sso()
 	assert(is_sso_used());
 };
 
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::non_sso_type &
-basic_string<CharT, Traits>::non_sso_data()
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::non_sso_type &
+basic_string<CharT, Traits, N>::non_sso_data()
 {
 	assert(!is_sso_used());
 	return non_sso._data;
 }
 
-template <typename CharT, typename Traits>
-typename basic_string<CharT, Traits>::sso_type &
-basic_string<CharT, Traits>::sso_data()
+template <typename CharT, typename Traits, std::size_t N>
+typename basic_string<CharT, Traits, N>::sso_type &
+basic_string<CharT, Traits, N>::sso_data()
 {
 	assert(is_sso_used());
 	return sso._data;
 }
 
-template <typename CharT, typename Traits>
-const typename basic_string<CharT, Traits>::non_sso_type &
-basic_string<CharT, Traits>::non_sso_data() const
+template <typename CharT, typename Traits, std::size_t N>
+const typename basic_string<CharT, Traits, N>::non_sso_type &
+basic_string<CharT, Traits, N>::non_sso_data() const
 {
 	assert(!is_sso_used());
 	return non_sso._data;
 }
 
-template <typename CharT, typename Traits>
-const typename basic_string<CharT, Traits>::sso_type &
-basic_string<CharT, Traits>::sso_data() const
+template <typename CharT, typename Traits, std::size_t N>
+const typename basic_string<CharT, Traits, N>::sso_type &
+basic_string<CharT, Traits, N>::sso_data() const
 {
 	assert(is_sso_used());
 	return sso._data;
@@ -4428,10 +4484,10 @@ basic_string<CharT, Traits>::sso_data() const
  * Participate in overload resolution only if T is convertible to size_type.
  * Call basic_string &erase(size_type index, size_type count = npos) if enabled.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename T, typename Enable>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::erase(T param)
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::erase(T param)
 {
 	return erase(static_cast<size_type>(param));
 }
@@ -4440,10 +4496,10 @@ basic_string<CharT, Traits>::erase(T param)
  * Participate in overload resolution only if T is not convertible to size_type.
  * Call iterator erase(const_iterator pos) if enabled.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename T, typename Enable>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::erase(T param)
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::erase(T param)
 {
 	return erase(static_cast<const_iterator>(param));
 }
@@ -4453,10 +4509,10 @@ basic_string<CharT, Traits>::erase(T param)
  * Call basic_string &insert(size_type index, size_type count, CharT ch) if
  * enabled.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename T, typename Enable>
-basic_string<CharT, Traits> &
-basic_string<CharT, Traits>::insert(T param, size_type count, CharT ch)
+basic_string<CharT, Traits, N> &
+basic_string<CharT, Traits, N>::insert(T param, size_type count, CharT ch)
 {
 	return insert(static_cast<size_type>(param), count, ch);
 }
@@ -4466,10 +4522,10 @@ basic_string<CharT, Traits>::insert(T param, size_type count, CharT ch)
  * Call iterator insert(const_iterator pos, size_type count, CharT ch) if
  * enabled.
  */
-template <typename CharT, typename Traits>
+template <typename CharT, typename Traits, std::size_t N>
 template <typename T, typename Enable>
-typename basic_string<CharT, Traits>::iterator
-basic_string<CharT, Traits>::insert(T param, size_type count, CharT ch)
+typename basic_string<CharT, Traits, N>::iterator
+basic_string<CharT, Traits, N>::insert(T param, size_type count, CharT ch)
 {
 	return insert(static_cast<const_iterator>(param), count, ch);
 }
@@ -4477,10 +4533,10 @@ basic_string<CharT, Traits>::insert(T param, size_type count, CharT ch)
 /**
  * Non-member equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator==(const basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+operator==(const basic_string<CharT, Traits, N> &lhs,
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.compare(rhs) == 0;
 }
@@ -4488,10 +4544,10 @@ operator==(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member not equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator!=(const basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+operator!=(const basic_string<CharT, Traits, N> &lhs,
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.compare(rhs) != 0;
 }
@@ -4499,10 +4555,10 @@ operator!=(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member less than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<(const basic_string<CharT, Traits> &lhs,
-	  const basic_string<CharT, Traits> &rhs)
+operator<(const basic_string<CharT, Traits, N> &lhs,
+	  const basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.compare(rhs) < 0;
 }
@@ -4510,10 +4566,10 @@ operator<(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member less or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<=(const basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+operator<=(const basic_string<CharT, Traits, N> &lhs,
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.compare(rhs) <= 0;
 }
@@ -4521,10 +4577,10 @@ operator<=(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member greater than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>(const basic_string<CharT, Traits> &lhs,
-	  const basic_string<CharT, Traits> &rhs)
+operator>(const basic_string<CharT, Traits, N> &lhs,
+	  const basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.compare(rhs) > 0;
 }
@@ -4532,10 +4588,10 @@ operator>(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member greater or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>=(const basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+operator>=(const basic_string<CharT, Traits, N> &lhs,
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.compare(rhs) >= 0;
 }
@@ -4543,9 +4599,9 @@ operator>=(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator==(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+operator==(const CharT *lhs, const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) == 0;
 }
@@ -4553,9 +4609,9 @@ operator==(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
 /**
  * Non-member not equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator!=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+operator!=(const CharT *lhs, const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) != 0;
 }
@@ -4563,9 +4619,9 @@ operator!=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
 /**
  * Non-member less than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+operator<(const CharT *lhs, const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) > 0;
 }
@@ -4573,9 +4629,9 @@ operator<(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
 /**
  * Non-member less or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+operator<=(const CharT *lhs, const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) >= 0;
 }
@@ -4583,9 +4639,9 @@ operator<=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
 /**
  * Non-member greater than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+operator>(const CharT *lhs, const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) < 0;
 }
@@ -4593,9 +4649,9 @@ operator>(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
 /**
  * Non-member greater or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+operator>=(const CharT *lhs, const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) <= 0;
 }
@@ -4603,9 +4659,9 @@ operator>=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
 /**
  * Non-member equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator==(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+operator==(const basic_string<CharT, Traits, N> &lhs, const CharT *rhs)
 {
 	return lhs.compare(rhs) == 0;
 }
@@ -4613,9 +4669,9 @@ operator==(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
 /**
  * Non-member not equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator!=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+operator!=(const basic_string<CharT, Traits, N> &lhs, const CharT *rhs)
 {
 	return lhs.compare(rhs) != 0;
 }
@@ -4623,9 +4679,9 @@ operator!=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
 /**
  * Non-member less than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+operator<(const basic_string<CharT, Traits, N> &lhs, const CharT *rhs)
 {
 	return lhs.compare(rhs) < 0;
 }
@@ -4633,9 +4689,9 @@ operator<(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
 /**
  * Non-member less or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+operator<=(const basic_string<CharT, Traits, N> &lhs, const CharT *rhs)
 {
 	return lhs.compare(rhs) <= 0;
 }
@@ -4643,9 +4699,9 @@ operator<=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
 /**
  * Non-member greater than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+operator>(const basic_string<CharT, Traits, N> &lhs, const CharT *rhs)
 {
 	return lhs.compare(rhs) > 0;
 }
@@ -4653,9 +4709,9 @@ operator>(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
 /**
  * Non-member greater or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+operator>=(const basic_string<CharT, Traits, N> &lhs, const CharT *rhs)
 {
 	return lhs.compare(rhs) >= 0;
 }
@@ -4663,10 +4719,10 @@ operator>=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
 /**
  * Non-member equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
 operator==(const std::basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) == 0;
 }
@@ -4674,10 +4730,10 @@ operator==(const std::basic_string<CharT, Traits> &lhs,
 /**
  * Non-member not equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
 operator!=(const std::basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) != 0;
 }
@@ -4685,10 +4741,10 @@ operator!=(const std::basic_string<CharT, Traits> &lhs,
 /**
  * Non-member less than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
 operator<(const std::basic_string<CharT, Traits> &lhs,
-	  const basic_string<CharT, Traits> &rhs)
+	  const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) > 0;
 }
@@ -4696,10 +4752,10 @@ operator<(const std::basic_string<CharT, Traits> &lhs,
 /**
  * Non-member less or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
 operator<=(const std::basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) >= 0;
 }
@@ -4707,10 +4763,10 @@ operator<=(const std::basic_string<CharT, Traits> &lhs,
 /**
  * Non-member greater than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
 operator>(const std::basic_string<CharT, Traits> &lhs,
-	  const basic_string<CharT, Traits> &rhs)
+	  const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) < 0;
 }
@@ -4718,10 +4774,10 @@ operator>(const std::basic_string<CharT, Traits> &lhs,
 /**
  * Non-member greater or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
 operator>=(const std::basic_string<CharT, Traits> &lhs,
-	   const basic_string<CharT, Traits> &rhs)
+	   const basic_string<CharT, Traits, N> &rhs)
 {
 	return rhs.compare(lhs) <= 0;
 }
@@ -4729,9 +4785,9 @@ operator>=(const std::basic_string<CharT, Traits> &lhs,
 /**
  * Non-member equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator==(const basic_string<CharT, Traits> &lhs,
+operator==(const basic_string<CharT, Traits, N> &lhs,
 	   const std::basic_string<CharT, Traits> &rhs)
 {
 	return lhs.compare(rhs) == 0;
@@ -4740,9 +4796,9 @@ operator==(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member not equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator!=(const basic_string<CharT, Traits> &lhs,
+operator!=(const basic_string<CharT, Traits, N> &lhs,
 	   const std::basic_string<CharT, Traits> &rhs)
 {
 	return lhs.compare(rhs) != 0;
@@ -4751,9 +4807,9 @@ operator!=(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member less than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<(const basic_string<CharT, Traits> &lhs,
+operator<(const basic_string<CharT, Traits, N> &lhs,
 	  const std::basic_string<CharT, Traits> &rhs)
 {
 	return lhs.compare(rhs) < 0;
@@ -4762,9 +4818,9 @@ operator<(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member less or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator<=(const basic_string<CharT, Traits> &lhs,
+operator<=(const basic_string<CharT, Traits, N> &lhs,
 	   const std::basic_string<CharT, Traits> &rhs)
 {
 	return lhs.compare(rhs) <= 0;
@@ -4773,9 +4829,9 @@ operator<=(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member greater than operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>(const basic_string<CharT, Traits> &lhs,
+operator>(const basic_string<CharT, Traits, N> &lhs,
 	  const std::basic_string<CharT, Traits> &rhs)
 {
 	return lhs.compare(rhs) > 0;
@@ -4784,9 +4840,9 @@ operator>(const basic_string<CharT, Traits> &lhs,
 /**
  * Non-member greater or equal operator.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 bool
-operator>=(const basic_string<CharT, Traits> &lhs,
+operator>=(const basic_string<CharT, Traits, N> &lhs,
 	   const std::basic_string<CharT, Traits> &rhs)
 {
 	return lhs.compare(rhs) >= 0;
@@ -4795,9 +4851,9 @@ operator>=(const basic_string<CharT, Traits> &lhs,
 /**
  * Swap the content of persistent strings.
  */
-template <class CharT, class Traits>
+template <class CharT, class Traits, std::size_t N>
 void
-swap(basic_string<CharT, Traits> &lhs, basic_string<CharT, Traits> &rhs)
+swap(basic_string<CharT, Traits, N> &lhs, basic_string<CharT, Traits, N> &rhs)
 {
 	return lhs.swap(rhs);
 }
@@ -15,6 +15,8 @@
 #include <libpmemobj++/detail/pair.hpp>
 #include <libpmemobj++/detail/template_helpers.hpp>
 
+#include <libpmemobj++/allocation_class.hpp>
+#include <libpmemobj++/arena.hpp>
 #include <libpmemobj++/defrag.hpp>
 #include <libpmemobj++/make_persistent.hpp>
 #include <libpmemobj++/mutex.hpp>
@@ -858,7 +860,11 @@ public:
 
 	using tls_t = detail::enumerable_thread_specific<tls_data_t>;
 
-	enum feature_flags : uint32_t { FEATURE_CONSISTENT_SIZE = 1 };
+	enum feature_flags : uint32_t {
+		FEATURE_CONSISTENT_SIZE = 1,
+		FEATURE_NODE_ALLOC_CLASS = 2,
+		FEATURE_THREAD_ARENAS = 4
+	};
 
 	/** Compat and incompat features of a layout */
 	struct features {
@@ -1220,15 +1226,28 @@ public:
 	void
 	insert_new_node_internal(bucket *b,
 				 detail::persistent_pool_ptr<Node> &new_node,
-				 Args &&... args)
+				 allocation_flag flag, Args &&... args)
 	{
 		assert(pmemobj_tx_stage() == TX_STAGE_WORK);
 
 		new_node = pmem::obj::make_persistent<Node>(
-			b->node_list, std::forward<Args>(args)...);
+			flag, b->node_list, std::forward<Args>(args)...);
 		b->node_list = new_node; /* bucket is locked */
 	}
 
+	/**
+	 * Get the flag with which new nodes are allocated.
+	 */
+	template <typename Node>
+	allocation_flag
+	node_allocation_flag(pool_base &pop)
+	{
+		if (layout_features.compat & FEATURE_NODE_ALLOC_CLASS)
+			return allocation_class<Node>::flag(pop);
+
+		return allocation_flag::none();
+	}
+
 	/**
 	 * Insert a node.
 	 * @return new size.
@@ -1239,6 +1258,10 @@ public:
 			Args &&... args)
 	{
 		pool_base pop = get_pool_base();
+		auto flag = node_allocation_flag<Node>(pop);
+
+		if (layout_features.compat & FEATURE_THREAD_ARENAS)
+			arena_per_thread::bind(pop);
 
 		/*
 		 * This is only true when called from singlethreaded methods
@@ -1246,7 +1269,7 @@ public:
 		 * modify on_init_size.
 		 */
 		if (pmemobj_tx_stage() == TX_STAGE_WORK) {
-			insert_new_node_internal(b, new_node,
+			insert_new_node_internal(b, new_node, flag,
 						 std::forward<Args>(args)...);
 			this->on_init_size++;
 		} else {
@@ -1254,7 +1277,7 @@ public:
 
 			pmem::obj::flat_transaction::run(pop, [&] {
 				insert_new_node_internal(
-					b, new_node,
+					b, new_node, flag,
 					std::forward<Args>(args)...);
 				++size_diff;
 			});
@@ -1666,6 +1689,8 @@ protected:
 	using hash_map_base::check_mask_race;
 	using hash_map_base::embedded_buckets;
 	using hash_map_base::FEATURE_CONSISTENT_SIZE;
+	using hash_map_base::FEATURE_NODE_ALLOC_CLASS;
+	using hash_map_base::FEATURE_THREAD_ARENAS;
 	using hash_map_base::get_bucket;
 	using hash_map_base::get_pool_base;
 	using hash_map_base::header_features;
@@ -2218,6 +2243,79 @@ public:
 		}
 	}
 
+	/**
+	 * Enables or disables allocation of new nodes from an allocation class
+	 * sized for the node type (see pmem::obj::allocation_class), which
+	 * lowers the space overhead of every element. The setting is stored
+	 * in the pool and applies to elements inserted afterwards. Earlier
+	 * versions of the library ignore it.
+	 * Not thread safe.
+	 *
+	 * @param[in] enable whether to use the allocation class.
+	 *
+	 * @throw pmem::transaction_error in case of PMDK transaction failure.
+	 */
+	void
+	use_node_allocation_class(bool enable = true)
+	{
+		auto pop = get_pool_base();
+
+		flat_transaction::run(pop, [&] {
+			if (enable)
+				layout_features.compat |=
+					FEATURE_NODE_ALLOC_CLASS;
+			else
+				layout_features.compat &= ~static_cast<uint32_t>(
+					FEATURE_NODE_ALLOC_CLASS);
+		});
+	}
+
+	/**
+	 * @return true if new nodes are allocated from an allocation class
+	 * sized for the node type, see use_node_allocation_class().
+	 */
+	bool
+	uses_node_allocation_class() const noexcept
+	{
+		return (layout_features.compat & FEATURE_NODE_ALLOC_CLASS) != 0;
+	}
+
+	/**
+	 * Enables or disables binding of inserting threads to their own
+	 * allocator arenas (see pmem::obj::arena_per_thread), so concurrent
+	 * inserts do not contend on the allocator. A thread stays bound to
+	 * its arena after the insert. The setting is stored in the pool.
+	 * Earlier versions of the library ignore it.
+	 * Not thread safe.
+	 *
+	 * @param[in] enable whether to bind threads to their own arenas.
+	 *
+	 * @throw pmem::transaction_error in case of PMDK transaction failure.
+	 */
+	void
+	use_thread_arenas(bool enable = true)
+	{
+		auto pop = get_pool_base();
+
+		flat_transaction::run(pop, [&] {
+			if (enable)
+				layout_features.compat |= FEATURE_THREAD_ARENAS;
+			else
+				layout_features.compat &= ~static_cast<uint32_t>(
+					FEATURE_THREAD_ARENAS);
+		});
+	}
+
+	/**
+	 * @return true if inserting threads are bound to their own allocator
+	 * arenas, see use_thread_arenas().
+	 */
+	bool
+	uses_thread_arenas() const noexcept
+	{
+		return (layout_features.compat & FEATURE_THREAD_ARENAS) != 0;
+	}
+
 	/**
 	 * Assignment
 	 * Not thread safe.
@@ -12,6 +12,8 @@
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <iterator>
+#include <type_traits>
 
 #include <libpmemobj++/detail/common.hpp>
 
@@ -397,6 +399,59 @@ struct basic_contiguous_iterator
 	}
 };
 
+/**
+ * Type trait which checks if an iterator of type It points to contiguous
+ * memory holding objects of type T. Such iterator can be converted to a pointer
+ * using iterator_to_pointer().
+ */
+template <typename It, typename T>
+struct is_contiguous_iterator_of : std::false_type {
+};
+
+template <typename T>
+struct is_contiguous_iterator_of<T *, T> : std::true_type {
+};
+
+template <typename T>
+struct is_contiguous_iterator_of<const T *, T> : std::true_type {
+};
+
+template <typename T>
+struct is_contiguous_iterator_of<basic_contiguous_iterator<T>, T>
+    : std::true_type {
+};
+
+template <typename It, typename T>
+struct is_contiguous_iterator_of<std::move_iterator<It>, T>
+    : is_contiguous_iterator_of<It, T> {
+};
+
+/**
+ * Returns pointer to the element pointed by the iterator. Does not add
+ * the element to a transaction.
+ */
+template <typename T>
+const T *
+iterator_to_pointer(const T *it)
+{
+	return it;
+}
+
+template <typename T>
+const T *
+iterator_to_pointer(const basic_contiguous_iterator<T> &it)
+{
+	return it.get_ptr();
+}
+
+template <typename It>
+auto
+iterator_to_pointer(const std::move_iterator<It> &it)
+	-> decltype(iterator_to_pointer(it.base()))
+{
+	return iterator_to_pointer(it.base());
+}
+
 } /* namespace detail */
 
 } /* namespace pmem */
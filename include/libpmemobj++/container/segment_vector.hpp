@@ -19,9 +19,15 @@
 #include <libpmemobj++/make_persistent.hpp>
 #include <libpmemobj++/persistent_ptr.hpp>
 #include <libpmemobj++/pext.hpp>
+#include <libpmemobj++/slice.hpp>
 #include <libpmemobj++/transaction.hpp>
 #include <libpmemobj++/utils.hpp>
 
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace pmem
@@ -492,8 +498,9 @@ using exponential_size_vector_policy =
  *
  * @pre if SegmentType for policy is specified it must contain such functions
  * as: default constructor, destructor, assign, operator[], free_data,
- * emplace_back, clear, resize, reserve, erase, capacity(), size(). They must
- * have signature the same as in vector. Also must support iterators.
+ * emplace_back, insert, clear, resize, reserve, erase, swap, capacity(),
+ * size(), cdata(). They must have signature the same as in vector. Also
+ * must support iterators.
  *
  * Policy template represents Segments storing type and managing methods.
  *
@@ -559,6 +566,11 @@ public:
 	void assign(const segment_vector &other);
 	void assign(segment_vector &&other);
 	void assign(const std::vector<T> &other);
+	template <typename InputIt,
+		  typename std::enable_if<
+			  detail::is_input_iterator<InputIt>::value,
+			  InputIt>::type * = nullptr>
+	void shadow_assign(size_type pos, InputIt first, InputIt last);
 
 	/* Destructor */
 	~segment_vector();
@@ -595,6 +607,12 @@ public:
 	slice<const_iterator> range(size_type start, size_type n) const;
 	slice<const_iterator> crange(size_type start, size_type n) const;
 
+	/* Segments */
+	size_type segment_count() const noexcept;
+	slice<pointer> segment(size_type n);
+	slice<const_pointer> segment(size_type n) const;
+	slice<const_pointer> csegment(size_type n) const;
+
 	/* Capacity */
 	constexpr bool empty() const noexcept;
 	size_type size() const noexcept;
@@ -615,6 +633,12 @@ public:
 			  InputIt>::type * = nullptr>
 	iterator insert(const_iterator pos, InputIt first, InputIt last);
 	iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+	template <typename InputIt,
+		  typename std::enable_if<
+			  detail::is_input_iterator<InputIt>::value,
+			  InputIt>::type * = nullptr>
+	iterator append(InputIt first, InputIt last);
+	iterator append_n(size_type count, const value_type &value);
 	template <class... Args>
 	iterator emplace(const_iterator pos, Args &&... args);
 	template <class... Args>
@@ -638,11 +662,34 @@ private:
 			  detail::is_input_iterator<InputIt>::value,
 			  InputIt>::type * = nullptr>
 	void construct_range(size_type idx, InputIt first, InputIt last);
+	template <typename Fill>
+	void append_to_segments(size_type idx, size_type count, Fill &&fill);
+	template <typename InputIt>
+	static void append_range(segment_type &seg, InputIt first, InputIt last,
+				 std::true_type);
+	template <typename InputIt>
+	static void append_range(segment_type &seg, InputIt first, InputIt last,
+				 std::false_type);
 	void insert_gap(size_type idx, size_type count);
+	template <typename InputIt>
+	void shadow_segment(size_type segment, InputIt first, InputIt last);
 	void shrink(size_type size_new);
 	pool_base get_pool() const;
 	void snapshot_data(size_type idx_first, size_type idx_last);
 
+	/*
+	 * Besides appending, segment_type::insert() instantiates code which
+	 * shifts existing elements, hence it can be used only if value_type
+	 * is assignable.
+	 */
+	template <typename InputIt>
+	using is_range_insertable = std::integral_constant<
+		bool,
+		std::is_move_assignable<T>::value &&
+			std::is_assignable<T &,
+					   typename std::iterator_traits<
+						   InputIt>::reference>::value>;
+
 	/* Data structure specific helper functions */
 	reference get(size_type n);
 	const_reference get(size_type n) const;
@@ -659,6 +706,19 @@ private:
 template <typename T, typename Policy>
 void swap(segment_vector<T, Policy> &lhs, segment_vector<T, Policy> &rhs);
 
+/* Parallel algorithms */
+template <typename T, typename Policy, typename F>
+void parallel_for_each(segment_vector<T, Policy> &v, F f,
+		       std::size_t concurrency = 0);
+template <typename T, typename Policy, typename F>
+void parallel_for_each(const segment_vector<T, Policy> &v, F f,
+		       std::size_t concurrency = 0);
+template <typename T, typename Policy, typename R, typename Reduce,
+	  typename Transform>
+R parallel_transform_reduce(const segment_vector<T, Policy> &v, R init,
+			    Reduce reduce, Transform transform,
+			    std::size_t concurrency = 0);
+
 /*
  * Comparison operators between
  * pmem::obj::experimental::segment_vector<T, Policy> and
@@ -1261,6 +1321,78 @@ segment_vector<T, Policy>::assign(const std::vector<T> &other)
 	assign(other.cbegin(), other.cend());
 }
 
+/**
+ * Replaces elements in range [pos, pos + std::distance(first, last)) with
+ * the elements from range [first, last) transactionally. This method is not
+ * specified by STL standards.
+ *
+ * Segments which are entirely covered by the replaced range are not
+ * snapshotted. Instead, the underlying array of such a segment is replaced
+ * by a newly allocated one, in which new elements are constructed. The old
+ * array is freed on transaction commit. Hence, new data is written to
+ * persistent memory only once, instead of being written to the undo log
+ * first. Remaining elements (in segments covered only partially) are
+ * snapshotted and assigned.
+ *
+ * All iterators and references to elements in the fully covered segments
+ * are invalidated.
+ *
+ * @param[in] pos index of the first element to be replaced.
+ * @param[in] first first iterator.
+ * @param[in] last last iterator.
+ *
+ * @pre InputIt must satisfy ForwardIterator.
+ * @pre [first, last) must not refer to elements of this segment_vector.
+ *
+ * @post size() and capacity() remain unchanged.
+ *
+ * @throw std::out_of_range if any replaced element would be outside of
+ * the segment_vector.
+ * @throw rethrows constructor's exception.
+ * @throw rethrows destructor exception.
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory
+ * failed.
+ * @throw pmem::transaction_free_error when freeing underlying segment
+ * failed.
+ */
+template <typename T, typename Policy>
+template <typename InputIt,
+	  typename std::enable_if<detail::is_input_iterator<InputIt>::value,
+				  InputIt>::type *>
+void
+segment_vector<T, Policy>::shadow_assign(size_type pos, InputIt first,
+					 InputIt last)
+{
+	size_type count = static_cast<size_type>(std::distance(first, last));
+	if (pos + count > size())
+		throw std::out_of_range("segment_vector::shadow_assign");
+
+	pool_base pb = get_pool();
+	flat_transaction::run(pb, [&] {
+		size_type idx = pos;
+		while (idx != pos + count) {
+			size_type segment = policy::get_segment(idx);
+			size_type top = policy::segment_top(segment);
+			size_type seg_end = top + _data[segment].size();
+			size_type end = (std::min)(pos + count, seg_end);
+			auto mid = std::next(
+				first, static_cast<difference_type>(end - idx));
+
+			if (idx == top && end == seg_end) {
+				shadow_segment(segment, first, mid);
+			} else {
+				snapshot_data(idx, end);
+				std::copy(first, mid, &get(idx));
+			}
+
+			first = mid;
+			idx = end;
+		}
+	});
+	assert(segment_capacity_validation());
+}
+
 /**
  * Destructor.
  * Note that free_data may throw a transaction_free_error when freeing
@@ -1700,6 +1832,91 @@ segment_vector<T, Policy>::crange(size_type start, size_type n) const
 	return {const_iterator(this, start), const_iterator(this, start + n)};
 }
 
+/**
+ * Returns number of segments which hold elements. All of them, except for
+ * the last one, are full. This method is not specified by STL standards.
+ *
+ * @return number of segments which can be accessed with segment().
+ */
+template <typename T, typename Policy>
+typename segment_vector<T, Policy>::size_type
+segment_vector<T, Policy>::segment_count() const noexcept
+{
+	size_type sz = size();
+
+	return sz == 0 ? 0 : policy::get_segment(sz - 1) + 1;
+}
+
+/**
+ * Returns slice of contiguous elements stored in the n-th segment and adds
+ * them to a transaction. Iterating over segments avoids index arithmetic
+ * performed by segment_iterator on every access. This method is not
+ * specified by STL standards.
+ *
+ * @param[in] n index of the segment.
+ *
+ * @return slice of all elements in the segment.
+ *
+ * @throw std::out_of_range if n >= segment_count().
+ * @throw pmem::transaction_error when adding the object to the
+ * transaction failed.
+ */
+template <typename T, typename Policy>
+slice<typename segment_vector<T, Policy>::pointer>
+segment_vector<T, Policy>::segment(size_type n)
+{
+	if (n >= segment_count())
+		throw std::out_of_range("segment_vector::segment");
+
+	const segment_type &seg = _data.const_at(n);
+	size_type top = policy::segment_top(n);
+
+	snapshot_data(top, top + seg.size());
+
+	auto first = const_cast<pointer>(seg.cdata());
+
+	return {first, first + seg.size()};
+}
+
+/**
+ * Returns const slice of contiguous elements stored in the n-th segment.
+ * This method is not specified by STL standards.
+ *
+ * @param[in] n index of the segment.
+ *
+ * @return slice of all elements in the segment.
+ *
+ * @throw std::out_of_range if n >= segment_count().
+ */
+template <typename T, typename Policy>
+slice<typename segment_vector<T, Policy>::const_pointer>
+segment_vector<T, Policy>::segment(size_type n) const
+{
+	return csegment(n);
+}
+
+/**
+ * Returns const slice of contiguous elements stored in the n-th segment.
+ * This method is not specified by STL standards.
+ *
+ * @param[in] n index of the segment.
+ *
+ * @return slice of all elements in the segment.
+ *
+ * @throw std::out_of_range if n >= segment_count().
+ */
+template <typename T, typename Policy>
+slice<typename segment_vector<T, Policy>::const_pointer>
+segment_vector<T, Policy>::csegment(size_type n) const
+{
+	if (n >= segment_count())
+		throw std::out_of_range("segment_vector::csegment");
+
+	const segment_type &seg = _data.const_at(n);
+
+	return {seg.cdata(), seg.cdata() + seg.size()};
+}
+
 /**
  * Checks whether the container is empty.
  *
@@ -2012,6 +2229,9 @@ segment_vector<T, Policy>::insert(const_iterator pos, InputIt first,
 	size_type idx = static_cast<size_type>(pos - cbegin());
 	size_type gap_size = static_cast<size_type>(std::distance(first, last));
 
+	if (idx == size())
+		return append(first, last);
+
 	pool_base pb = get_pool();
 	flat_transaction::run(pb, [&] {
 		insert_gap(idx, gap_size);
@@ -2056,6 +2276,96 @@ segment_vector<T, Policy>::insert(const_iterator pos,
 	return insert(pos, ilist.begin(), ilist.end());
 }
 
+/**
+ * Appends copies of the elements from range [first, last) to the end of
+ * the container transactionally. This method is not specified by STL
+ * standards.
+ *
+ * All missing segments are allocated at once and each segment is filled
+ * with a single call, so that the size of each segment is modified only
+ * once and trivially copyable elements from contiguous ranges are copied
+ * in bulk. Appending many elements this way is much cheaper than calling
+ * push_back() for each of them.
+ *
+ * @param[in] first first iterator.
+ * @param[in] last last iterator.
+ *
+ * @return Iterator pointing to the first element appended, or end() if
+ * first == last.
+ *
+ * @pre InputIt must satisfy ForwardIterator.
+ *
+ * @post size() == size() + std::distance(first, last)
+ *
+ * @throw rethrows constructor's exception.
+ * @throw std::length_error when new capacity larger than max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory
+ * failed.
+ */
+template <typename T, typename Policy>
+template <typename InputIt,
+	  typename std::enable_if<detail::is_input_iterator<InputIt>::value,
+				  InputIt>::type *>
+typename segment_vector<T, Policy>::iterator
+segment_vector<T, Policy>::append(InputIt first, InputIt last)
+{
+	size_type idx = size();
+	size_type count = static_cast<size_type>(std::distance(first, last));
+
+	pool_base pb = get_pool();
+	flat_transaction::run(pb, [&] {
+		if (capacity() < idx + count)
+			internal_reserve(idx + count);
+		construct_range(idx, first, last);
+	});
+
+	return iterator(this, idx);
+}
+
+/**
+ * Appends count copies of the value to the end of the container
+ * transactionally. Like append(first, last), each segment is modified
+ * only once. This method is not specified by STL standards.
+ *
+ * @param[in] count number of copies to be appended.
+ * @param[in] value element value to be appended.
+ *
+ * @return Iterator pointing to the first element appended, or end() if
+ * count == 0.
+ *
+ * @post size() == size() + count
+ *
+ * @throw rethrows constructor's exception.
+ * @throw std::length_error when new capacity larger than max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory
+ * failed.
+ */
+template <typename T, typename Policy>
+typename segment_vector<T, Policy>::iterator
+segment_vector<T, Policy>::append_n(size_type count, const value_type &value)
+{
+	size_type idx = size();
+
+	pool_base pb = get_pool();
+	flat_transaction::run(pb, [&] {
+		/*
+		 * value might be a reference to an element of this container,
+		 * it stays valid since segments are never relocated.
+		 */
+		if (capacity() < idx + count)
+			internal_reserve(idx + count);
+		append_to_segments(idx, count,
+				   [&](segment_type &seg, size_type n) {
+					   seg.resize(seg.size() + n, value);
+				   });
+	});
+	assert(segment_capacity_validation());
+
+	return iterator(this, idx);
+}
+
 /**
  * Inserts a new element into the container directly before pos. The
  * element is constructed in-place. The arguments args... are forwarded
@@ -2536,14 +2846,89 @@ segment_vector<T, Policy>::construct_range(size_type idx, InputIt first,
 	size_type count = static_cast<size_type>(std::distance(first, last));
 	assert(capacity() >= size() + count);
 
-	for (size_type i = idx; i < idx + count; ++i, ++first) {
-		size_type segment = policy::get_segment(i);
-		_data[segment].emplace_back(*first);
-	}
+	append_to_segments(idx, count, [&](segment_type &seg, size_type n) {
+		auto mid = std::next(first, static_cast<difference_type>(n));
+		append_range(seg, first, mid, is_range_insertable<InputIt>());
+		first = mid;
+	});
 
 	assert(segment_capacity_validation());
 }
 
+/**
+ * Private helper function. Must be called during transaction. Assumes
+ * that there is free space for additional elements. Splits range
+ * [idx, idx + count) into parts which belong to consecutive segments and
+ * calls fill(segment, n) once per segment, which must append n elements
+ * to it. Hence, each segment is modified (and its size updated) only
+ * once, instead of once per element.
+ *
+ * @param[in] idx index of the first element to be appended, equal to
+ * size().
+ * @param[in] count number of elements to be appended.
+ * @param[in] fill functor which appends elements to a segment.
+ *
+ * @pre must be called in transaction scope.
+ * @pre capacity() >= size() + count
+ */
+template <typename T, typename Policy>
+template <typename Fill>
+void
+segment_vector<T, Policy>::append_to_segments(size_type idx, size_type count,
+					      Fill &&fill)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+	assert(capacity() >= idx + count);
+
+	size_type end = idx + count;
+	while (idx != end) {
+		size_type segment = policy::get_segment(idx);
+		size_type segment_end = (std::min)(
+			end,
+			policy::segment_top(segment) +
+				policy::segment_size(segment));
+
+		fill(_data[segment], segment_end - idx);
+
+		idx = segment_end;
+	}
+}
+
+/**
+ * Private helper function. Must be called during transaction. Appends
+ * elements from the range [first, last) to the segment with a single
+ * insert, which constructs them in bulk if possible.
+ *
+ * @pre must be called in transaction scope.
+ * @pre seg.capacity() >= seg.size() + std::distance(first, last)
+ */
+template <typename T, typename Policy>
+template <typename InputIt>
+void
+segment_vector<T, Policy>::append_range(segment_type &seg, InputIt first,
+					InputIt last, std::true_type)
+{
+	seg.insert(seg.cend(), first, last);
+}
+
+/**
+ * Private helper function. Must be called during transaction. Appends
+ * elements from the range [first, last) to the segment one by one, for
+ * value_type which is not assignable.
+ *
+ * @pre must be called in transaction scope.
+ * @pre seg.capacity() >= seg.size() + std::distance(first, last)
+ */
+template <typename T, typename Policy>
+template <typename InputIt>
+void
+segment_vector<T, Policy>::append_range(segment_type &seg, InputIt first,
+					InputIt last, std::false_type)
+{
+	for (; first != last; ++first)
+		seg.emplace_back(*first);
+}
+
 /**
  * Private helper function. Must be called during transaction. Inserts a
  * gap for count elements starting at index idx. If there is not enough
@@ -2590,6 +2975,41 @@ segment_vector<T, Policy>::insert_gap(size_type idx, size_type count)
 	assert(segment_capacity_validation());
 }
 
+/**
+ * Private helper function. Must be called during transaction. Replaces
+ * the underlying array of the segment with a newly allocated one, which
+ * holds elements from the range [first, last). Old array is freed on
+ * transaction commit, so its contents do not have to be snapshotted.
+ *
+ * @param[in] segment index of the segment to be replaced.
+ * @param[in] first first iterator.
+ * @param[in] last last iterator.
+ *
+ * @pre must be called in transaction scope.
+ * @pre std::distance(first, last) == _data[segment].size()
+ * @pre [first, last) must not refer to elements of the segment.
+ *
+ * @throw rethrows constructor's exception.
+ * @throw rethrows destructor exception.
+ * @throw pmem::transaction_alloc_error when allocating new memory
+ * failed.
+ * @throw pmem::transaction_free_error when freeing old segment failed.
+ */
+template <typename T, typename Policy>
+template <typename InputIt>
+void
+segment_vector<T, Policy>::shadow_segment(size_type segment, InputIt first,
+					  InputIt last)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+	assert(static_cast<size_type>(std::distance(first, last)) ==
+	       _data[segment].size());
+
+	_data[segment].free_data();
+	_data[segment].reserve(policy::segment_size(segment));
+	_data[segment].assign(first, last);
+}
+
 /**
  * Private helper function. Must be called during transaction. Destroys
  * elements in underlying array beginning from position size_new.
@@ -2752,6 +3172,242 @@ swap(segment_vector<T, Policy> &lhs, segment_vector<T, Policy> &rhs)
 	lhs.swap(rhs);
 }
 
+namespace segment_vector_internal
+{
+
+/* Minimal number of elements processed by a single thread at once */
+static constexpr std::size_t parallel_min_grain = 256;
+
+/**
+ * Returns number of threads used by parallel algorithms, if concurrency
+ * was not specified.
+ */
+inline std::size_t
+parallel_concurrency(std::size_t concurrency)
+{
+	if (concurrency == 0)
+		concurrency = std::thread::hardware_concurrency();
+
+	return concurrency == 0 ? 1 : concurrency;
+}
+
+/**
+ * Splits segments into chunks of contiguous elements and calls
+ * f(thread_index, first, last) for each of them on up to concurrency
+ * threads (including the calling one). Each segment is split into chunks,
+ * so that large segments are shared between threads.
+ *
+ * If f throws, remaining chunks are not processed and the first exception
+ * is rethrown after all threads finish.
+ */
+template <typename Pointer, typename F>
+void
+parallel_for_segments(const std::vector<slice<Pointer>> &segments,
+		      std::size_t concurrency, F &&f)
+{
+	std::size_t total = 0;
+	for (auto &s : segments)
+		total += s.size();
+
+	std::size_t grain =
+		(std::max)(total / (4 * concurrency), parallel_min_grain);
+
+	std::vector<slice<Pointer>> chunks;
+	for (auto &s : segments) {
+		for (auto first = s.begin(); first != s.end();) {
+			auto left = static_cast<std::size_t>(s.end() - first);
+			auto n = (std::min)(grain, left);
+			chunks.emplace_back(first, first + n);
+			first += n;
+		}
+	}
+
+	concurrency = (std::min)(concurrency, chunks.size());
+
+	std::atomic<std::size_t> next(0);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	auto worker = [&](std::size_t thread_index) {
+		try {
+			for (auto i = next++; i < chunks.size(); i = next++)
+				f(thread_index, chunks[i].begin(),
+				  chunks[i].end());
+		} catch (...) {
+			std::unique_lock<std::mutex> lock(error_mutex);
+			if (!error)
+				error = std::current_exception();
+			next = chunks.size();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	try {
+		for (std::size_t i = 1; i < concurrency; ++i)
+			threads.emplace_back(worker, i);
+	} catch (...) {
+		next = chunks.size();
+		for (auto &t : threads)
+			t.join();
+		throw;
+	}
+
+	worker(0);
+
+	for (auto &t : threads)
+		t.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+} /* segment_vector_internal namespace */
+
+/**
+ * Calls f for each element of the segment_vector, using up to concurrency
+ * threads. Whole segments (or their large parts) are handed to the threads,
+ * so each of them iterates over contiguous memory.
+ *
+ * If called inside a transaction, all elements are added to it by the
+ * calling thread, before any of them is modified. Otherwise, each processed
+ * chunk of elements is persisted after f is called for it. f must not start
+ * transactions. Order in which f is called for elements is unspecified.
+ *
+ * @param[in] v segment_vector which elements are processed.
+ * @param[in] f functor called with reference to each element.
+ * @param[in] concurrency maximal number of threads, if 0,
+ * std::thread::hardware_concurrency() is used.
+ *
+ * @throw pmem::transaction_error when adding the object to the
+ * transaction failed.
+ * @throw std::system_error if a thread could not be started.
+ * @throw rethrows the first exception thrown by f.
+ */
+template <typename T, typename Policy, typename F>
+void
+parallel_for_each(segment_vector<T, Policy> &v, F f, std::size_t concurrency)
+{
+	using pointer = typename segment_vector<T, Policy>::pointer;
+
+	std::vector<slice<pointer>> segments;
+	for (std::size_t i = 0; i < v.segment_count(); ++i)
+		segments.push_back(v.segment(i));
+
+	bool persist = pmemobj_tx_stage() == TX_STAGE_NONE;
+	auto pop = pool_by_vptr(&v);
+
+	segment_vector_internal::parallel_for_segments(
+		segments,
+		segment_vector_internal::parallel_concurrency(concurrency),
+		[&](std::size_t, pointer first, pointer last) {
+			for (auto it = first; it != last; ++it)
+				f(*it);
+
+			if (persist)
+				pop.persist(first,
+					    sizeof(T) *
+						    static_cast<std::size_t>(
+							    last - first));
+		});
+}
+
+/**
+ * Calls f for each element of the segment_vector, using up to concurrency
+ * threads. Whole segments (or their large parts) are handed to the threads,
+ * so each of them iterates over contiguous memory. Order in which f is
+ * called for elements is unspecified.
+ *
+ * @param[in] v segment_vector which elements are processed.
+ * @param[in] f functor called with const reference to each element.
+ * @param[in] concurrency maximal number of threads, if 0,
+ * std::thread::hardware_concurrency() is used.
+ *
+ * @throw std::system_error if a thread could not be started.
+ * @throw rethrows the first exception thrown by f.
+ */
+template <typename T, typename Policy, typename F>
+void
+parallel_for_each(const segment_vector<T, Policy> &v, F f,
+		  std::size_t concurrency)
+{
+	using const_pointer = typename segment_vector<T, Policy>::const_pointer;
+
+	std::vector<slice<const_pointer>> segments;
+	for (std::size_t i = 0; i < v.segment_count(); ++i)
+		segments.push_back(v.csegment(i));
+
+	segment_vector_internal::parallel_for_segments(
+		segments,
+		segment_vector_internal::parallel_concurrency(concurrency),
+		[&](std::size_t, const_pointer first, const_pointer last) {
+			for (auto it = first; it != last; ++it)
+				f(*it);
+		});
+}
+
+/**
+ * Applies transform to each element of the segment_vector and reduces the
+ * results, together with init, using reduce. Elements are processed by up
+ * to concurrency threads, each of them iterating over contiguous parts of
+ * segments.
+ *
+ * Like std::transform_reduce, the result is nondeterministic if reduce is
+ * not associative or not commutative.
+ *
+ * @param[in] v segment_vector which elements are processed.
+ * @param[in] init initial value of the reduction.
+ * @param[in] reduce binary functor which combines two values of type R.
+ * @param[in] transform functor which converts const reference to an element
+ * to a value of type R.
+ * @param[in] concurrency maximal number of threads, if 0,
+ * std::thread::hardware_concurrency() is used.
+ *
+ * @return result of the reduction.
+ *
+ * @throw std::system_error if a thread could not be started.
+ * @throw rethrows the first exception thrown by reduce or transform.
+ */
+template <typename T, typename Policy, typename R, typename Reduce,
+	  typename Transform>
+R
+parallel_transform_reduce(const segment_vector<T, Policy> &v, R init,
+			  Reduce reduce, Transform transform,
+			  std::size_t concurrency)
+{
+	using const_pointer = typename segment_vector<T, Policy>::const_pointer;
+
+	std::vector<slice<const_pointer>> segments;
+	for (std::size_t i = 0; i < v.segment_count(); ++i)
+		segments.push_back(v.csegment(i));
+
+	concurrency =
+		segment_vector_internal::parallel_concurrency(concurrency);
+
+	/* Partial result of each thread, created by its first chunk */
+	std::vector<std::unique_ptr<R>> partials(concurrency);
+
+	segment_vector_internal::parallel_for_segments(
+		segments, concurrency,
+		[&](std::size_t thread_index, const_pointer first,
+		    const_pointer last) {
+			auto &partial = partials[thread_index];
+			auto it = first;
+
+			if (!partial)
+				partial.reset(new R(transform(*it++)));
+
+			for (; it != last; ++it)
+				*partial = reduce(std::move(*partial),
+						  transform(*it));
+		});
+
+	for (auto &partial : partials)
+		if (partial)
+			init = reduce(std::move(init), std::move(*partial));
+
+	return init;
+}
+
 /**
  * Comparison operator. Compares the contents of two containers.
  *
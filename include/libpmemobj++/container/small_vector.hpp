@@ -0,0 +1,2364 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Vector container with small buffer optimization and std::vector
+ * compatible interface.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_SMALL_VECTOR_HPP
+#define LIBPMEMOBJ_CPP_SMALL_VECTOR_HPP
+
+#include <libpmemobj++/container/detail/contiguous_iterator.hpp>
+#include <libpmemobj++/container/vector.hpp>
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/detail/iterator_traits.hpp>
+#include <libpmemobj++/detail/life.hpp>
+#include <libpmemobj++/detail/temp_value.hpp>
+#include <libpmemobj++/detail/tx_stats.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pext.hpp>
+#include <libpmemobj++/transaction.hpp>
+#include <libpmemobj++/utils.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+/**
+ * pmem::obj::small_vector - persistent container with std::vector compatible
+ * interface, which stores up to N elements inside of the object.
+ *
+ * Elements are kept in the inline buffer (small buffer optimization, similar
+ * to the SSO in pmem::obj::basic_string) as long as there are at most N of
+ * them. This avoids separate allocation and an additional pointer
+ * dereference for short containers. When more elements are needed, they are
+ * moved to pmem::obj::vector which replaces the inline buffer.
+ *
+ * All iterators, pointers and references to the elements are invalidated
+ * when elements are moved between the inline buffer and the heap.
+ */
+template <typename T, std::size_t N>
+class small_vector {
+	static_assert(N > 0, "Inline capacity must be greater than 0");
+
+public:
+	/* Member types */
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = value_type &;
+	using const_reference = const value_type &;
+	using pointer = value_type *;
+	using const_pointer = const value_type *;
+	using iterator = pmem::detail::basic_contiguous_iterator<T>;
+	using const_iterator = const_pointer;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	/* Constructors */
+	small_vector();
+	small_vector(size_type count, const value_type &value);
+	explicit small_vector(size_type count);
+	template <typename InputIt,
+		  typename std::enable_if<
+			  detail::is_input_iterator<InputIt>::value,
+			  InputIt>::type * = nullptr>
+	small_vector(InputIt first, InputIt last);
+	small_vector(const small_vector &other);
+	small_vector(small_vector &&other);
+	small_vector(std::initializer_list<T> init);
+
+	/* Assign operators */
+	small_vector &operator=(const small_vector &other);
+	small_vector &operator=(small_vector &&other);
+	small_vector &operator=(std::initializer_list<T> ilist);
+
+	/* Assign methods */
+	void assign(size_type count, const T &value);
+	template <typename InputIt,
+		  typename std::enable_if<
+			  detail::is_input_iterator<InputIt>::value,
+			  InputIt>::type * = nullptr>
+	void assign(InputIt first, InputIt last);
+	void assign(std::initializer_list<T> ilist);
+	void assign(const small_vector &other);
+	void assign(small_vector &&other);
+
+	/* Destructor */
+	~small_vector();
+
+	/* Element access */
+	reference at(size_type n);
+	const_reference at(size_type n) const;
+	const_reference const_at(size_type n) const;
+	reference operator[](size_type n);
+	const_reference operator[](size_type n) const;
+	reference front();
+	const_reference front() const;
+	const_reference cfront() const;
+	reference back();
+	const_reference back() const;
+	const_reference cback() const;
+	value_type *data();
+	const value_type *data() const noexcept;
+	const value_type *cdata() const noexcept;
+
+	/* Iterators */
+	iterator begin();
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+	iterator end();
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+	reverse_iterator rbegin();
+	const_reverse_iterator rbegin() const noexcept;
+	const_reverse_iterator crbegin() const noexcept;
+	reverse_iterator rend();
+	const_reverse_iterator rend() const noexcept;
+	const_reverse_iterator crend() const noexcept;
+
+	/* Capacity */
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	constexpr size_type max_size() const noexcept;
+	void reserve(size_type capacity_new);
+	size_type capacity() const noexcept;
+	void shrink_to_fit();
+
+	/* Modifiers */
+	void clear();
+	void free_data();
+	iterator insert(const_iterator pos, const T &value);
+	iterator insert(const_iterator pos, T &&value);
+	template <class... Args>
+	iterator emplace(const_iterator pos, Args &&... args);
+	template <class... Args>
+	reference emplace_back(Args &&... args);
+	iterator erase(const_iterator pos);
+	iterator erase(const_iterator first, const_iterator last);
+	void push_back(const T &value);
+	void push_back(T &&value);
+	void pop_back();
+	void resize(size_type count);
+	void resize(size_type count, const value_type &value);
+	void swap(small_vector &other);
+
+private:
+	using sbo_storage_type =
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+	using non_sbo_type = vector<value_type>;
+
+	/**
+	 * This union holds up to N elements inside of the inline buffer or
+	 * all elements inside a vector. If vector is used, it must be
+	 * manually created and destroyed.
+	 *
+	 * _size is used to store number of elements in case when the inline
+	 * buffer is used. It is the same type as first member of vector, so
+	 * it can be safely accessed through both sbo (_size variable) and
+	 * non_sbo (as size in a vector) no matter which one is used - see
+	 * the description of a similar union in pmem::obj::basic_string.
+	 */
+	union {
+		struct {
+			/*
+			 * EXACTLY the same type as first member in vector
+			 * Holds size of the inline buffer, bit specified by
+			 * _sbo_mask indicates if the inline buffer is used.
+			 */
+			p<size_type> _size;
+
+			sbo_storage_type _data[N];
+		} sbo;
+
+		struct {
+			non_sbo_type _data;
+		} non_sbo;
+	};
+
+	/* Underlying array of the vector, detached from it */
+	struct large_data {
+		persistent_ptr<T[]> array;
+		size_type size;
+		size_type capacity;
+	};
+
+	/*
+	 * MSB is used because vector is known not to use entire range of
+	 * size_type.
+	 */
+	static constexpr size_type _sbo_mask = 1ULL
+		<< (std::numeric_limits<size_type>::digits - 1);
+
+	/* helper functions */
+	bool is_sbo_used() const;
+	size_type get_sbo_size() const;
+	void set_sbo_size(size_type new_size);
+	pointer sbo_data() const;
+	non_sbo_type &non_sbo_data();
+	const non_sbo_type &non_sbo_data() const;
+	pointer data_ptr() const;
+	size_type get_large_capacity(size_type at_least) const;
+	void check_pmem();
+	void check_tx_stage_work();
+	pool_base get_pool() const;
+	void add_sbo_to_tx(size_type idx_first, size_type num);
+	void allocate(size_type capacity);
+	template <typename... Args>
+	void construct_large(Args &&... args);
+	void destroy_data();
+	void move_data(small_vector &&other);
+	template <typename... Args>
+	void sbo_construct_at_end(size_type count, Args &&... args);
+	template <typename InputIt>
+	void sbo_construct_range(InputIt first, InputIt last);
+	void sbo_shrink(size_type size_new);
+	void sbo_to_large(size_type new_capacity);
+	void large_to_sbo();
+	void sbo_swap(small_vector &other);
+	large_data detach_large();
+	void attach_large(const large_data &large);
+	static persistent_ptr<T[]> allocate_array(size_type capacity);
+	static void free_array(const large_data &large);
+};
+
+/* Non-member swap */
+template <typename T, std::size_t N>
+void swap(small_vector<T, N> &lhs, small_vector<T, N> &rhs);
+
+/*
+ * Comparison operators between pmem::obj::small_vector<T, N> and
+ * pmem::obj::small_vector<T, N>
+ */
+template <typename T, std::size_t N>
+bool operator==(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs);
+template <typename T, std::size_t N>
+bool operator!=(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs);
+template <typename T, std::size_t N>
+bool operator<(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs);
+template <typename T, std::size_t N>
+bool operator<=(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs);
+template <typename T, std::size_t N>
+bool operator>(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs);
+template <typename T, std::size_t N>
+bool operator>=(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs);
+
+/**
+ * Default constructor. Constructs an empty container which uses the inline
+ * buffer.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector()
+{
+	check_pmem();
+	check_tx_stage_work();
+
+	sbo._size = 0;
+	allocate(0);
+}
+
+/**
+ * Constructs the container with count copies of elements with value value.
+ *
+ * @param[in] count number of elements to construct.
+ * @param[in] value value of all constructed elements.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @post size() == count
+ * @post capacity() == max(size(), N)
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_alloc_error when allocating memory for underlying
+ * array in transaction failed.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ * @throw rethrows element constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(size_type count, const value_type &value)
+{
+	check_pmem();
+	check_tx_stage_work();
+
+	sbo._size = 0;
+	allocate(count);
+
+	if (is_sbo_used())
+		sbo_construct_at_end(count, value);
+	else
+		non_sbo_data().assign(count, value);
+}
+
+/**
+ * Constructs the container with count copies of T default constructed values.
+ *
+ * @param[in] count number of elements to construct.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @post size() == count
+ * @post capacity() == max(size(), N)
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_alloc_error when allocating memory for underlying
+ * array in transaction failed.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ * @throw rethrows element constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(size_type count)
+{
+	check_pmem();
+	check_tx_stage_work();
+
+	sbo._size = 0;
+	allocate(count);
+
+	if (is_sbo_used())
+		sbo_construct_at_end(count);
+	else
+		non_sbo_data().resize(count);
+}
+
+/**
+ * Constructs the container with the contents of the range [first, last). The
+ * first and last arguments must satisfy InputIterator requirements. This
+ * overload only participates in overload resolution if InputIt satisfies
+ * InputIterator.
+ *
+ * @param[in] first first iterator.
+ * @param[in] last last iterator.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @post size() == std::distance(first, last)
+ * @post capacity() == max(size(), N)
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_alloc_error when allocating memory for underlying
+ * array in transaction failed.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ * @throw rethrows element constructor exception.
+ */
+template <typename T, std::size_t N>
+template <typename InputIt,
+	  typename std::enable_if<detail::is_input_iterator<InputIt>::value,
+				  InputIt>::type *>
+small_vector<T, N>::small_vector(InputIt first, InputIt last)
+{
+	check_pmem();
+	check_tx_stage_work();
+
+	sbo._size = 0;
+	allocate(static_cast<size_type>(std::distance(first, last)));
+
+	if (is_sbo_used())
+		sbo_construct_range(first, last);
+	else
+		non_sbo_data().assign(first, last);
+}
+
+/**
+ * Copy constructor. Constructs the container with the copy of the contents
+ * of other.
+ *
+ * @param[in] other reference to the small_vector to be copied.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @post size() == other.size()
+ * @post capacity() == max(other.size(), N)
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_alloc_error when allocating memory for underlying
+ * array in transaction failed.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ * @throw rethrows element constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(const small_vector &other)
+    : small_vector(other.cbegin(), other.cend())
+{
+}
+
+/**
+ * Move constructor. Constructs the container with the contents of other
+ * using move semantics. After the move, other is guaranteed to be empty().
+ *
+ * @param[in] other rvalue reference to the small_vector to be moved from.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @post size() == other.size()
+ * @post capacity() == other.capacity()
+ * @post other.capacity() == N
+ * @post other.size() == 0
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ * @throw rethrows element constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(small_vector &&other)
+{
+	check_pmem();
+	check_tx_stage_work();
+
+	sbo._size = 0;
+	move_data(std::move(other));
+}
+
+/**
+ * Constructs the container with the contents of the initializer list init.
+ *
+ * @param[in] init initializer list with content to be constructed.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @post size() == init.size()
+ * @post capacity() == max(size(), N)
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_alloc_error when allocating memory for underlying
+ * array in transaction failed.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ * @throw rethrows element constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::small_vector(std::initializer_list<T> init)
+    : small_vector(init.begin(), init.end())
+{
+}
+
+/**
+ * Copy assignment operator. Replaces the contents with a copy of the contents
+ * of other transactionally.
+ *
+ * @post size() == other.size()
+ *
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N> &
+small_vector<T, N>::operator=(const small_vector &other)
+{
+	assign(other);
+
+	return *this;
+}
+
+/**
+ * Move assignment operator. Replaces the contents with those of other using
+ * move semantics transactionally. After the move, other is guaranteed to be
+ * empty().
+ *
+ * @post size() == other.size()
+ * @post capacity() == other.capacity()
+ *
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N> &
+small_vector<T, N>::operator=(small_vector &&other)
+{
+	assign(std::move(other));
+
+	return *this;
+}
+
+/**
+ * Replaces the contents with those identified by initializer list ilist
+ * transactionally.
+ *
+ * @param[in] ilist initializer list with content to be assigned.
+ *
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N> &
+small_vector<T, N>::operator=(std::initializer_list<T> ilist)
+{
+	assign(ilist.begin(), ilist.end());
+
+	return *this;
+}
+
+/**
+ * Replaces the contents with count copies of value value transactionally.
+ *
+ * @param[in] count number of elements to construct.
+ * @param[in] value value of all constructed elements.
+ *
+ * @post size() == count
+ * @post capacity() == max(capacity(), count)
+ *
+ * @throw std::length_error if count > max_size().
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::assign(size_type count, const_reference value)
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (!is_sbo_used()) {
+			non_sbo_data().assign(count, value);
+			return;
+		}
+
+		/*
+		 * value might be a reference to an element of the inline
+		 * buffer, which is destroyed below.
+		 */
+		detail::temp_value<value_type, noexcept(T(value))> tmp(value);
+
+		destroy_data();
+		allocate(count);
+
+		if (is_sbo_used())
+			sbo_construct_at_end(count, tmp.get());
+		else
+			non_sbo_data().assign(count, tmp.get());
+	});
+}
+
+/**
+ * Replaces the contents with copies of those in the range [first, last)
+ * transactionally. This overload participates in overload resolution only if
+ * InputIt satisfies InputIterator.
+ *
+ * @param[in] first first iterator.
+ * @param[in] last last iterator.
+ *
+ * @post size() == std::distance(first, last)
+ * @post capacity() == max(capacity(), std::distance(first, last))
+ *
+ * @throw std::length_error if std::distance(first, last) > max_size().
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+template <typename InputIt,
+	  typename std::enable_if<detail::is_input_iterator<InputIt>::value,
+				  InputIt>::type *>
+void
+small_vector<T, N>::assign(InputIt first, InputIt last)
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (!is_sbo_used()) {
+			non_sbo_data().assign(first, last);
+			return;
+		}
+
+		destroy_data();
+		allocate(static_cast<size_type>(std::distance(first, last)));
+
+		if (is_sbo_used())
+			sbo_construct_range(first, last);
+		else
+			non_sbo_data().assign(first, last);
+	});
+}
+
+/**
+ * Replaces the contents with the elements from the initializer list ilist
+ * transactionally.
+ *
+ * @param[in] ilist initializer list with content to be constructed.
+ *
+ * @post size() == std::distance(ilist.begin(), ilist.end())
+ *
+ * @throw std::length_error if std::distance(first, last) > max_size().
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::assign(std::initializer_list<T> ilist)
+{
+	assign(ilist.begin(), ilist.end());
+}
+
+/**
+ * Copy assignment method. Replaces the contents with a copy of the contents
+ * of other transactionally. This method is not specified by STL standards.
+ *
+ * @post size() == other.size()
+ *
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::assign(const small_vector &other)
+{
+	if (this != &other)
+		assign(other.cbegin(), other.cend());
+}
+
+/**
+ * Move assignment method. Replaces the contents with those of other using
+ * move semantics transactionally. After the move, other is guaranteed to be
+ * empty(). This method is not specified by STL standards.
+ *
+ * @post size() == other.size()
+ * @post capacity() == other.capacity()
+ *
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::assign(small_vector &&other)
+{
+	if (this == &other)
+		return;
+
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		destroy_data();
+		move_data(std::move(other));
+	});
+}
+
+/**
+ * Destructor.
+ * Note that free_data may throw an transaction_free_error when freeing
+ * underlying array failed. It is recommended to call free_data manually before
+ * object destruction.
+ */
+template <typename T, std::size_t N>
+small_vector<T, N>::~small_vector()
+{
+	try {
+		free_data();
+	} catch (...) {
+		std::terminate();
+	}
+}
+
+/**
+ * Access element at specific index with bounds checking and add it to a
+ * transaction.
+ *
+ * @param[in] n index number.
+ *
+ * @return reference to element number n.
+ *
+ * @throw std::out_of_range if n is not within the range of the container.
+ * @throw pmem::transaction_error when adding the object to the transaction
+ * failed.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reference
+small_vector<T, N>::at(size_type n)
+{
+	if (n >= size())
+		throw std::out_of_range("small_vector::at");
+
+	return operator[](n);
+}
+
+/**
+ * Access element at specific index with bounds checking.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n.
+ *
+ * @throw std::out_of_range if n is not within the range of the container.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference
+small_vector<T, N>::at(size_type n) const
+{
+	if (n >= size())
+		throw std::out_of_range("small_vector::at");
+
+	return operator[](n);
+}
+
+/**
+ * Access element at specific index with bounds checking. In contradiction to
+ * at(), const_at() will return const_reference not depending on the
+ * const-qualification of the object it is called on. std::vector doesn't
+ * provide const_at() method.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n.
+ *
+ * @throw std::out_of_range if n is not within the range of the container.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference
+small_vector<T, N>::const_at(size_type n) const
+{
+	return at(n);
+}
+
+/**
+ * Access element at specific index and add it to a transaction. No bounds
+ * checking is performed.
+ *
+ * @param[in] n index number.
+ *
+ * @return reference to element number n.
+ *
+ * @throw pmem::transaction_error when adding the object to the transaction
+ * failed.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reference small_vector<T, N>::operator[](
+	size_type n)
+{
+	auto ptr = data_ptr() + static_cast<difference_type>(n);
+
+	detail::conditional_add_to_tx(ptr, 1, POBJ_XADD_ASSUME_INITIALIZED);
+
+	return *ptr;
+}
+
+/**
+ * Access element at specific index. No bounds checking is performed.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference small_vector<T, N>::operator[](
+	size_type n) const
+{
+	return cdata()[static_cast<difference_type>(n)];
+}
+
+/**
+ * Access the first element and add this element to a transaction.
+ *
+ * @return reference to first element.
+ *
+ * @throw pmem::transaction_error when adding the object to the transaction
+ * failed.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reference
+small_vector<T, N>::front()
+{
+	return operator[](0);
+}
+
+/**
+ * Access the first element.
+ *
+ * @return const_reference to first element.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference
+small_vector<T, N>::front() const
+{
+	return cdata()[0];
+}
+
+/**
+ * Access the first element. In contradiction to front(), cfront() will return
+ * const_reference not depending on the const-qualification of the object it is
+ * called on. std::vector doesn't provide cfront() method.
+ *
+ * @return const reference to first element.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference
+small_vector<T, N>::cfront() const
+{
+	return cdata()[0];
+}
+
+/**
+ * Access the last element and add this element to a transaction.
+ *
+ * @return reference to the last element.
+ *
+ * @throw pmem::transaction_error when adding the object to the transaction
+ * failed.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reference
+small_vector<T, N>::back()
+{
+	return operator[](size() - 1);
+}
+
+/**
+ * Access the last element.
+ *
+ * @return const_reference to the last element.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference
+small_vector<T, N>::back() const
+{
+	return cdata()[static_cast<difference_type>(size() - 1)];
+}
+
+/**
+ * Access the last element. In contradiction to back(), cback() will return
+ * const_reference not depending on the const-qualification of the object it is
+ * called on. std::vector doesn't provide cback() method.
+ *
+ * @return const_reference to the last element.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reference
+small_vector<T, N>::cback() const
+{
+	return cdata()[static_cast<difference_type>(size() - 1)];
+}
+
+/**
+ * Returns raw pointer to the underlying data and adds entire array to a
+ * transaction.
+ *
+ * @return pointer to the underlying data.
+ *
+ * @throw pmem::transaction_error when adding the object to the transaction
+ * failed.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::value_type *
+small_vector<T, N>::data()
+{
+	if (!is_sbo_used())
+		return non_sbo_data().data();
+
+	add_sbo_to_tx(0, get_sbo_size());
+
+	return sbo_data();
+}
+
+/**
+ * Returns const raw pointer to the underlying data.
+ *
+ * @return const_pointer to the underlying data.
+ */
+template <typename T, std::size_t N>
+const typename small_vector<T, N>::value_type *
+small_vector<T, N>::data() const noexcept
+{
+	return data_ptr();
+}
+
+/**
+ * Returns const raw pointer to the underlying data. In contradiction to data(),
+ * cdata() will return const_pointer not depending on the const-qualification of
+ * the object it is called on. std::vector doesn't provide cdata() method.
+ *
+ * @return const_pointer to the underlying data.
+ */
+template <typename T, std::size_t N>
+const typename small_vector<T, N>::value_type *
+small_vector<T, N>::cdata() const noexcept
+{
+	return data_ptr();
+}
+
+/**
+ * Returns an iterator to the beginning.
+ *
+ * @return iterator pointing to the first element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::begin()
+{
+	return iterator(data_ptr());
+}
+
+/**
+ * Returns const iterator to the beginning.
+ *
+ * @return const_iterator pointing to the first element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_iterator
+small_vector<T, N>::begin() const noexcept
+{
+	return const_iterator(data_ptr());
+}
+
+/**
+ * Returns const iterator to the beginning. In contradiction to begin(),
+ * cbegin() will return const_iterator not depending on the const-qualification
+ * of the object it is called on.
+ *
+ * @return const_iterator pointing to the first element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_iterator
+small_vector<T, N>::cbegin() const noexcept
+{
+	return const_iterator(data_ptr());
+}
+
+/**
+ * Returns an iterator to past the end.
+ *
+ * @return iterator referring to the past-the-end element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::end()
+{
+	return begin() + static_cast<difference_type>(size());
+}
+
+/**
+ * Returns a const iterator to the end.
+ *
+ * @return const_iterator referring to the past-the-end element in the
+ * small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_iterator
+small_vector<T, N>::end() const noexcept
+{
+	return cbegin() + static_cast<difference_type>(size());
+}
+
+/**
+ * Returns a const iterator to the end. In contradiction to end(), cend() will
+ * return const_iterator not depending on the const-qualification of the object
+ * it is called on.
+ *
+ * @return const_iterator referring to the past-the-end element in the
+ * small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_iterator
+small_vector<T, N>::cend() const noexcept
+{
+	return cbegin() + static_cast<difference_type>(size());
+}
+
+/**
+ * Returns a reverse iterator to the beginning.
+ *
+ * @return reverse_iterator pointing to the last element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reverse_iterator
+small_vector<T, N>::rbegin()
+{
+	return reverse_iterator(end());
+}
+
+/**
+ * Returns a const reverse iterator to the beginning.
+ *
+ * @return const_reverse_iterator pointing to the last element in the
+ * small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reverse_iterator
+small_vector<T, N>::rbegin() const noexcept
+{
+	return const_reverse_iterator(cend());
+}
+
+/**
+ * Returns a const reverse iterator to the beginning. In contradiction to
+ * rbegin(), crbegin() will return const_reverse_iterator not depending on the
+ * const-qualification of the object it is called on.
+ *
+ * @return const_reverse_iterator pointing to the last element in the
+ * small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reverse_iterator
+small_vector<T, N>::crbegin() const noexcept
+{
+	return const_reverse_iterator(cend());
+}
+
+/**
+ * Returns a reverse iterator to the end.
+ *
+ * @return reverse_iterator pointing to the theoretical element preceding the
+ * first element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::reverse_iterator
+small_vector<T, N>::rend()
+{
+	return reverse_iterator(begin());
+}
+
+/**
+ * Returns a const reverse iterator to the end.
+ *
+ * @return const_reverse_iterator pointing to the theoretical element preceding
+ * the first element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reverse_iterator
+small_vector<T, N>::rend() const noexcept
+{
+	return const_reverse_iterator(cbegin());
+}
+
+/**
+ * Returns a const reverse iterator to the beginning. In contradiction to
+ * rend(), crend() will return const_reverse_iterator not depending on the
+ * const-qualification of the object it is called on.
+ *
+ * @return const_reverse_iterator pointing to the theoretical element preceding
+ * the first element in the small_vector.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::const_reverse_iterator
+small_vector<T, N>::crend() const noexcept
+{
+	return const_reverse_iterator(cbegin());
+}
+
+/**
+ * Checks whether the container is empty.
+ *
+ * @return true if container is empty, false otherwise.
+ */
+template <typename T, std::size_t N>
+bool
+small_vector<T, N>::empty() const noexcept
+{
+	return size() == 0;
+}
+
+/**
+ * @return number of elements.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type
+small_vector<T, N>::size() const noexcept
+{
+	return is_sbo_used() ? get_sbo_size() : non_sbo_data().size();
+}
+
+/**
+ * @return maximum number of elements the container is able to hold due to
+ * PMDK limitations.
+ */
+template <typename T, std::size_t N>
+constexpr typename small_vector<T, N>::size_type
+small_vector<T, N>::max_size() const noexcept
+{
+	return PMEMOBJ_MAX_ALLOC_SIZE / sizeof(value_type);
+}
+
+/**
+ * Increases the capacity of the small_vector to capacity_new transactionally.
+ * If capacity_new is greater than the current capacity(), new storage is
+ * allocated (elements are moved out of the inline buffer, if it was used),
+ * otherwise the method does nothing. If new storage is allocated, all
+ * iterators, including the past the end iterator, and all references to the
+ * elements are invalidated.
+ *
+ * @param[in] capacity_new new capacity.
+ *
+ * @post capacity() == max(capacity(), capacity_new)
+ *
+ * @throw rethrows destructor exception.
+ * @throw std::length_error if new_cap > max_size().
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::reserve(size_type capacity_new)
+{
+	if (capacity_new <= capacity())
+		return;
+
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (is_sbo_used())
+			sbo_to_large(capacity_new);
+		else
+			non_sbo_data().reserve(capacity_new);
+	});
+}
+
+/**
+ * @return number of elements that can be held in currently allocated storage.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type
+small_vector<T, N>::capacity() const noexcept
+{
+	return is_sbo_used() ? N : non_sbo_data().capacity();
+}
+
+/**
+ * Requests transactional removal of unused capacity. If size() is not greater
+ * than N, elements are moved back to the inline buffer and the underlying
+ * array is freed. Otherwise, capacity is set to size(). If reallocation
+ * occurs, all iterators, including the past the end iterator, and all
+ * references to the elements are invalidated.
+ *
+ * @post capacity() == max(size(), N)
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when reallocating failed.
+ * @throw pmem::transaction_free_error when freeing old underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::shrink_to_fit()
+{
+	if (is_sbo_used())
+		return;
+
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (size() <= N)
+			large_to_sbo();
+		else
+			non_sbo_data().shrink_to_fit();
+	});
+}
+
+/**
+ * Clears the content of a small_vector transactionally.
+ *
+ * @post size() == 0
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::clear()
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (is_sbo_used())
+			sbo_shrink(0);
+		else
+			non_sbo_data().clear();
+	});
+}
+
+/**
+ * Clears the content of a small_vector and frees all allocated persistent
+ * memory for data transactionally. Afterwards, the inline buffer is used.
+ *
+ * @post size() == 0
+ * @post capacity() == N
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_free_error when freeing underlying array failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::free_data()
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		destroy_data();
+		allocate(0);
+	});
+}
+
+/**
+ * Inserts value before pos in the container transactionally. If the new size()
+ * is greater than capacity(), all iterators and references are invalidated.
+ * Otherwise, only the iterators and references before the insertion point
+ * remain valid.
+ *
+ * @param[in] pos iterator before which the content will be inserted. pos may be
+ * the end() iterator.
+ * @param[in] value element value to be inserted.
+ *
+ * @return Iterator pointing to the inserted value.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::insert(const_iterator pos, const value_type &value)
+{
+	return emplace(pos, value);
+}
+
+/**
+ * Moves value before pos in the container transactionally. If the new size()
+ * is greater than capacity(), all iterators and references are invalidated.
+ * Otherwise, only the iterators and references before the insertion point
+ * remain valid.
+ *
+ * @param[in] pos iterator before which the content will be inserted. pos may be
+ * the end() iterator.
+ * @param[in] value element value to be inserted.
+ *
+ * @return Iterator pointing to the inserted value.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::insert(const_iterator pos, value_type &&value)
+{
+	return emplace(pos, std::move(value));
+}
+
+/**
+ * Inserts a new element into the container directly before pos
+ * transactionally. The element is constructed from args. If the new size() is
+ * greater than capacity(), all iterators and references are invalidated.
+ * Otherwise, only the iterators and references before the insertion point
+ * remain valid.
+ *
+ * @param[in] pos iterator before which the new element will be constructed.
+ * @param[in] args arguments to forward to the constructor of the element.
+ *
+ * @return Iterator pointing to the emplaced element.
+ *
+ * @pre value_type must meet the requirements of MoveAssignable and
+ * MoveInsertable.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+template <class... Args>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::emplace(const_iterator pos, Args &&... args)
+{
+	pool_base pb = get_pool();
+
+	size_type idx = static_cast<size_type>(std::distance(cbegin(), pos));
+
+	flat_transaction::run(pb, [&] {
+		/*
+		 * args might be a reference to an element, which can be moved
+		 * before the new element is constructed. Hence, we must cache
+		 * value_type object in temp_value.
+		 */
+		detail::temp_value<value_type,
+				   noexcept(T(std::forward<Args>(args)...))>
+		tmp(std::forward<Args>(args)...);
+
+		auto &tmp_ref = tmp.get();
+
+		if (is_sbo_used() && get_sbo_size() == N)
+			sbo_to_large(get_large_capacity(N + 1));
+
+		if (!is_sbo_used()) {
+			auto &large = non_sbo_data();
+			large.emplace(large.cbegin() +
+					      static_cast<difference_type>(idx),
+				      std::move(tmp_ref));
+			return;
+		}
+
+		auto sz = get_sbo_size();
+		auto data = sbo_data();
+
+		add_sbo_to_tx(idx, sz - idx + 1);
+
+		if (idx == sz) {
+			detail::create<value_type>(data + sz,
+						   std::move(tmp_ref));
+		} else {
+			detail::create<value_type>(data + sz,
+						   std::move(data[sz - 1]));
+			std::move_backward(data + idx, data + sz - 1,
+					   data + sz);
+			data[idx] = std::move(tmp_ref);
+		}
+
+		set_sbo_size(sz + 1);
+	});
+
+	return iterator(data_ptr() + static_cast<difference_type>(idx));
+}
+
+/**
+ * Appends a new element to the end of the container transactionally. The
+ * element is constructed in-place from args. If the new size() is greater than
+ * capacity() then all iterators and references (including the past-the-end
+ * iterator) are invalidated. Otherwise only the past-the-end iterator is
+ * invalidated.
+ *
+ * @param[in] args arguments to forward to the constructor of the element.
+ *
+ * @return Reference to the inserted element.
+ *
+ * @pre value_type must meet the requirements of EmplaceConstructible and
+ * MoveInsertable.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+template <class... Args>
+typename small_vector<T, N>::reference
+small_vector<T, N>::emplace_back(Args &&... args)
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (!is_sbo_used()) {
+			auto &large = non_sbo_data();
+			large.emplace_back(std::forward<Args>(args)...);
+		} else if (get_sbo_size() < N) {
+			sbo_construct_at_end(1, std::forward<Args>(args)...);
+		} else {
+			/*
+			 * args might be a reference to an element of the
+			 * inline buffer, which is moved to the heap below.
+			 */
+			detail::temp_value<value_type,
+					   noexcept(T(std::forward<Args>(
+						   args)...))>
+			tmp(std::forward<Args>(args)...);
+
+			sbo_to_large(get_large_capacity(N + 1));
+			non_sbo_data().emplace_back(std::move(tmp.get()));
+		}
+	});
+
+	return back();
+}
+
+/**
+ * Removes the element at pos transactionally. Invalidates iterators and
+ * references at or after the point of the erase, including the end()
+ * iterator.
+ *
+ * @param[in] pos iterator to the element to be removed.
+ *
+ * @return iterator following the last removed element.
+ *
+ * @pre value_type must meet the requirements of MoveAssignable.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::erase(const_iterator pos)
+{
+	return erase(pos, pos + 1);
+}
+
+/**
+ * Removes the elements in the range [first, last) transactionally.
+ * Invalidates iterators and references at or after the point of the erase,
+ * including the end() iterator.
+ *
+ * @param[in] first beginning of the range of elements to be removed.
+ * @param[in] last end of range of elements to be removed.
+ *
+ * @return iterator following the last removed element.
+ *
+ * @pre value_type must meet the requirements of MoveAssignable.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::iterator
+small_vector<T, N>::erase(const_iterator first, const_iterator last)
+{
+	size_type idx = static_cast<size_type>(std::distance(cbegin(), first));
+	size_type count = static_cast<size_type>(std::distance(first, last));
+
+	if (count == 0)
+		return iterator(data_ptr() + static_cast<difference_type>(idx));
+
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (!is_sbo_used()) {
+			auto &large = non_sbo_data();
+			auto large_first = large.cbegin() +
+				static_cast<difference_type>(idx);
+			auto large_last = large_first +
+				static_cast<difference_type>(count);
+			large.erase(large_first, large_last);
+			return;
+		}
+
+		auto sz = get_sbo_size();
+		auto data = sbo_data();
+
+		add_sbo_to_tx(idx, sz - idx);
+
+		std::move(data + idx + count, data + sz, data + idx);
+
+		sbo_shrink(sz - count);
+	});
+
+	return iterator(data_ptr() + static_cast<difference_type>(idx));
+}
+
+/**
+ * Appends the given element value to the end of the container
+ * transactionally. The new element is initialized as a copy of value.
+ *
+ * @param[in] value the value of the element to be appended.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::push_back(const value_type &value)
+{
+	emplace_back(value);
+}
+
+/**
+ * Appends the given element value to the end of the container
+ * transactionally. value is moved into the new element.
+ *
+ * @param[in] value the value of the element to be appended.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::push_back(value_type &&value)
+{
+	emplace_back(std::move(value));
+}
+
+/**
+ * Removes the last element of the container transactionally. Calling pop_back
+ * on an empty container does nothing.
+ *
+ * @post size() == std::max(0, size() - 1)
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::pop_back()
+{
+	if (empty())
+		return;
+
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (is_sbo_used())
+			sbo_shrink(get_sbo_size() - 1);
+		else
+			non_sbo_data().pop_back();
+	});
+}
+
+/**
+ * Resizes the container to count elements transactionally. If the current size
+ * is greater than count, the container is reduced to its first count elements.
+ * If the current size is less than count, additional default-inserted elements
+ * are appended.
+ *
+ * @param[in] count new size of the container.
+ *
+ * @post size() == count
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::resize(size_type count)
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (is_sbo_used() && count > N)
+			sbo_to_large(count);
+
+		if (!is_sbo_used())
+			non_sbo_data().resize(count);
+		else if (count <= get_sbo_size())
+			sbo_shrink(count);
+		else
+			sbo_construct_at_end(count - get_sbo_size());
+	});
+}
+
+/**
+ * Resizes the container to contain count elements transactionally. If the
+ * current size is greater than count, the container is reduced to its first
+ * count elements. If the current size is less than count, additional copies of
+ * value are appended.
+ *
+ * @param[in] count new size of the container.
+ * @param[in] value the value to initialize the new elements with.
+ *
+ * @post size() == count
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw rethrows constructor exception.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::resize(size_type count, const value_type &value)
+{
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (!is_sbo_used()) {
+			non_sbo_data().resize(count, value);
+		} else if (count <= get_sbo_size()) {
+			sbo_shrink(count);
+		} else if (count <= N) {
+			sbo_construct_at_end(count - get_sbo_size(), value);
+		} else {
+			/*
+			 * value might be a reference to an element of the
+			 * inline buffer, which is moved to the heap below.
+			 */
+			detail::temp_value<value_type, noexcept(T(value))> tmp(
+				value);
+
+			sbo_to_large(count);
+			non_sbo_data().resize(count, tmp.get());
+		}
+	});
+}
+
+/**
+ * Exchanges the contents of the container with other transactionally.
+ * Elements on the heap are not moved, elements of the inline buffers are
+ * exchanged using swap() or moved.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::swap(small_vector &other)
+{
+	if (this == &other)
+		return;
+
+	pool_base pb = get_pool();
+
+	flat_transaction::run(pb, [&] {
+		if (!is_sbo_used() && !other.is_sbo_used()) {
+			non_sbo_data().swap(other.non_sbo_data());
+			return;
+		}
+
+		if (is_sbo_used() && other.is_sbo_used()) {
+			sbo_swap(other);
+			return;
+		}
+
+		auto &sbo_side = is_sbo_used() ? *this : other;
+		auto &large_side = is_sbo_used() ? other : *this;
+
+		auto large = large_side.detach_large();
+		large_side.move_data(std::move(sbo_side));
+		sbo_side.attach_large(large);
+	});
+}
+
+/**
+ * Private helper function.
+ *
+ * @return true if the inline buffer is used, false otherwise.
+ */
+template <typename T, std::size_t N>
+bool
+small_vector<T, N>::is_sbo_used() const
+{
+	return (sbo._size & _sbo_mask) != 0;
+}
+
+/**
+ * Private helper function.
+ *
+ * @return number of elements in the inline buffer.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type
+small_vector<T, N>::get_sbo_size() const
+{
+	return sbo._size & ~_sbo_mask;
+}
+
+/**
+ * Private helper function. Sets number of elements in the inline buffer and
+ * marks the inline buffer as used.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::set_sbo_size(size_type new_size)
+{
+	sbo._size = new_size | _sbo_mask;
+}
+
+/**
+ * Private helper function.
+ *
+ * @return pointer to the first element of the inline buffer.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::pointer
+small_vector<T, N>::sbo_data() const
+{
+	return reinterpret_cast<pointer>(
+		const_cast<sbo_storage_type *>(&sbo._data[0]));
+}
+
+template <typename T, std::size_t N>
+typename small_vector<T, N>::non_sbo_type &
+small_vector<T, N>::non_sbo_data()
+{
+	assert(!is_sbo_used());
+	return non_sbo._data;
+}
+
+template <typename T, std::size_t N>
+const typename small_vector<T, N>::non_sbo_type &
+small_vector<T, N>::non_sbo_data() const
+{
+	assert(!is_sbo_used());
+	return non_sbo._data;
+}
+
+/**
+ * Private helper function. Does not add anything to a transaction.
+ *
+ * @return pointer to the first element, either in the inline buffer or in
+ * the underlying array.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::pointer
+small_vector<T, N>::data_ptr() const
+{
+	return is_sbo_used() ? sbo_data()
+			     : const_cast<pointer>(non_sbo_data().cdata());
+}
+
+/**
+ * Private helper function.
+ *
+ * @return capacity of the underlying array allocated when elements no longer
+ * fit in the inline buffer.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::size_type
+small_vector<T, N>::get_large_capacity(size_type at_least) const
+{
+	return (std::max)(at_least, 2 * N);
+}
+
+/**
+ * Private helper function. Checks if small_vector resides on pmem and throws
+ * an exception if not.
+ *
+ * @throw pool_error if small_vector doesn't reside on pmem.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::check_pmem()
+{
+	if (nullptr == pmemobj_pool_by_ptr(this))
+		throw pmem::pool_error("Invalid pool handle.");
+}
+
+/**
+ * Private helper function. Checks if current transaction stage is equal to
+ * TX_STAGE_WORK and throws an exception otherwise.
+ *
+ * @throw pmem::transaction_scope_error if current transaction stage is not
+ * equal to TX_STAGE_WORK.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::check_tx_stage_work()
+{
+	if (pmemobj_tx_stage() != TX_STAGE_WORK)
+		throw pmem::transaction_scope_error(
+			"Function called out of transaction scope.");
+}
+
+/**
+ * Private helper function.
+ *
+ * @return reference to pool_base object where small_vector resides.
+ *
+ * @pre small_vector must reside in persistent memory pool.
+ */
+template <typename T, std::size_t N>
+pool_base
+small_vector<T, N>::get_pool() const
+{
+	return pmem::obj::pool_by_vptr(this);
+}
+
+/**
+ * Private helper function. Takes a “snapshot” of the inline buffer in range
+ * [idx_first, idx_first + num). Elements after size() are added to a
+ * transaction without snapshotting.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::add_sbo_to_tx(size_type idx_first, size_type num)
+{
+	assert(idx_first + num <= N);
+	assert(is_sbo_used());
+
+	auto sz = get_sbo_size();
+	auto initialized_num = idx_first < sz ? sz - idx_first : 0;
+
+	/* Snapshot elements in range [idx_first, sbo_size) */
+	detail::conditional_add_to_tx(sbo_data() + idx_first,
+				      (std::min)(initialized_num, num),
+				      POBJ_XADD_ASSUME_INITIALIZED);
+
+	if (num > initialized_num) {
+		/* Elements after sbo_size do not have to be snapshotted */
+		detail::conditional_add_to_tx(
+			sbo_data() + idx_first + initialized_num,
+			num - initialized_num, POBJ_XADD_NO_SNAPSHOT);
+	}
+}
+
+/**
+ * Private helper function. Must be called during transaction. Makes
+ * the inline buffer used if capacity is not greater than N, otherwise
+ * creates an empty vector with the given capacity.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and empty, or data was destroyed by
+ * destroy_data().
+ *
+ * @throw pmem::transaction_alloc_error when allocating memory failed.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::allocate(size_type capacity)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	if (capacity <= N) {
+		set_sbo_size(0);
+	} else {
+		construct_large();
+		non_sbo_data().reserve(capacity);
+	}
+}
+
+/**
+ * Private helper function. Must be called during transaction. Constructs
+ * vector in place of the inline buffer from args.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and empty, or data was destroyed by
+ * destroy_data().
+ */
+template <typename T, std::size_t N>
+template <typename... Args>
+void
+small_vector<T, N>::construct_large(Args &&... args)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	/* Size must be snapshotted before the vector overwrites it */
+	sbo._size = 0;
+
+	detail::conditional_add_to_tx(&non_sbo._data, 1,
+				      POBJ_XADD_NO_SNAPSHOT);
+	detail::create<non_sbo_type>(&non_sbo._data,
+				     std::forward<Args>(args)...);
+
+	assert(!is_sbo_used());
+}
+
+/**
+ * Private helper function. Must be called during transaction. Destroys all
+ * elements and frees the underlying array, if it was used. Afterwards, only
+ * allocate() or move_data() may be called.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_free_error when freeing underlying array failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::destroy_data()
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	if (is_sbo_used()) {
+		/*
+		 * The vector may be constructed in place of the inline
+		 * buffer afterwards, so elements must be snapshotted even
+		 * if they are trivially destructible.
+		 */
+		add_sbo_to_tx(0, get_sbo_size());
+		sbo_shrink(0);
+	} else {
+		detail::conditional_add_to_tx(&non_sbo._data, 1,
+					      POBJ_XADD_ASSUME_INITIALIZED);
+		non_sbo_data().free_data();
+		detail::destroy<non_sbo_type>(non_sbo_data());
+	}
+}
+
+/**
+ * Private helper function. Must be called during transaction. Moves
+ * contents of other to this small_vector. Afterwards, other is empty and uses
+ * the inline buffer.
+ *
+ * @pre must be called in transaction scope.
+ * @pre data was destroyed by destroy_data() or was never initialized.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::move_data(small_vector &&other)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	if (other.is_sbo_used()) {
+		auto sz = other.get_sbo_size();
+		auto data = other.sbo_data();
+
+		other.add_sbo_to_tx(0, sz);
+
+		allocate(0);
+		sbo_construct_range(std::make_move_iterator(data),
+				    std::make_move_iterator(data + sz));
+
+		other.sbo_shrink(0);
+	} else {
+		construct_large(std::move(other.non_sbo_data()));
+
+		other.destroy_data();
+		other.allocate(0);
+	}
+}
+
+/**
+ * Private helper function. Must be called during transaction. Constructs
+ * count elements at the end of the inline buffer from args.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and get_sbo_size() + count <= N.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+template <typename... Args>
+void
+small_vector<T, N>::sbo_construct_at_end(size_type count, Args &&... args)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	auto sz = get_sbo_size();
+	assert(sz + count <= N);
+
+	add_sbo_to_tx(sz, count);
+
+	auto dest = sbo_data() + sz;
+	for (size_type i = 0; i < count; ++i)
+		detail::create<value_type>(dest++, std::forward<Args>(args)...);
+
+	set_sbo_size(sz + count);
+}
+
+/**
+ * Private helper function. Must be called during transaction. Constructs
+ * elements from the range [first, last) at the end of the inline buffer.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and there is enough space in it.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+template <typename InputIt>
+void
+small_vector<T, N>::sbo_construct_range(InputIt first, InputIt last)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	auto sz = get_sbo_size();
+	auto count = static_cast<size_type>(std::distance(first, last));
+	assert(sz + count <= N);
+
+	add_sbo_to_tx(sz, count);
+
+	auto dest = sbo_data() + sz;
+	while (first != last)
+		detail::create<value_type>(dest++, *first++);
+
+	set_sbo_size(sz + count);
+}
+
+/**
+ * Private helper function. Must be called during transaction. Destroys
+ * elements of the inline buffer beginning from position size_new.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and size_new <= get_sbo_size().
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::sbo_shrink(size_type size_new)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	auto sz = get_sbo_size();
+	assert(size_new <= sz);
+
+	if (!std::is_trivially_destructible<T>::value)
+		add_sbo_to_tx(size_new, sz - size_new);
+
+	auto data = sbo_data();
+	for (size_type i = size_new; i < sz; ++i)
+		detail::destroy<value_type>(data[i]);
+
+	set_sbo_size(size_new);
+}
+
+/**
+ * Private helper function. Must be called during transaction. Moves elements
+ * from the inline buffer to newly allocated vector with the given capacity.
+ *
+ * The vector cannot be constructed in place of the inline buffer before
+ * elements are moved out of it, so they are moved to a newly allocated array
+ * first, which is then attached to the vector.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and new_capacity > N.
+ *
+ * @post the inline buffer is not used.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating memory failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::sbo_to_large(size_type new_capacity)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+	assert(is_sbo_used());
+	assert(new_capacity > N);
+
+	auto sz = get_sbo_size();
+	auto data = sbo_data();
+
+	large_data large = {allocate_array(new_capacity), sz, new_capacity};
+
+	/* Newly allocated array does not have to be added to a transaction */
+	add_sbo_to_tx(0, sz);
+	auto dest = large.array.get();
+	for (size_type i = 0; i < sz; ++i)
+		detail::create<value_type>(dest + i, std::move(data[i]));
+
+	destroy_data();
+	attach_large(large);
+
+	assert(!is_sbo_used());
+}
+
+/**
+ * Private helper function. Must be called during transaction. Moves elements
+ * from the underlying array back to the inline buffer and frees the array.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is not used and size() <= N.
+ *
+ * @post the inline buffer is used.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_free_error when freeing underlying array failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::large_to_sbo()
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+	assert(!is_sbo_used());
+	assert(size() <= N);
+
+	auto large = detach_large();
+	auto data = large.array.get();
+
+	/* Elements are modified by moving them out of the array */
+	detail::conditional_add_to_tx(data, large.size,
+				      POBJ_XADD_ASSUME_INITIALIZED);
+
+	allocate(0);
+	sbo_construct_range(std::make_move_iterator(data),
+			    std::make_move_iterator(data + large.size));
+
+	free_array(large);
+
+	assert(is_sbo_used());
+}
+
+/**
+ * Private helper function. Must be called during transaction. Exchanges
+ * elements of the inline buffers of this and other.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffers of this and other are used.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw rethrows constructor, destructor or swap exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::sbo_swap(small_vector &other)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+	assert(is_sbo_used() && other.is_sbo_used());
+
+	auto &longer = get_sbo_size() < other.get_sbo_size() ? other : *this;
+	auto &shorter = get_sbo_size() < other.get_sbo_size() ? *this : other;
+
+	auto long_sz = longer.get_sbo_size();
+	auto short_sz = shorter.get_sbo_size();
+	auto long_data = longer.sbo_data();
+	auto short_data = shorter.sbo_data();
+
+	longer.add_sbo_to_tx(0, long_sz);
+	shorter.add_sbo_to_tx(0, short_sz);
+
+	using std::swap;
+	for (size_type i = 0; i < short_sz; ++i)
+		swap(long_data[i], short_data[i]);
+
+	shorter.sbo_construct_range(
+		std::make_move_iterator(long_data + short_sz),
+		std::make_move_iterator(long_data + long_sz));
+	longer.sbo_shrink(short_sz);
+}
+
+/**
+ * Private helper function. Must be called during transaction. Detaches the
+ * underlying array from the vector and destroys the vector without freeing
+ * the array. Afterwards, only allocate(), move_data() or attach_large() may
+ * be called.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is not used.
+ *
+ * @return detached array together with its size and capacity.
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ */
+template <typename T, std::size_t N>
+typename small_vector<T, N>::large_data
+small_vector<T, N>::detach_large()
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	auto &v = non_sbo_data();
+
+	detail::conditional_add_to_tx(&non_sbo._data, 1,
+				      POBJ_XADD_ASSUME_INITIALIZED);
+
+	large_data large = {v._data, v._size, v._capacity};
+
+	v._data = nullptr;
+	v._size = 0;
+	v._capacity = 0;
+	detail::destroy<non_sbo_type>(v);
+
+	return large;
+}
+
+/**
+ * Private helper function. Must be called during transaction. Constructs
+ * vector in place of the inline buffer, which takes ownership of the array.
+ *
+ * @pre must be called in transaction scope.
+ * @pre the inline buffer is used and empty, or data was destroyed by
+ * destroy_data() or detach_large().
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::attach_large(const large_data &large)
+{
+	construct_large();
+
+	auto &v = non_sbo_data();
+	v._data = large.array;
+	v._size = large.size;
+	v._capacity = large.capacity;
+}
+
+/**
+ * Private helper function. Must be called during transaction. Allocates
+ * uninitialized array for capacity elements, the same way as vector does.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @throw std::length_error if capacity is greater than max_size().
+ * @throw pmem::transaction_alloc_error when allocating memory failed.
+ */
+template <typename T, std::size_t N>
+persistent_ptr<T[]>
+small_vector<T, N>::allocate_array(size_type capacity)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	if (capacity > PMEMOBJ_MAX_ALLOC_SIZE / sizeof(value_type))
+		throw std::length_error("New capacity exceeds max size.");
+
+	persistent_ptr<T[]> res =
+		pmemobj_tx_alloc(sizeof(value_type) * capacity,
+				 detail::type_num<value_type>());
+
+	if (res == nullptr) {
+		if (errno == ENOMEM)
+			throw pmem::transaction_out_of_memory(
+				"Failed to allocate persistent memory object")
+				.with_pmemobj_errormsg();
+		else
+			throw pmem::transaction_alloc_error(
+				"Failed to allocate persistent memory object")
+				.with_pmemobj_errormsg();
+	}
+
+	detail::tx_stats_on_alloc(sizeof(value_type) * capacity);
+
+	return res;
+}
+
+/**
+ * Private helper function. Must be called during transaction. Destroys
+ * elements of the detached array and frees it.
+ *
+ * @pre must be called in transaction scope.
+ * @pre elements of the array were added to the transaction.
+ *
+ * @throw pmem::transaction_free_error when freeing the array failed.
+ * @throw rethrows destructor exception.
+ */
+template <typename T, std::size_t N>
+void
+small_vector<T, N>::free_array(const large_data &large)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	if (large.array == nullptr)
+		return;
+
+	auto data = large.array.get();
+	for (size_type i = 0; i < large.size; ++i)
+		detail::destroy<value_type>(data[i]);
+
+	detail::tx_stats_on_free(large.array.raw());
+	if (pmemobj_tx_free(large.array.raw()) != 0)
+		throw pmem::transaction_free_error(
+			"failed to delete persistent memory object")
+			.with_pmemobj_errormsg();
+
+	detail::tx_snapshot_cache::get().invalidate();
+}
+
+/**
+ * Swaps the contents of lhs and rhs.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ */
+template <typename T, std::size_t N>
+void
+swap(small_vector<T, N> &lhs, small_vector<T, N> &rhs)
+{
+	lhs.swap(rhs);
+}
+
+/**
+ * Comparison operator. Compares the contents of two containers.
+ *
+ * Checks if containers have the same number of elements and each element in lhs
+ * is equal to element in rhs at the same position.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ *
+ * @return true if contents of the containers are equal, false otherwise
+ */
+template <typename T, std::size_t N>
+bool
+operator==(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs)
+{
+	return lhs.size() == rhs.size() &&
+		std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+/**
+ * Comparison operator. Compares the contents of two containers.
+ *
+ * Checks if containers have the same number of elements and each element in lhs
+ * is equal to element in rhs at the same position.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ *
+ * @return true if contents of the containers are not equal, false otherwise
+ */
+template <typename T, std::size_t N>
+bool
+operator!=(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Comparison operator. Compares the contents of two containers
+ * lexicographically.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ *
+ * @return true if contents of lhs are lexicographically lesser than contents of
+ * rhs, false otherwise
+ */
+template <typename T, std::size_t N>
+bool
+operator<(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs)
+{
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
+					    rhs.end());
+}
+
+/**
+ * Comparison operator. Compares the contents of two containers
+ * lexicographically.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ *
+ * @return true if contents of lhs are lexicographically lesser than or equal to
+ * contents of rhs, false otherwise
+ */
+template <typename T, std::size_t N>
+bool
+operator<=(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs)
+{
+	return !(rhs < lhs);
+}
+
+/**
+ * Comparison operator. Compares the contents of two containers
+ * lexicographically.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ *
+ * @return true if contents of lhs are lexicographically greater than contents
+ * of rhs, false otherwise
+ */
+template <typename T, std::size_t N>
+bool
+operator>(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs)
+{
+	return rhs < lhs;
+}
+
+/**
+ * Comparison operator. Compares the contents of two containers
+ * lexicographically.
+ *
+ * @param[in] lhs first small_vector
+ * @param[in] rhs second small_vector
+ *
+ * @return true if contents of lhs are lexicographically greater than or equal
+ * to contents of rhs, false otherwise
+ */
+template <typename T, std::size_t N>
+bool
+operator>=(const small_vector<T, N> &lhs, const small_vector<T, N> &rhs)
+{
+	return !(lhs < rhs);
+}
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_SMALL_VECTOR_HPP */
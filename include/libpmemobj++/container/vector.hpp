@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <utility>
 #include <vector>
 
@@ -244,12 +245,49 @@ private:
 	void construct_or_assign(size_type idx, InputIt first, InputIt last);
 	void move_elements_backward(pointer first, pointer last,
 				    pointer d_last);
+	static constexpr bool move_preserves_source();
+
+	/*
+	 * Elements from the range of type InputIt can be copied in bulk,
+	 * bypassing value_type constructors and assignment operators.
+	 */
+	template <typename InputIt>
+	using is_bulk_copyable = std::integral_constant<
+		bool,
+		detail::is_contiguous_iterator_of<InputIt, T>::value &&
+			LIBPMEMOBJ_CPP_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) &&
+			std::is_trivially_destructible<T>::value>;
+
+	/*
+	 * Elements from the range of type InputIt can be copied in bulk over
+	 * already constructed elements, bypassing value_type assignment
+	 * operators.
+	 */
+	template <typename InputIt>
+	using is_bulk_assignable = std::integral_constant<
+		bool,
+		is_bulk_copyable<InputIt>::value &&
+			LIBPMEMOBJ_CPP_IS_TRIVIALLY_COPYABLE(T)>;
+
+	/* Size (in bytes) from which bulk copy uses non-temporal stores */
+	static constexpr size_type bulk_nontemporal_threshold = 4096;
+
+	template <typename InputIt>
+	void copy_range(pointer dest, InputIt first, InputIt last,
+			std::true_type);
+	template <typename InputIt>
+	void copy_range(pointer dest, InputIt first, InputIt last,
+			std::false_type);
 
 	p<size_type> _size;
 	p<size_type> _capacity;
 
 	/* Underlying array */
 	persistent_ptr<T[]> _data;
+
+	/* moves the underlying array in and out of the vector */
+	template <typename U, std::size_t N>
+	friend class small_vector;
 };
 
 /* Non-member swap */
@@ -450,7 +488,7 @@ vector<T>::vector(const vector &other)
 	_data = nullptr;
 	_size = 0;
 	alloc(other.capacity());
-	construct_at_end(other.cbegin(), other.cend());
+	construct_at_end(other.cdata(), other.cdata() + other.size());
 }
 
 /**
@@ -528,7 +566,7 @@ vector<T>::vector(std::initializer_list<T> init)
  */
 template <typename T>
 vector<T>::vector(const std::vector<T> &other)
-    : vector(other.cbegin(), other.cend())
+    : vector(other.data(), other.data() + other.size())
 {
 }
 
@@ -693,7 +731,20 @@ vector<T>::assign(InputIt first, InputIt last)
 	size_type size_new = static_cast<size_type>(std::distance(first, last));
 
 	flat_transaction::run(pb, [&] {
-		if (size_new <= capacity()) {
+		if (size_new <= capacity() &&
+		    is_bulk_assignable<InputIt>::value) {
+			/*
+			 * Reallocation is not needed. Elements are trivially
+			 * copyable and destructible, so old elements can
+			 * simply be overwritten by the new ones in bulk.
+			 * Elements past size_new are snapshotted as well,
+			 * because memory after size() is not preserved.
+			 */
+			add_data_to_tx(0, (std::max)(size_new, size()));
+
+			_size = 0;
+			construct_at_end(first, last);
+		} else if (size_new <= capacity()) {
 			/*
 			 * Reallocation is not needed. First, replace old
 			 * elements with new ones in range [0, size()).
@@ -767,7 +818,7 @@ void
 vector<T>::assign(const vector &other)
 {
 	if (this != &other)
-		assign(other.cbegin(), other.cend());
+		assign(other.cdata(), other.cdata() + other.size());
 }
 
 /**
@@ -818,7 +869,7 @@ template <typename T>
 void
 vector<T>::assign(const std::vector<T> &other)
 {
-	assign(other.cbegin(), other.cend());
+	assign(other.data(), other.data() + other.size());
 }
 
 /**
@@ -1966,7 +2017,7 @@ template <typename T>
 void
 vector<T>::resize(size_type count, const value_type &value)
 {
-	if (_capacity == count)
+	if (_size == count)
 		return;
 
 	pool_base pb = get_pool();
@@ -2062,6 +2113,8 @@ vector<T>::alloc(size_type capacity_new)
 				.with_pmemobj_errormsg();
 	}
 
+	detail::tx_stats_on_alloc(sizeof(value_type) * capacity_new);
+
 	_data = res;
 }
 
@@ -2165,6 +2218,59 @@ vector<T>::construct_at_end(InputIt first, InputIt last)
 
 	pointer dest = _data.get() + size();
 	_size += static_cast<size_type>(range_size);
+	copy_range(dest, first, last, is_bulk_copyable<InputIt>());
+}
+
+/**
+ * Private helper function. Must be called during transaction. Copies elements
+ * from the range [first, last) to the memory pointed by dest using memcpy.
+ * Large ranges are copied using non-temporal stores, without draining - data
+ * is made durable by the drain at transaction commit.
+ *
+ * @pre must be called in transaction scope.
+ * @pre range [dest, dest + std::distance(first, last)) must be snapshotted
+ * in current transaction or allocated in it.
+ */
+template <typename T>
+template <typename InputIt>
+void
+vector<T>::copy_range(pointer dest, InputIt first, InputIt last,
+		      std::true_type)
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	auto count = static_cast<size_type>(std::distance(first, last));
+	auto len = count * sizeof(value_type);
+	if (len == 0)
+		return;
+
+	auto src = detail::iterator_to_pointer(first);
+
+	if (len >= bulk_nontemporal_threshold)
+		pmemobj_memcpy(get_pool().handle(), dest, src, len,
+			       PMEMOBJ_F_MEM_NONTEMPORAL |
+				       PMEMOBJ_F_MEM_NODRAIN);
+	else
+		std::memcpy(static_cast<void *>(dest), src, len);
+}
+
+/**
+ * Private helper function. Must be called during transaction. Constructs
+ * elements from the range [first, last) in uninitialized memory pointed by
+ * dest.
+ *
+ * @pre must be called in transaction scope.
+ * @pre range [dest, dest + std::distance(first, last)) must be snapshotted
+ * in current transaction or allocated in it.
+ *
+ * @throw rethrows constructor's exception.
+ */
+template <typename T>
+template <typename InputIt>
+void
+vector<T>::copy_range(pointer dest, InputIt first, InputIt last,
+		      std::false_type)
+{
 	while (first != last)
 		detail::create<value_type>(dest++, *first++);
 }
@@ -2192,12 +2298,15 @@ vector<T>::dealloc()
 
 	if (_data != nullptr) {
 		shrink(0);
+		detail::tx_stats_on_free(*_data.raw_ptr());
 		if (pmemobj_tx_free(*_data.raw_ptr()) != 0)
 			throw pmem::transaction_free_error(
 				"failed to delete persistent memory object")
 				.with_pmemobj_errormsg();
 		_data = nullptr;
 		_capacity = 0;
+
+		detail::tx_snapshot_cache::get().invalidate();
 	}
 }
 
@@ -2249,6 +2358,14 @@ vector<T>::construct_or_assign(size_type idx, InputIt first, InputIt last)
 	auto dest = _data.get() + idx;
 	auto initialized_slots = static_cast<size_type>(cend() - dest);
 
+	/* Elements can be overwritten and created in bulk */
+	if (is_bulk_assignable<InputIt>::value ||
+	    (is_bulk_copyable<InputIt>::value && initialized_slots == 0)) {
+		copy_range(dest, first, last, is_bulk_copyable<InputIt>());
+		_size += count;
+		return;
+	}
+
 	/* Assign new elements to initialized memory */
 	if (dest < cend())
 		dest = std::copy_n(first, (std::min)(initialized_slots, count),
@@ -2308,10 +2425,11 @@ vector<T>::internal_insert(size_type idx, InputIt first, InputIt last)
 		construct_or_assign(idx, first, last);
 	} else {
 		/*
-		 * XXX: future optimization: we don't have to snapshot data
-		 * which we will copy (only snapshot for move)
+		 * Old elements are moved from only if moving modifies them -
+		 * otherwise they stay intact until the old array is freed.
 		 */
-		add_data_to_tx(0, _size);
+		if (!move_preserves_source())
+			add_data_to_tx(0, _size);
 
 		auto old_data = _data;
 		auto old_size = _size;
@@ -2341,10 +2459,13 @@ vector<T>::internal_insert(size_type idx, InputIt first, InputIt last)
 		for (size_type i = 0; i < old_size; ++i)
 			detail::destroy<value_type>(
 				old_data[static_cast<difference_type>(i)]);
+		detail::tx_stats_on_free(old_data.raw());
 		if (pmemobj_tx_free(old_data.raw()) != 0)
 			throw pmem::transaction_free_error(
 				"failed to delete persistent memory object")
 				.with_pmemobj_errormsg();
+
+		detail::tx_snapshot_cache::get().invalidate();
 	}
 }
 
@@ -2380,10 +2501,13 @@ vector<T>::realloc(size_type capacity_new)
 		return alloc(capacity_new);
 
 	/*
-	 * XXX: future optimization: we don't have to snapshot data
-	 * which we will not overwrite
+	 * The old array is freed in this transaction, hence it has to be
+	 * snapshotted only if moving or destroying elements modifies it.
+	 * Otherwise, on abort, transactional free is rolled back and the old
+	 * array is left intact.
 	 */
-	add_data_to_tx(0, _size);
+	if (!move_preserves_source())
+		add_data_to_tx(0, _size);
 
 	auto old_data = _data;
 	auto old_size = _size;
@@ -2404,10 +2528,28 @@ vector<T>::realloc(size_type capacity_new)
 	for (size_type i = 0; i < old_size; ++i)
 		detail::destroy<value_type>(
 			old_data[static_cast<difference_type>(i)]);
+	detail::tx_stats_on_free(old_data.raw());
 	if (pmemobj_tx_free(old_data.raw()) != 0)
 		throw pmem::transaction_free_error(
 			"failed to delete persistent memory object")
 			.with_pmemobj_errormsg();
+
+	detail::tx_snapshot_cache::get().invalidate();
+}
+
+/**
+ * Private helper function. Checks if moving an element out of the array and
+ * destroying it leaves the array memory unmodified.
+ *
+ * @return true if value_type is trivially move constructible and trivially
+ * destructible.
+ */
+template <typename T>
+constexpr bool
+vector<T>::move_preserves_source()
+{
+	return LIBPMEMOBJ_CPP_IS_TRIVIALLY_MOVE_CONSTRUCTIBLE(T) &&
+		std::is_trivially_destructible<T>::value;
 }
 
 /**
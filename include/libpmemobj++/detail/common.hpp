@@ -9,8 +9,10 @@
 #ifndef LIBPMEMOBJ_CPP_COMMON_HPP
 #define LIBPMEMOBJ_CPP_COMMON_HPP
 
+#include <libpmemobj++/detail/tx_stats.hpp>
 #include <libpmemobj++/pexceptions.hpp>
 #include <libpmemobj/tx_base.h>
+#include <cstdint>
 #include <string>
 #include <typeinfo>
 
@@ -105,9 +107,15 @@
 
 #if LIBPMEMOBJ_CPP_USE_HAS_TRIVIAL_COPY
 #define LIBPMEMOBJ_CPP_IS_TRIVIALLY_COPYABLE(T) __has_trivial_copy(T)
+#define LIBPMEMOBJ_CPP_IS_TRIVIALLY_MOVE_CONSTRUCTIBLE(T) __has_trivial_copy(T)
+#define LIBPMEMOBJ_CPP_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T) __has_trivial_copy(T)
 #else
 #define LIBPMEMOBJ_CPP_IS_TRIVIALLY_COPYABLE(T)                                \
 	std::is_trivially_copyable<T>::value
+#define LIBPMEMOBJ_CPP_IS_TRIVIALLY_MOVE_CONSTRUCTIBLE(T)                      \
+	std::is_trivially_move_constructible<T>::value
+#define LIBPMEMOBJ_CPP_IS_TRIVIALLY_COPY_CONSTRUCTIBLE(T)                      \
+	std::is_trivially_copy_constructible<T>::value
 #endif
 
 /*! \namespace pmem
@@ -159,6 +167,164 @@ static constexpr size_t CACHELINE_SIZE = 128ULL;
 #error unable to recognize architecture at compile time
 #endif
 
+/*
+ * Per-thread cache of ranges already added to the current transaction.
+ *
+ * It is enabled only for transactions started by basic_transaction or
+ * flat_transaction (which begin the outermost transaction with their own
+ * stage callback) and it is invalidated from that callback as soon as
+ * the transaction leaves TX_STAGE_WORK. Entries are tagged with
+ * a generation number, so starting a new transaction drops all of them
+ * without touching the table.
+ *
+ * Snapshotted ranges are kept in a set-associative table indexed by the
+ * cache line of the range start. A lookup hits only if a range snapshotted
+ * earlier in the same transaction fully covers the requested one.
+ *
+ * Objects allocated in the current transaction are kept in a separate,
+ * small table. libpmemobj does not snapshot such objects (they are freed
+ * on abort and flushed on commit), so any range within them hits as well.
+ * Freeing an object drops the whole cache, because its memory may be
+ * reused before the transaction ends.
+ */
+class tx_snapshot_cache {
+public:
+	static tx_snapshot_cache &
+	get() noexcept
+	{
+		static thread_local tx_snapshot_cache cache;
+		return cache;
+	}
+
+	/*
+	 * Called when the outermost transaction has started.
+	 */
+	void
+	begin() noexcept
+	{
+		++generation;
+		active = true;
+	}
+
+	/*
+	 * Called when the outermost transaction leaves TX_STAGE_WORK.
+	 */
+	void
+	end() noexcept
+	{
+		active = false;
+	}
+
+	/*
+	 * Drops all entries of the current transaction.
+	 */
+	void
+	invalidate() noexcept
+	{
+		++generation;
+	}
+
+	bool
+	enabled() const noexcept
+	{
+		return active;
+	}
+
+	bool
+	contains(const void *ptr, std::size_t size) const noexcept
+	{
+		if (!active)
+			return false;
+
+		auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+		auto *set = &entries[set_index(begin) * ways];
+
+		for (std::size_t i = 0; i < ways; ++i) {
+			if (set[i].covers(begin, size, generation))
+				return true;
+		}
+
+		for (std::size_t i = 0; i < alloc_ways; ++i) {
+			if (allocs[i].covers(begin, size, generation))
+				return true;
+		}
+
+		return false;
+	}
+
+	void
+	insert(const void *ptr, std::size_t size) noexcept
+	{
+		if (!active)
+			return;
+
+		auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+		auto idx = set_index(begin);
+
+		entries[idx * ways + next_way[idx]].assign(begin, size,
+							    generation);
+		next_way[idx] = static_cast<unsigned char>(
+			(next_way[idx] + 1) % ways);
+	}
+
+	/*
+	 * Records an object allocated in the current transaction.
+	 */
+	void
+	insert_allocation(const void *ptr, std::size_t size) noexcept
+	{
+		if (!active)
+			return;
+
+		allocs[next_alloc].assign(reinterpret_cast<std::uintptr_t>(ptr),
+					  size, generation);
+		next_alloc = static_cast<unsigned char>((next_alloc + 1) %
+							alloc_ways);
+	}
+
+private:
+	struct entry {
+		std::uintptr_t begin;
+		std::uintptr_t end;
+		std::uint64_t generation;
+
+		bool
+		covers(std::uintptr_t addr, std::size_t size,
+		       std::uint64_t gen) const noexcept
+		{
+			return generation == gen && begin <= addr &&
+				addr + size <= end;
+		}
+
+		void
+		assign(std::uintptr_t addr, std::size_t size,
+		       std::uint64_t gen) noexcept
+		{
+			begin = addr;
+			end = addr + size;
+			generation = gen;
+		}
+	};
+
+	static constexpr std::size_t sets = 16;
+	static constexpr std::size_t ways = 4;
+	static constexpr std::size_t alloc_ways = 4;
+
+	static std::size_t
+	set_index(std::uintptr_t addr) noexcept
+	{
+		return (addr / CACHELINE_SIZE) % sets;
+	}
+
+	entry entries[sets * ways] = {};
+	unsigned char next_way[sets] = {};
+	entry allocs[alloc_ways] = {};
+	unsigned char next_alloc = 0;
+	/* generation 0 is never used, so zeroed entries are always stale */
+	std::uint64_t generation = 0;
+	bool active = false;
+};
+
 /*
  * Conditionally add 'count' objects to a transaction.
  *
@@ -178,6 +344,15 @@ conditional_add_to_tx(const T *that, std::size_t count = 1, uint64_t flags = 0)
 	if (count == 0)
 		return;
 
+	auto size = sizeof(*that) * count;
+	auto &cache = tx_snapshot_cache::get();
+
+	/* already snapshotted in this transaction */
+	if (cache.contains(that, size)) {
+		tx_stats_on_redundant_snapshot();
+		return;
+	}
+
 	if (pmemobj_tx_stage() != TX_STAGE_WORK)
 		return;
 
@@ -185,7 +360,7 @@ conditional_add_to_tx(const T *that, std::size_t count = 1, uint64_t flags = 0)
 	if (!pmemobj_pool_by_ptr(that))
 		return;
 
-	if (pmemobj_tx_xadd_range_direct(that, sizeof(*that) * count, flags)) {
+	if (pmemobj_tx_xadd_range_direct(that, size, flags)) {
 		if (errno == ENOMEM)
 			throw pmem::transaction_out_of_memory(
 				"Could not add object(s) to the transaction.")
@@ -195,6 +370,16 @@ conditional_add_to_tx(const T *that, std::size_t count = 1, uint64_t flags = 0)
 				"Could not add object(s) to the transaction.")
 				.with_pmemobj_errormsg();
 	}
+
+	/*
+	 * Only remember ranges which were really snapshotted and will be
+	 * flushed on commit, so that a later plain add is not skipped.
+	 */
+	if ((flags & ~uint64_t(POBJ_XADD_ASSUME_INITIALIZED)) == 0)
+		cache.insert(that, size);
+
+	if ((flags & POBJ_XADD_NO_SNAPSHOT) == 0)
+		tx_stats_on_snapshot(size);
 }
 
 /*
@@ -38,9 +38,8 @@
 #include <atomic>
 #include <cassert>
 #include <functional>
-#include <mutex>
+#include <stdexcept>
 #include <thread>
-#include <unordered_map>
 
 #include <libpmemobj++/detail/common.hpp>
 
@@ -70,12 +69,17 @@ namespace detail
  */
 class ebr {
 	using atomic = std::atomic<size_t>;
-	using reference = std::reference_wrapper<atomic>;
+
+	struct slot;
 
 public:
 	class worker;
 
 	ebr();
+	~ebr();
+
+	ebr(const ebr &) = delete;
+	ebr &operator=(const ebr &) = delete;
 
 	worker register_worker();
 	bool sync();
@@ -86,19 +90,19 @@ public:
 	class worker {
 	public:
 		worker(const worker &w) = delete;
-		worker(worker &&w) = default;
+		worker(worker &&w);
 		~worker();
 
 		worker &operator=(worker &w) = delete;
-		worker &operator=(worker &&w) = default;
+		worker &operator=(worker &&w);
 
 		template <typename F>
 		void critical(F &&f);
 
 	private:
-		worker(ebr *e_, reference ref);
+		worker(ebr *e_, slot *s_);
 
-		reference local_epoch;
+		slot *s;
 		ebr *e;
 
 		friend ebr;
@@ -108,11 +112,34 @@ private:
 	static const size_t ACTIVE_FLAG = static_cast<size_t>(1)
 		<< (sizeof(size_t) * 8 - 1);
 	static const size_t EPOCHS_NUMBER = 3;
+	static const size_t SLOTS_PER_BLOCK = 32;
+
+	/* Local epoch of a single worker. Slot takes more than a cacheline,
+	 * so local epochs of different workers never share a cacheline. */
+	struct slot {
+		atomic local_epoch;
+		std::atomic<std::thread::id> owner;
+		char padding[CACHELINE_SIZE];
+
+		slot() : local_epoch(0), owner(std::thread::id())
+		{
+		}
+	};
+
+	/* Slots are stored in a list of blocks. Blocks are only appended
+	 * (never freed before ebr destruction), so slots do not move. */
+	struct slot_block {
+		slot slots[SLOTS_PER_BLOCK];
+		std::atomic<slot_block *> next;
+
+		slot_block() : next(nullptr)
+		{
+		}
+	};
 
 	atomic global_epoch;
 
-	std::unordered_map<std::thread::id, atomic> workers;
-	std::mutex mtx;
+	slot_block slots;
 };
 
 /**
@@ -125,6 +152,19 @@ ebr::ebr() : global_epoch(0)
 #endif
 }
 
+/**
+ * Destroys ebr object. All workers should be destroyed before.
+ */
+ebr::~ebr()
+{
+	auto b = slots.next.load();
+	while (b != nullptr) {
+		auto next = b->next.load();
+		delete b;
+		b = next;
+	}
+}
+
 /**
  * Registers and returns a new worker, which can perform critical operations
  * (accessing some shared data that can be removed in other threads). There can
@@ -139,14 +179,40 @@ ebr::ebr() : global_epoch(0)
 ebr::worker
 ebr::register_worker()
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	auto res = workers.emplace(std::this_thread::get_id(), 0);
-	if (!res.second) {
+	auto id = std::this_thread::get_id();
+
+	/* Only the current thread might store its id in a slot. */
+	bool registered = false;
+	for (auto b = &slots; b != nullptr; b = b->next.load()) {
+		for (auto &s : b->slots)
+			registered = registered || s.owner.load() == id;
+	}
+
+	if (registered) {
 		throw std::runtime_error(
 			"There can be only one worker per thread");
 	}
 
-	return worker{this, reference{res.first->second}};
+	for (auto b = &slots;;) {
+		for (auto &s : b->slots) {
+			auto expected = std::thread::id();
+			if (s.owner.load() == expected &&
+			    s.owner.compare_exchange_strong(expected, id))
+				return worker{this, &s};
+		}
+
+		/* All slots are taken, append a new block. */
+		auto next = b->next.load();
+		if (next == nullptr) {
+			auto new_block = new slot_block();
+			if (b->next.compare_exchange_strong(next, new_block))
+				next = new_block;
+			else
+				delete new_block;
+		}
+
+		b = next;
+	}
 }
 
 /**
@@ -166,14 +232,16 @@ ebr::sync()
 {
 	auto current_epoch = global_epoch.load();
 
-	std::lock_guard<std::mutex> lock(mtx);
-	for (auto &w : workers) {
-		LIBPMEMOBJ_CPP_ANNOTATE_HAPPENS_BEFORE(
-			std::memory_order_seq_cst, &w.second);
-		auto local_e = w.second.load();
-		bool active = local_e & ACTIVE_FLAG;
-		if (active && (local_e != (current_epoch | ACTIVE_FLAG))) {
-			return false;
+	for (auto b = &slots; b != nullptr; b = b->next.load()) {
+		for (auto &s : b->slots) {
+			LIBPMEMOBJ_CPP_ANNOTATE_HAPPENS_BEFORE(
+				std::memory_order_seq_cst, &s.local_epoch);
+			auto local_e = s.local_epoch.load();
+			bool active = local_e & ACTIVE_FLAG;
+			if (active &&
+			    (local_e != (current_epoch | ACTIVE_FLAG))) {
+				return false;
+			}
 		}
 	}
 
@@ -236,21 +304,47 @@ ebr::gc_epoch()
 	return res;
 }
 
-ebr::worker::worker(ebr *e_, reference ref) : local_epoch(ref), e(e_)
+ebr::worker::worker(ebr *e_, slot *s_) : s(s_), e(e_)
 {
 #if LIBPMEMOBJ_CPP_VG_HELGRIND_ENABLED
-	VALGRIND_HG_DISABLE_CHECKING(&ref.get(), sizeof(ref.get()));
+	VALGRIND_HG_DISABLE_CHECKING(&s->local_epoch, sizeof(s->local_epoch));
 #endif
 }
 
+/**
+ * Move constructor.
+ */
+ebr::worker::worker(worker &&w) : s(w.s), e(w.e)
+{
+	w.s = nullptr;
+}
+
+/**
+ * Move assignment operator.
+ */
+ebr::worker &
+ebr::worker::operator=(worker &&w)
+{
+	if (this != &w) {
+		if (s)
+			s->owner.store(std::thread::id());
+
+		s = w.s;
+		e = w.e;
+		w.s = nullptr;
+	}
+
+	return *this;
+}
+
 /**
  * Unregisters the worker from the list of the workers in the ebr. All workers
  * should be destroyed before the destruction of ebr object.
  */
 ebr::worker::~worker()
 {
-	std::lock_guard<std::mutex> lock(e->mtx);
-	e->workers.erase(std::this_thread::get_id());
+	if (s)
+		s->owner.store(std::thread::id());
 }
 
 /**
@@ -269,13 +363,13 @@ ebr::worker::critical(F &&f)
 	LIBPMEMOBJ_CPP_ANNOTATE_HAPPENS_AFTER(std::memory_order_seq_cst,
 					      &(e->global_epoch));
 
-	local_epoch.get().store(new_epoch);
+	s->local_epoch.store(new_epoch);
 	LIBPMEMOBJ_CPP_ANNOTATE_HAPPENS_AFTER(std::memory_order_seq_cst,
-					      &local_epoch);
+					      &s->local_epoch);
 
 	f();
 
-	local_epoch.get().store(0);
+	s->local_epoch.store(0);
 }
 
 } /* namespace detail */
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2019-2020, Intel Corporation */
+/* Copyright 2019-2021, Intel Corporation */
 
 /**
  * @file
@@ -11,10 +11,13 @@
 
 #include <libpmemobj++/container/segment_vector.hpp>
 #include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
 #include <libpmemobj++/mutex.hpp>
 #include <libpmemobj++/shared_mutex.hpp>
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <mutex>
 #include <numeric>
@@ -66,6 +69,26 @@ private:
 	static id_manager &get_id_manager();
 };
 
+/**
+ * Returns epoch of enumerable_thread_specific objects placed at addresses
+ * which map to the same slot as ptr. It is incremented each time any of
+ * these objects is constructed or cleared, so that references cached by
+ * local() for the previous contents of the object (or for another object
+ * placed at the same address) are not used anymore. Epochs are kept in
+ * volatile memory, as they are meaningful only while the process runs.
+ */
+inline std::atomic<size_t> &
+ets_epoch(const void *ptr)
+{
+	static constexpr std::size_t slots = 64;
+	static std::atomic<size_t> epochs[slots];
+
+	/* Objects are larger than a cacheline, skip bits of the offset. */
+	auto slot = (reinterpret_cast<std::uintptr_t>(ptr) >> 6) % slots;
+
+	return epochs[slot];
+}
+
 /**
  * Class for storing thread local data.
  * Needed in concurrent containers for data consistency.
@@ -130,6 +153,22 @@ private:
 	obj::pool_base get_pool() const noexcept;
 	void set_cached_size(size_t s);
 	size_t get_cached_size();
+	reference local_slow(size_t index);
+
+	/* Reference to the current thread's element of an object, valid as
+	 * long as the epoch of the object and the generation of pool lookups
+	 * (changed when a pool is closed) did not change. */
+	struct local_cache_entry {
+		const enumerable_thread_specific *owner = nullptr;
+		size_t epoch = 0;
+		std::uint64_t pool_generation = 0;
+		pointer value = nullptr;
+	};
+
+	/* Number of entries of the direct-mapped cache, power of 2. */
+	static constexpr size_t local_cache_size = 8;
+
+	local_cache_entry &get_local_cache_entry() const;
 
 	mutex_type _mutex;
 	storage_type _storage;
@@ -227,6 +266,17 @@ thread_id_type::get()
 	return id;
 }
 
+/**
+ * Obtain index of the current thread, unique among running threads. Indexes
+ * are small integers, reused after a thread exits.
+ */
+inline size_t
+this_thread_index()
+{
+	static thread_local thread_id_type tid;
+	return tid.get();
+}
+
 /**
  * Constructor.
  */
@@ -234,6 +284,9 @@ template <typename T, typename Mutex, typename Storage>
 enumerable_thread_specific<T, Mutex, Storage>::enumerable_thread_specific()
 {
 	_storage_size.get_rw() = 0;
+
+	/* New object might be placed at the address of a destroyed one. */
+	ets_epoch(this)++;
 }
 
 /**
@@ -295,6 +348,8 @@ enumerable_thread_specific<T, Mutex, Storage>::initialize(Handler handler)
 /**
  * Returns data reference for the current thread.
  * For the new thread, element by reference will be default constructed.
+ * The reference is cached per thread and object, so subsequent calls from
+ * the same thread do not access the storage (until clear() is called).
  *
  * @pre must be called outside of a transaction.
  *
@@ -306,9 +361,51 @@ enumerable_thread_specific<T, Mutex, Storage>::local()
 {
 	assert(pmemobj_tx_stage() != TX_STAGE_WORK);
 
-	static thread_local thread_id_type tid;
-	auto index = tid.get();
+	auto &entry = get_local_cache_entry();
+	auto epoch = ets_epoch(this).load(std::memory_order_relaxed);
+	auto pool_generation =
+		pool_by_ptr_generation().load(std::memory_order_acquire);
 
+	if (entry.owner == this && entry.epoch == epoch &&
+	    entry.pool_generation == pool_generation)
+		return *entry.value;
+
+	auto &ret = local_slow(this_thread_index());
+
+	entry.owner = this;
+	entry.epoch = epoch;
+	entry.pool_generation = pool_generation;
+	entry.value = &ret;
+
+	return ret;
+}
+
+/**
+ * Returns entry of the thread-local cache of references returned by local(),
+ * in which this object is cached. The cache is direct-mapped by the address
+ * of the object.
+ */
+template <typename T, typename Mutex, typename Storage>
+typename enumerable_thread_specific<T, Mutex, Storage>::local_cache_entry &
+enumerable_thread_specific<T, Mutex, Storage>::get_local_cache_entry() const
+{
+	static thread_local local_cache_entry cache[local_cache_size];
+
+	/* Objects are larger than a cacheline, skip bits of the offset. */
+	auto index = (reinterpret_cast<std::uintptr_t>(this) >> 6) &
+		(local_cache_size - 1);
+
+	return cache[index];
+}
+
+/**
+ * Returns data reference for the thread with specified index, resizes the
+ * storage if needed.
+ */
+template <typename T, typename Mutex, typename Storage>
+typename enumerable_thread_specific<T, Mutex, Storage>::reference
+enumerable_thread_specific<T, Mutex, Storage>::local_slow(size_t index)
+{
 	auto cached_size = get_cached_size();
 
 	if (index >= cached_size) {
@@ -346,6 +443,9 @@ enumerable_thread_specific<T, Mutex, Storage>::clear()
 {
 	auto pop = get_pool();
 
+	/* References cached by local() are no longer valid. */
+	ets_epoch(this)++;
+
 	obj::flat_transaction::run(pop, [&] {
 		_storage_size.get_rw() = 0;
 		_storage.clear();
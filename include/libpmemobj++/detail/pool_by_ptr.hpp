@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Cached lookup of the pool of a pmem-resident object.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_POOL_BY_PTR_HPP
+#define LIBPMEMOBJ_CPP_POOL_BY_PTR_HPP
+
+#include <libpmemobj/base.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace pmem
+{
+
+namespace detail
+{
+
+/*
+ * Generation of cached pool lookups, incremented whenever a pool is closed
+ * by pool_base::close().
+ */
+inline std::atomic<std::uint64_t> &
+pool_by_ptr_generation()
+{
+	static std::atomic<std::uint64_t> generation(1);
+
+	return generation;
+}
+
+/*
+ * Invalidates pool lookups cached by all threads.
+ */
+inline void
+pool_by_ptr_invalidate()
+{
+	pool_by_ptr_generation().fetch_add(1, std::memory_order_release);
+}
+
+/*
+ * Returns handle of the pool which contains ptr, nullptr if there is none.
+ *
+ * It is equivalent to pmemobj_pool_by_ptr(), which looks the pool up in
+ * a tree of all open pools, but it remembers the last pool found by each
+ * thread together with the lowest and the highest address looked up in it.
+ * A pool is mapped at contiguous addresses, so every address between those
+ * two belongs to the same pool and is resolved without calling libpmemobj.
+ * The cache is invalidated when a pool is closed by pool_base::close().
+ */
+inline PMEMobjpool *
+pool_by_ptr(const void *ptr)
+{
+	struct cache_entry {
+		PMEMobjpool *pop;
+		std::uintptr_t begin;
+		std::uintptr_t end;
+		std::uint64_t generation;
+	};
+
+	static thread_local cache_entry cache = {nullptr, 0, 0, 0};
+
+	auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+	auto generation =
+		pool_by_ptr_generation().load(std::memory_order_acquire);
+
+	if (cache.generation == generation && addr >= cache.begin &&
+	    addr < cache.end)
+		return cache.pop;
+
+	auto pop = pmemobj_pool_by_ptr(ptr);
+	if (pop == nullptr)
+		return nullptr;
+
+	if (cache.pop != pop || cache.generation != generation) {
+		cache.pop = pop;
+		cache.begin = addr;
+		cache.end = addr + 1;
+		cache.generation = generation;
+	} else if (addr < cache.begin) {
+		cache.begin = addr;
+	} else {
+		cache.end = addr + 1;
+	}
+
+	return pop;
+}
+
+} /* namespace detail */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_POOL_BY_PTR_HPP */
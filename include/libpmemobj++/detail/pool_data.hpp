@@ -1,17 +1,23 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2019, Intel Corporation */
+/* Copyright 2019-2021, Intel Corporation */
 
 /**
  * @file
  * A volatile data stored along with pmemobjpool. Stores cleanup function which
- * is called on pool close.
+ * is called on pool close, ids of registered allocation classes and arenas.
  */
 
 #ifndef LIBPMEMOBJ_CPP_POOL_DATA_HPP
 #define LIBPMEMOBJ_CPP_POOL_DATA_HPP
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace pmem
 {
@@ -22,7 +28,11 @@ namespace detail
 struct pool_data {
 	pool_data()
 	{
+		static std::atomic<uint64_t> next_generation(1);
+
 		initialized = false;
+		generation = next_generation.fetch_add(
+			1, std::memory_order_relaxed);
 	}
 
 	/* Set cleanup function if not already set */
@@ -42,6 +52,18 @@ struct pool_data {
 
 	std::atomic<bool> initialized;
 	std::function<void()> cleanup;
+
+	/* unique for every opened pool, identifies cached values */
+	uint64_t generation;
+
+	/* ids of allocation classes registered by allocation_class<T>,
+	 * indexed by unit size and alignment */
+	std::mutex alloc_classes_mutex;
+	std::map<std::pair<std::size_t, std::size_t>, unsigned> alloc_classes;
+
+	/* arenas created by arena_per_thread, indexed by thread index */
+	std::mutex thread_arenas_mutex;
+	std::vector<unsigned> thread_arenas;
 };
 
 } /* namespace detail */
@@ -45,8 +45,11 @@
 #include <atomic>
 #include <cassert>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 
 #include <libpmemobj++/detail/atomic_backoff.hpp>
+#include <libpmemobj++/detail/common.hpp>
 
 #ifdef _WIN32
 #define __predict_false(x) (x)
@@ -82,10 +85,18 @@ struct ringbuf_worker_t {
 	std::atomic<ringbuf_off_t> seen_off;
 	std::atomic<int> registered;
 
+	/* Index of the lane, used only by ringbuf_lanes_t. */
+	unsigned lane;
+
+	/* Workers are stored in an array and each of them is modified by
+	 * a different thread - avoid false sharing. */
+	char padding[pmem::detail::CACHELINE_SIZE];
+
 	ringbuf_worker_t()
 	{
 		seen_off.store(0);
 		registered.store(0);
+		lane = 0;
 	}
 };
 
@@ -101,6 +112,9 @@ struct ringbuf_t {
 	std::atomic<ringbuf_off_t> next;
 	std::atomic<ringbuf_off_t> end;
 
+	/* Separate offsets modified by producers from the consumer ones. */
+	char padding[pmem::detail::CACHELINE_SIZE];
+
 	/* The following are updated by the consumer. */
 	std::atomic<ringbuf_off_t> written;
 	unsigned nworkers;
@@ -146,6 +160,51 @@ struct ringbuf_t {
 	}
 };
 
+/*
+ * Lane-partitioned ring buffer. The space is split into nlanes equal,
+ * independent sub-rings (lanes). Each worker produces only to its own lane,
+ * so producers assigned to different lanes never contend on the same 'next'
+ * offset. The consumer merges the lanes in a round-robin manner.
+ *
+ * Offsets returned by ringbuf_lanes_acquire and ringbuf_lanes_consume are
+ * relative to the beginning of the entire buffer. Ranges produced to
+ * the same lane are consumed in order, there is no ordering between lanes.
+ */
+struct ringbuf_lanes_t {
+	/* Space of a single lane. */
+	size_t lane_space;
+	std::vector<std::unique_ptr<ringbuf_t>> lanes;
+
+	/* Lane of the consume in progress, or the lane which will be checked
+	 * first by the next ringbuf_lanes_consume. */
+	size_t consume_lane;
+
+	/**
+	 * Creates new ringbuf_lanes_t instance.
+	 *
+	 * Worker i is assigned to lane i % nlanes.
+	 * Length must be < RBUF_OFF_MASK and >= nlanes.
+	 */
+	ringbuf_lanes_t(size_t max_workers, size_t nlanes, size_t length)
+	{
+		if (nlanes == 0 || length < nlanes)
+			throw std::invalid_argument(
+				"ringbuf number of lanes invalid");
+
+		if (length >= RBUF_OFF_MASK)
+			throw std::out_of_range("ringbuf length too big");
+
+		lane_space = length / nlanes;
+		consume_lane = 0;
+
+		auto lane_workers = (max_workers + nlanes - 1) / nlanes;
+		for (size_t i = 0; i < nlanes; i++)
+			lanes.emplace_back(new ringbuf_t(
+				(std::max)(lane_workers, size_t(1)),
+				lane_space));
+	}
+};
+
 /*
  * ringbuf_register: register the worker (thread/process) as a producer
  * and pass the pointer to its local store.
@@ -168,6 +227,29 @@ ringbuf_unregister(ringbuf_t *rbuf, ringbuf_worker_t *w)
 	(void)rbuf;
 }
 
+/*
+ * ringbuf_lanes_register: register the worker as a producer of the lane
+ * i % nlanes.
+ */
+inline ringbuf_worker_t *
+ringbuf_lanes_register(ringbuf_lanes_t *rbuf, unsigned i)
+{
+	auto nlanes = static_cast<unsigned>(rbuf->lanes.size());
+	auto lane = i % nlanes;
+
+	ringbuf_worker_t *w =
+		ringbuf_register(rbuf->lanes[lane].get(), i / nlanes);
+	w->lane = lane;
+
+	return w;
+}
+
+inline void
+ringbuf_lanes_unregister(ringbuf_lanes_t *rbuf, ringbuf_worker_t *w)
+{
+	ringbuf_unregister(rbuf->lanes[w->lane].get(), w);
+}
+
 /*
  * stable_nextoff: capture and return a stable value of the 'next' offset.
  */
@@ -453,6 +535,25 @@ retry:
 	return towrite;
 }
 
+/*
+ * ringbuf_empty: check whether all acquired ranges were already consumed
+ * and released. Might only be called by the consumer.
+ */
+inline bool
+ringbuf_empty(ringbuf_t *rbuf)
+{
+	assert(!rbuf->consume_in_progress);
+
+	ringbuf_off_t next = std::atomic_load_explicit<ringbuf_off_t>(
+		&rbuf->next, std::memory_order_acquire);
+
+	/* Wrap-around is in progress. */
+	if (next & WRAP_LOCK_BIT)
+		return false;
+
+	return (next & RBUF_OFF_MASK) == rbuf->written;
+}
+
 /*
  * ringbuf_release: indicate that the consumed range can now be released.
  */
@@ -470,6 +571,71 @@ ringbuf_release(ringbuf_t *rbuf, size_t nbytes)
 	rbuf->written = (nwritten == rbuf->space) ? 0 : nwritten;
 }
 
+/*
+ * ringbuf_lanes_acquire: request a space of a given length in the worker's
+ * lane. Length must not exceed the lane space.
+ *
+ * => On success: returns the offset at which the space is available.
+ * => On failure: returns -1.
+ */
+inline ptrdiff_t
+ringbuf_lanes_acquire(ringbuf_lanes_t *rbuf, ringbuf_worker_t *w, size_t len)
+{
+	auto off = ringbuf_acquire(rbuf->lanes[w->lane].get(), w, len);
+	if (off < 0)
+		return off;
+
+	return off + static_cast<ptrdiff_t>(w->lane * rbuf->lane_space);
+}
+
+/*
+ * ringbuf_lanes_produce: indicate the acquired range in the lane is produced
+ * and is ready to be consumed.
+ */
+inline void
+ringbuf_lanes_produce(ringbuf_lanes_t *rbuf, ringbuf_worker_t *w)
+{
+	ringbuf_produce(rbuf->lanes[w->lane].get(), w);
+}
+
+/*
+ * ringbuf_lanes_consume: get a contiguous range which is ready to be
+ * consumed from any of the lanes. Lanes are checked in a round-robin
+ * manner, starting from the one following the last consumed lane.
+ *
+ * Nested consumes are not allowed.
+ */
+inline size_t
+ringbuf_lanes_consume(ringbuf_lanes_t *rbuf, size_t *offset)
+{
+	auto nlanes = rbuf->lanes.size();
+
+	for (size_t i = 0; i < nlanes; i++) {
+		auto lane = (rbuf->consume_lane + i) % nlanes;
+		auto len = ringbuf_consume(rbuf->lanes[lane].get(), offset);
+		if (len) {
+			rbuf->consume_lane = lane;
+			*offset += lane * rbuf->lane_space;
+			return len;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * ringbuf_lanes_release: indicate that the consumed range can now be
+ * released.
+ */
+inline void
+ringbuf_lanes_release(ringbuf_lanes_t *rbuf, size_t nbytes)
+{
+	auto nlanes = rbuf->lanes.size();
+
+	ringbuf_release(rbuf->lanes[rbuf->consume_lane].get(), nbytes);
+	rbuf->consume_lane = (rbuf->consume_lane + 1) % nlanes;
+}
+
 } /* namespace ringbuf */
 } /* namespace experimental */
 } /* namespace obj*/
@@ -0,0 +1,424 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Search primitives for strings of bytes, used by string_view and
+ * basic_string.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_STRING_SEARCH_HPP
+#define LIBPMEMOBJ_CPP_STRING_SEARCH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LIBPMEMOBJ_CPP_STRING_SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_SSE2 &&                                       \
+	(defined(__GNUC__) || defined(__clang__))
+#define LIBPMEMOBJ_CPP_STRING_SEARCH_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace pmem
+{
+
+namespace detail
+{
+
+/**
+ * Checks if strings of CharT with Traits can be searched as plain bytes.
+ * Other Traits may define custom comparison of characters.
+ */
+template <typename CharT, typename Traits>
+using is_byte_string = std::integral_constant<
+	bool,
+	std::is_same<CharT, char>::value &&
+		std::is_same<Traits, std::char_traits<char>>::value>;
+
+static constexpr std::size_t byte_string_npos =
+	(std::numeric_limits<std::size_t>::max)();
+
+/**
+ * Set of bytes, represented as a 256-bit bitmap. Membership test takes
+ * constant time, so the find_*_of family is linear in length of both
+ * searched string and set of characters.
+ */
+class byte_set {
+public:
+	byte_set(const char *s, std::size_t count, bool complement)
+	{
+		for (auto &b : bits)
+			b = 0;
+
+		for (std::size_t i = 0; i < count; ++i) {
+			auto c = static_cast<unsigned char>(s[i]);
+			bits[c / 64] |= uint64_t(1) << (c % 64);
+		}
+
+		if (complement) {
+			for (auto &b : bits)
+				b = ~b;
+		}
+	}
+
+	bool
+	contains(char ch) const
+	{
+		auto c = static_cast<unsigned char>(ch);
+		return (bits[c / 64] >> (c % 64)) & 1;
+	}
+
+private:
+	uint64_t bits[4];
+};
+
+/** Returns index of least significant set bit */
+static inline unsigned
+lssb_index32(uint32_t value)
+{
+#if _MSC_VER
+	unsigned long ret;
+	_BitScanForward(&ret, value);
+	return static_cast<unsigned>(ret);
+#else
+	return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+}
+
+/** Returns index of most significant set bit */
+static inline unsigned
+mssb_index32(uint32_t value)
+{
+#if _MSC_VER
+	unsigned long ret;
+	_BitScanReverse(&ret, value);
+	return static_cast<unsigned>(ret);
+#else
+	return static_cast<unsigned>(31 - __builtin_clz(value));
+#endif
+}
+
+/*
+ * The substring search kernels below check 16 (or 32) candidate positions
+ * at once: a position is a candidate if both the first and the last
+ * character of the needle match. Only for candidates the rest of the
+ * needle is compared. Vector loads never read past the end of the string,
+ * remaining positions are checked by the scalar loop.
+ */
+
+/**
+ * Scalar substring search in positions [pos, last_pos].
+ */
+static inline std::size_t
+byte_string_find_scalar(const char *str, std::size_t pos, std::size_t last_pos,
+			const char *s, std::size_t count)
+{
+	while (pos <= last_pos) {
+		auto found = static_cast<const char *>(
+			std::memchr(str + pos, s[0], last_pos - pos + 1));
+		if (!found)
+			return byte_string_npos;
+
+		pos = static_cast<std::size_t>(found - str);
+		if (std::memcmp(found + 1, s + 1, count - 1) == 0)
+			return pos;
+		++pos;
+	}
+
+	return byte_string_npos;
+}
+
+/**
+ * Scalar reverse substring search in positions [0, pos].
+ */
+static inline std::size_t
+byte_string_rfind_scalar(const char *str, std::size_t pos, const char *s,
+			 std::size_t count)
+{
+	do {
+		if (str[pos] == s[0] &&
+		    std::memcmp(str + pos + 1, s + 1, count - 1) == 0)
+			return pos;
+	} while (pos-- > 0);
+
+	return byte_string_npos;
+}
+
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_SSE2
+/**
+ * Substring search in positions [pos, last_pos], using SSE2.
+ */
+static inline std::size_t
+byte_string_find_sse2(const char *str, std::size_t pos, std::size_t last_pos,
+		      const char *s, std::size_t count)
+{
+	const __m128i first = _mm_set1_epi8(s[0]);
+	const __m128i last = _mm_set1_epi8(s[count - 1]);
+
+	for (; pos + 15 <= last_pos; pos += 16) {
+		__m128i a = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(str + pos));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+			str + pos + count - 1));
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(a, first),
+				      _mm_cmpeq_epi8(b, last))));
+
+		while (mask != 0) {
+			std::size_t candidate = pos + lssb_index32(mask);
+			if (std::memcmp(str + candidate + 1, s + 1,
+					count - 1) == 0)
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+
+	return byte_string_find_scalar(str, pos, last_pos, s, count);
+}
+
+/**
+ * Reverse substring search in positions [0, pos], using SSE2.
+ */
+static inline std::size_t
+byte_string_rfind_sse2(const char *str, std::size_t pos, const char *s,
+		       std::size_t count)
+{
+	const __m128i first = _mm_set1_epi8(s[0]);
+	const __m128i last = _mm_set1_epi8(s[count - 1]);
+
+	for (; pos >= 16; pos -= 16) {
+		const char *block = str + pos - 15;
+		__m128i a = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(block));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+			block + count - 1));
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(a, first),
+				      _mm_cmpeq_epi8(b, last))));
+
+		while (mask != 0) {
+			unsigned bit = mssb_index32(mask);
+			if (std::memcmp(block + bit + 1, s + 1, count - 1) ==
+			    0)
+				return pos - 15 + bit;
+			mask &= ~(uint32_t(1) << bit);
+		}
+	}
+
+	return byte_string_rfind_scalar(str, pos, s, count);
+}
+#endif
+
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_AVX2
+/**
+ * Substring search in positions [pos, last_pos], using AVX2.
+ */
+__attribute__((target("avx2"))) static inline std::size_t
+byte_string_find_avx2(const char *str, std::size_t pos, std::size_t last_pos,
+		      const char *s, std::size_t count)
+{
+	const __m256i first = _mm256_set1_epi8(s[0]);
+	const __m256i last = _mm256_set1_epi8(s[count - 1]);
+
+	for (; pos + 31 <= last_pos; pos += 32) {
+		const char *block = str + pos;
+		__m256i a = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i *>(block));
+		__m256i b = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i *>(block + count - 1));
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+					 _mm256_cmpeq_epi8(b, last))));
+
+		while (mask != 0) {
+			std::size_t candidate = pos + lssb_index32(mask);
+			if (std::memcmp(str + candidate + 1, s + 1,
+					count - 1) == 0)
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+
+	return byte_string_find_sse2(str, pos, last_pos, s, count);
+}
+
+/**
+ * Reverse substring search in positions [0, pos], using AVX2.
+ */
+__attribute__((target("avx2"))) static inline std::size_t
+byte_string_rfind_avx2(const char *str, std::size_t pos, const char *s,
+		       std::size_t count)
+{
+	const __m256i first = _mm256_set1_epi8(s[0]);
+	const __m256i last = _mm256_set1_epi8(s[count - 1]);
+
+	for (; pos >= 32; pos -= 32) {
+		const char *block = str + pos - 31;
+		__m256i a = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i *>(block));
+		__m256i b = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i *>(block + count - 1));
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+					 _mm256_cmpeq_epi8(b, last))));
+
+		while (mask != 0) {
+			unsigned bit = mssb_index32(mask);
+			if (std::memcmp(block + bit + 1, s + 1, count - 1) ==
+			    0)
+				return pos - 31 + bit;
+			mask &= ~(uint32_t(1) << bit);
+		}
+	}
+
+	return byte_string_rfind_sse2(str, pos, s, count);
+}
+
+/**
+ * Checks (once) if the CPU supports AVX2.
+ */
+static inline bool
+cpu_has_avx2()
+{
+	static const bool has_avx2 = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+	}();
+
+	return has_avx2;
+}
+#endif
+
+/**
+ * Finds the first substring equal to [s, s + count) in string
+ * [str, str + size), starting at position pos. Semantics are the same as of
+ * std::string::find().
+ */
+static inline std::size_t
+byte_string_find(const char *str, std::size_t size, const char *s,
+		 std::size_t pos, std::size_t count)
+{
+	if (pos > size)
+		return byte_string_npos;
+
+	if (count == 0)
+		return pos;
+
+	if (count > size - pos)
+		return byte_string_npos;
+
+	if (count == 1) {
+		auto found = static_cast<const char *>(
+			std::memchr(str + pos, s[0], size - pos));
+		return found ? static_cast<std::size_t>(found - str)
+			     : byte_string_npos;
+	}
+
+	std::size_t last_pos = size - count;
+
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_AVX2
+	if (cpu_has_avx2())
+		return byte_string_find_avx2(str, pos, last_pos, s, count);
+#endif
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_SSE2
+	return byte_string_find_sse2(str, pos, last_pos, s, count);
+#else
+	return byte_string_find_scalar(str, pos, last_pos, s, count);
+#endif
+}
+
+/**
+ * Finds the last substring equal to [s, s + count) in string
+ * [str, str + size), which begins at or before position pos. Semantics are
+ * the same as of std::string::rfind().
+ */
+static inline std::size_t
+byte_string_rfind(const char *str, std::size_t size, const char *s,
+		  std::size_t pos, std::size_t count)
+{
+	if (count > size)
+		return byte_string_npos;
+
+	pos = (std::min)(size - count, pos);
+	if (count == 0)
+		return pos;
+
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_AVX2
+	if (cpu_has_avx2())
+		return byte_string_rfind_avx2(str, pos, s, count);
+#endif
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_SSE2
+	return byte_string_rfind_sse2(str, pos, s, count);
+#else
+	return byte_string_rfind_scalar(str, pos, s, count);
+#endif
+}
+
+/**
+ * Finds the first character in string [str, str + size), starting at
+ * position pos, which is equal to any of the characters in [s, s + count)
+ * (or to none of them if complement is true).
+ */
+static inline std::size_t
+byte_string_find_first_of(const char *str, std::size_t size, const char *s,
+			  std::size_t pos, std::size_t count, bool complement)
+{
+	if (pos >= size)
+		return byte_string_npos;
+
+	if (count == 1 && !complement) {
+		auto found = static_cast<const char *>(
+			std::memchr(str + pos, s[0], size - pos));
+		return found ? static_cast<std::size_t>(found - str)
+			     : byte_string_npos;
+	}
+
+	byte_set set(s, count, complement);
+	for (; pos < size; ++pos)
+		if (set.contains(str[pos]))
+			return pos;
+
+	return byte_string_npos;
+}
+
+/**
+ * Finds the last character in string [str, str + size), at or before
+ * position pos, which is equal to any of the characters in [s, s + count)
+ * (or to none of them if complement is true).
+ */
+static inline std::size_t
+byte_string_find_last_of(const char *str, std::size_t size, const char *s,
+			 std::size_t pos, std::size_t count, bool complement)
+{
+	if (size == 0)
+		return byte_string_npos;
+
+	pos = (std::min)(pos, size - 1);
+
+	byte_set set(s, count, complement);
+	do {
+		if (set.contains(str[pos]))
+			return pos;
+	} while (pos-- > 0);
+
+	return byte_string_npos;
+}
+
+} /* namespace detail */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_STRING_SEARCH_HPP */
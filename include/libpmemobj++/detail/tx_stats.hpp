@@ -0,0 +1,408 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Transaction instrumentation hooks.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_TX_STATS_HPP
+#define LIBPMEMOBJ_CPP_TX_STATS_HPP
+
+#include <libpmemobj/base.h>
+#include <libpmemobj/tx_base.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef LIBPMEMOBJ_CPP_USE_TX_STATS
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+#endif
+
+namespace pmem
+{
+
+namespace detail
+{
+
+#ifdef LIBPMEMOBJ_CPP_USE_TX_STATS
+
+/*
+ * Counters of one call site in one thread. They are only modified by the
+ * owning thread, but may be read concurrently by tx_stats::collect().
+ */
+struct tx_site_counters {
+	using counter = std::atomic<std::uint64_t>;
+
+	counter transactions{0};
+	counter commits{0};
+	counter aborts{0};
+	counter snapshots{0};
+	counter snapshot_bytes{0};
+	counter redundant_snapshots{0};
+	counter allocations{0};
+	counter allocation_bytes{0};
+	counter frees{0};
+	counter free_bytes{0};
+	counter duration_ns{0};
+	counter max_duration_ns{0};
+	counter commit_ns{0};
+
+	static void
+	add(counter &c, std::uint64_t value) noexcept
+	{
+		c.store(c.load(std::memory_order_relaxed) + value,
+			std::memory_order_relaxed);
+	}
+};
+
+/*
+ * Statistics of one thread, kept alive by the registry after the thread
+ * exits.
+ */
+struct tx_thread_stats {
+	using clock = std::chrono::steady_clock;
+
+	std::thread::id id = std::this_thread::get_id();
+	std::atomic<bool> alive{true};
+
+	/* guards sites, but not the counters */
+	std::mutex mutex;
+	std::map<std::string, std::unique_ptr<tx_site_counters>> sites;
+
+	/* call site of the outermost transaction started next */
+	const char *next_site = nullptr;
+
+	/* counters of the running outermost transaction */
+	tx_site_counters *current = nullptr;
+	clock::time_point begin;
+	clock::time_point commit_begin;
+
+	/* most recently used site, names are usually string literals */
+	const char *last_name = nullptr;
+	tx_site_counters *last = nullptr;
+
+	tx_site_counters *
+	site(const char *name)
+	{
+		if (last && name == last_name)
+			return last;
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		auto &s = sites[name ? name : "unknown"];
+		if (!s)
+			s.reset(new tx_site_counters());
+
+		last_name = name;
+		last = s.get();
+
+		return last;
+	}
+};
+
+/*
+ * Global list of per-thread statistics.
+ */
+class tx_stats_registry {
+public:
+	static tx_stats_registry &
+	get()
+	{
+		static tx_stats_registry registry;
+		return registry;
+	}
+
+	static tx_thread_stats &
+	local()
+	{
+		struct holder {
+			holder() : stats(std::make_shared<tx_thread_stats>())
+			{
+				get().add(stats);
+			}
+
+			~holder()
+			{
+				stats->alive = false;
+			}
+
+			std::shared_ptr<tx_thread_stats> stats;
+		};
+
+		static thread_local holder h;
+		return *h.stats;
+	}
+
+	std::vector<std::shared_ptr<tx_thread_stats>>
+	threads()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return list;
+	}
+
+	/*
+	 * Drops statistics of threads which have exited.
+	 */
+	void
+	remove_exited()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		list.erase(std::remove_if(list.begin(), list.end(),
+					  [](const std::shared_ptr<
+						  tx_thread_stats> &t) {
+						  return !t->alive;
+					  }),
+			   list.end());
+	}
+
+private:
+	void
+	add(std::shared_ptr<tx_thread_stats> stats)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		list.push_back(std::move(stats));
+	}
+
+	std::mutex mutex;
+	std::vector<std::shared_ptr<tx_thread_stats>> list;
+};
+
+/*
+ * Statistics of the calling thread while its outermost transaction is
+ * accounted, nullptr otherwise.
+ */
+inline tx_thread_stats *&
+tx_stats_active() noexcept
+{
+	static thread_local tx_thread_stats *active = nullptr;
+	return active;
+}
+
+/*
+ * Sets the call site of the outermost transaction started in this scope.
+ * Does nothing inside of a transaction.
+ */
+class tx_stats_site_scope {
+public:
+	explicit tx_stats_site_scope(const char *name)
+	{
+		if (pmemobj_tx_stage() != TX_STAGE_NONE)
+			return;
+
+		stats = &tx_stats_registry::local();
+		prev = stats->next_site;
+		stats->next_site = name;
+	}
+
+	~tx_stats_site_scope()
+	{
+		if (stats)
+			stats->next_site = prev;
+	}
+
+	tx_stats_site_scope(const tx_stats_site_scope &) = delete;
+	tx_stats_site_scope &operator=(const tx_stats_site_scope &) = delete;
+
+private:
+	tx_thread_stats *stats = nullptr;
+	const char *prev = nullptr;
+};
+
+/*
+ * Returns name of the call site of transaction::run(). Each closure has
+ * a distinct type, whose (mangled) name identifies the function in which
+ * it was defined.
+ */
+template <typename F>
+inline const char *
+tx_stats_site_name() noexcept
+{
+	return typeid(F).name();
+}
+
+/*
+ * Called when the outermost transaction has started.
+ */
+inline void
+tx_stats_on_begin() noexcept
+{
+	try {
+		auto &t = tx_stats_registry::local();
+
+		t.current = t.site(t.next_site);
+		t.begin = tx_thread_stats::clock::now();
+		t.commit_begin = t.begin;
+		tx_site_counters::add(t.current->transactions, 1);
+
+		tx_stats_active() = &t;
+	} catch (...) {
+		/* the transaction is not accounted */
+	}
+}
+
+/*
+ * Called right before pmemobj_tx_commit().
+ */
+inline void
+tx_stats_on_commit() noexcept
+{
+	auto *t = tx_stats_active();
+	if (t)
+		t->commit_begin = tx_thread_stats::clock::now();
+}
+
+/*
+ * Called from the stage callback of the outermost transaction.
+ */
+inline void
+tx_stats_on_stage(enum pobj_tx_stage stage) noexcept
+{
+	auto *t = tx_stats_active();
+	if (!t)
+		return;
+
+	auto *c = t->current;
+
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+
+	auto now = tx_thread_stats::clock::now();
+
+	if (stage == TX_STAGE_ONCOMMIT) {
+		tx_site_counters::add(c->commits, 1);
+		tx_site_counters::add(
+			c->commit_ns,
+			static_cast<std::uint64_t>(
+				duration_cast<nanoseconds>(now - t->commit_begin)
+					.count()));
+	} else if (stage == TX_STAGE_ONABORT) {
+		tx_site_counters::add(c->aborts, 1);
+	} else if (stage == TX_STAGE_FINALLY) {
+		auto d = static_cast<std::uint64_t>(
+			duration_cast<nanoseconds>(now - t->begin).count());
+		tx_site_counters::add(c->duration_ns, d);
+		if (d > c->max_duration_ns.load(std::memory_order_relaxed))
+			c->max_duration_ns.store(d, std::memory_order_relaxed);
+
+		t->current = nullptr;
+		tx_stats_active() = nullptr;
+	}
+}
+
+inline void
+tx_stats_on_snapshot(std::size_t size) noexcept
+{
+	auto *t = tx_stats_active();
+	if (!t)
+		return;
+
+	tx_site_counters::add(t->current->snapshots, 1);
+	tx_site_counters::add(t->current->snapshot_bytes, size);
+}
+
+/*
+ * Called when a snapshot was skipped, because the range was already added
+ * to the transaction.
+ */
+inline void
+tx_stats_on_redundant_snapshot() noexcept
+{
+	auto *t = tx_stats_active();
+	if (t)
+		tx_site_counters::add(t->current->redundant_snapshots, 1);
+}
+
+inline void
+tx_stats_on_alloc(std::size_t size) noexcept
+{
+	auto *t = tx_stats_active();
+	if (!t)
+		return;
+
+	tx_site_counters::add(t->current->allocations, 1);
+	tx_site_counters::add(t->current->allocation_bytes, size);
+}
+
+/*
+ * Called right before the object is freed.
+ */
+inline void
+tx_stats_on_free(PMEMoid oid) noexcept
+{
+	auto *t = tx_stats_active();
+	if (!t || OID_IS_NULL(oid))
+		return;
+
+	tx_site_counters::add(t->current->frees, 1);
+	tx_site_counters::add(t->current->free_bytes,
+			      pmemobj_alloc_usable_size(oid));
+}
+
+#else /* LIBPMEMOBJ_CPP_USE_TX_STATS */
+
+class tx_stats_site_scope {
+public:
+	explicit tx_stats_site_scope(const char *) noexcept
+	{
+	}
+};
+
+template <typename F>
+inline const char *
+tx_stats_site_name() noexcept
+{
+	return nullptr;
+}
+
+inline void
+tx_stats_on_begin() noexcept
+{
+}
+
+inline void
+tx_stats_on_commit() noexcept
+{
+}
+
+inline void
+tx_stats_on_stage(enum pobj_tx_stage) noexcept
+{
+}
+
+inline void
+tx_stats_on_snapshot(std::size_t) noexcept
+{
+}
+
+inline void
+tx_stats_on_redundant_snapshot() noexcept
+{
+}
+
+inline void
+tx_stats_on_alloc(std::size_t) noexcept
+{
+}
+
+inline void
+tx_stats_on_free(PMEMoid) noexcept
+{
+}
+
+#endif /* LIBPMEMOBJ_CPP_USE_TX_STATS */
+
+} /* namespace detail */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_TX_STATS_HPP */
@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Typed wrappers for libpmemobj's reserve/publish (action) API.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_ACTION_BATCH_HPP
+#define LIBPMEMOBJ_CPP_ACTION_BATCH_HPP
+
+#include <libpmemobj++/allocation_flag.hpp>
+#include <libpmemobj++/detail/check_persistent_ptr_array.hpp>
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/detail/life.hpp>
+#include <libpmemobj++/detail/variadic.hpp>
+#include <libpmemobj++/experimental/redo_transaction.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj/action_base.h>
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Batch of libpmemobj actions (reservations, deferred frees and 8-byte
+ * value sets) which are published atomically.
+ *
+ * reserve() allocates memory for an object and constructs it in place,
+ * but the allocation is not persistent (and the object is not reachable
+ * after a crash) until publish() is called. Values of persistent
+ * pointers and other fields set through the batch are written on
+ * publish() as well, so new objects can be allocated and linked into an
+ * existing structure with a single redo log commit, without an undo-log
+ * transaction.
+ *
+ * Memory of reserved objects is flushed by publish(), so the objects may
+ * also be modified directly (e.g. through persistent_ptr) until then.
+ *
+ * If publish() is called inside of a transaction, the actions are
+ * published with pmemobj_tx_publish() and become a part of that
+ * transaction. If the batch is destroyed (or cancel() is called) before
+ * publish(), reservations are released and all other actions are
+ * discarded. Destructors of reserved objects are not called in that
+ * case.
+ *
+ * Object constructors run outside of a transaction (unless reserve() is
+ * called in one), hence they must not require one.
+ *
+ * This class is not thread safe.
+ */
+class action_batch {
+public:
+	/**
+	 * Creates an empty batch for the pool.
+	 *
+	 * @param[in] pop pool in which objects are reserved and modified.
+	 */
+	explicit action_batch(obj::pool_base &pop) noexcept
+	    : pop(pop.handle()), values(pop)
+	{
+	}
+
+	/**
+	 * Deleted copy constructor.
+	 */
+	action_batch(const action_batch &) = delete;
+
+	/**
+	 * Deleted assignment operator.
+	 */
+	action_batch &operator=(const action_batch &) = delete;
+
+	/**
+	 * Destructor. Cancels all actions which were not published.
+	 */
+	~action_batch()
+	{
+		cancel();
+	}
+
+	/**
+	 * Reserves memory for an object and constructs it in place.
+	 *
+	 * @param[in] flag affects behaviour of allocator.
+	 * @param[in] args arguments passed to the object's constructor.
+	 *
+	 * @return pointer to the reserved object.
+	 *
+	 * @throw std::bad_alloc on reservation failure.
+	 * @throw rethrow exception from T constructor. The memory is
+	 * released in that case.
+	 */
+	template <typename T, typename... Args>
+	typename detail::pp_if_not_array<T>::type
+	reserve(allocation_flag_atomic flag, Args &&... args)
+	{
+		heap_actions.emplace_back();
+		auto &act = heap_actions.back();
+
+		persistent_ptr<T> ptr = pmemobj_xreserve(
+			pop, &act, sizeof(T), detail::type_num<T>(),
+			flag.value);
+
+		if (ptr == nullptr) {
+			heap_actions.pop_back();
+			throw std::bad_alloc();
+		}
+
+		try {
+			detail::create<T, Args...>(ptr.get(),
+						   std::forward<Args>(args)...);
+		} catch (...) {
+			pmemobj_cancel(pop, &heap_actions.back(), 1);
+			heap_actions.pop_back();
+			throw;
+		}
+
+		reserved.emplace_back(ptr.get(), sizeof(T));
+
+		return ptr;
+	}
+
+	/**
+	 * Reserves memory for an object and constructs it in place.
+	 *
+	 * @param[in] args arguments passed to the object's constructor.
+	 *
+	 * @return pointer to the reserved object.
+	 *
+	 * @throw std::bad_alloc on reservation failure.
+	 * @throw rethrow exception from T constructor. The memory is
+	 * released in that case.
+	 */
+	template <typename T, typename... Args>
+	typename std::enable_if<
+		!detail::is_first_arg_same<allocation_flag_atomic,
+					   Args...>::value,
+		typename detail::pp_if_not_array<T>::type>::type
+	reserve(Args &&... args)
+	{
+		return reserve<T>(allocation_flag_atomic::none(),
+				  std::forward<Args>(args)...);
+	}
+
+	/**
+	 * Sets new value of the object on publish().
+	 *
+	 * Objects which are not 8-byte words are merged with the current
+	 * content of the words they overlap (see redo_transaction).
+	 *
+	 * @param[in] ptr pointer to the object, which must reside in the
+	 * pool.
+	 * @param[in] value new value of the object.
+	 *
+	 * @throw pmem::pool_invalid_argument if ptr is not in the pool.
+	 */
+	template <typename T>
+	void
+	set(T *ptr, const T &value)
+	{
+		values.set(ptr, value);
+	}
+
+	/**
+	 * Sets new value of the persistent property on publish().
+	 *
+	 * @param[in] field property, which must reside in the pool.
+	 * @param[in] value new value of the property.
+	 *
+	 * @throw pmem::pool_invalid_argument if field is not in the pool.
+	 */
+	template <typename T>
+	void
+	set(obj::p<T> &field, const T &value)
+	{
+		values.set(field, value);
+	}
+
+	/**
+	 * Sets new value of the persistent pointer on publish().
+	 *
+	 * @param[in] ptr persistent pointer, which must reside in the pool.
+	 * @param[in] value new value of the pointer, e.g. one returned by
+	 * reserve().
+	 *
+	 * @throw pmem::pool_invalid_argument if ptr is not in the pool.
+	 */
+	template <typename T>
+	void
+	set(persistent_ptr<T> &ptr, const persistent_ptr<T> &value)
+	{
+		values.set(ptr.raw_ptr(), value.raw());
+	}
+
+	/**
+	 * Frees the object on publish(). Its destructor is not called.
+	 *
+	 * @param[in] ptr pointer to the object.
+	 */
+	template <typename T>
+	void
+	defer_free(const persistent_ptr<T> &ptr)
+	{
+		if (ptr == nullptr)
+			return;
+
+		heap_actions.emplace_back();
+		pmemobj_defer_free(pop, ptr.raw(), &heap_actions.back());
+	}
+
+	/**
+	 * Flushes reserved objects and atomically publishes all actions.
+	 * The batch is empty afterwards and can be reused.
+	 *
+	 * @throw pmem::transaction_error if publishing failed. Actions are
+	 * kept in that case.
+	 */
+	void
+	publish()
+	{
+		if (empty())
+			return;
+
+		for (auto &r : reserved)
+			pmemobj_flush(pop, r.first, r.second);
+		pmemobj_drain(pop);
+
+		std::vector<pobj_action> actions(heap_actions);
+		values.append_actions(actions);
+		redo_transaction::publish(pop, actions);
+
+		clear();
+	}
+
+	/**
+	 * Releases all reservations and discards all other actions.
+	 */
+	void
+	cancel() noexcept
+	{
+		if (!heap_actions.empty())
+			pmemobj_cancel(pop, heap_actions.data(),
+				       heap_actions.size());
+
+		clear();
+	}
+
+	/**
+	 * @return number of actions in the batch.
+	 */
+	std::size_t
+	size() const noexcept
+	{
+		return heap_actions.size() + values.size();
+	}
+
+	/**
+	 * @return true if there are no actions in the batch.
+	 */
+	bool
+	empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+private:
+	void
+	clear() noexcept
+	{
+		heap_actions.clear();
+		reserved.clear();
+		values.abort();
+	}
+
+	PMEMobjpool *pop;
+
+	/* reservations and deferred frees */
+	std::vector<pobj_action> heap_actions;
+
+	/* reserved objects, flushed on publish */
+	std::vector<std::pair<void *, std::size_t>> reserved;
+
+	/* value sets */
+	redo_transaction values;
+};
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_ACTION_BATCH_HPP */
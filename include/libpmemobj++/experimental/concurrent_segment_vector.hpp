@@ -0,0 +1,1082 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * A persistent version of segment vector which can be grown concurrently.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_CONCURRENT_SEGMENT_VECTOR_HPP
+#define LIBPMEMOBJ_CPP_CONCURRENT_SEGMENT_VECTOR_HPP
+
+#include <libpmemobj++/container/segment_vector.hpp>
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+#include <libpmemobj/atomic_base.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * A persistent version of segment vector which supports concurrent growth.
+ *
+ * grow_by(), grow_to_at_least(), push_back() and emplace_back() may be
+ * called concurrently with each other and with read access to elements
+ * which were already added. Elements are stored in segments of
+ * exponentially growing size, which are never relocated, so references and
+ * iterators to elements are not invalidated by growth.
+ *
+ * There is no lock shared by appending threads:
+ * - indexes of new elements are reserved by an atomic increment of
+ *   a counter,
+ * - missing segments are allocated lazily by the first thread which needs
+ *   them, which claims the segment with a compare-and-swap; the allocation
+ *   itself is fail-safe (pmemobj_alloc),
+ * - every thread constructs its elements in a transaction of its own.
+ *   Transactions of different threads never modify the same memory.
+ *
+ * size() returns the number of elements which were constructed and whose
+ * transactions committed. Ranges of elements are published in order of
+ * their indexes, so a thread which finished constructing its elements
+ * waits for threads constructing elements with lower indexes before
+ * growth returns.
+ *
+ * If the constructor of an element throws, the reserved indexes are given
+ * back if no other thread reserved indexes after them. Otherwise, they are
+ * filled with value-initialized elements. std::terminate() is called if
+ * that is not possible: if the type is not default constructible or if the
+ * value-initialization throws.
+ *
+ * After a crash, elements which were constructed but not published are not
+ * destroyed. runtime_initialize() must be called after the pool is opened.
+ *
+ * All other modifiers (clear(), free_data()) are not thread safe.
+ */
+template <typename T>
+class concurrent_segment_vector {
+public:
+	/* traits */
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = value_type &;
+	using const_reference = const value_type &;
+	using pointer = value_type *;
+	using const_pointer = const value_type *;
+	using iterator = segment_vector_internal::segment_iterator<
+		concurrent_segment_vector, false>;
+	using const_iterator = segment_vector_internal::segment_iterator<
+		concurrent_segment_vector, true>;
+
+	/* ctors & dtor */
+	concurrent_segment_vector();
+	~concurrent_segment_vector();
+
+	/* initialization */
+	void runtime_initialize();
+
+	/* concurrent growth */
+	iterator grow_by(size_type count);
+	iterator grow_by(size_type count, const value_type &value);
+	iterator grow_to_at_least(size_type count);
+	iterator grow_to_at_least(size_type count, const value_type &value);
+	iterator push_back(const value_type &value);
+	iterator push_back(value_type &&value);
+	template <typename... Args>
+	iterator emplace_back(Args &&... args);
+	void reserve(size_type capacity_new);
+
+	/* access */
+	reference at(size_type n);
+	const_reference at(size_type n) const;
+	const_reference const_at(size_type n) const;
+	reference operator[](size_type n);
+	const_reference operator[](size_type n) const;
+
+	/* size */
+	bool empty() const;
+	size_type size() const;
+	size_type max_size() const noexcept;
+
+	/* iterators */
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	/* modifiers */
+	void clear();
+	void free_data();
+
+private:
+	/* size of the first segment is 2^first_segment_log */
+	static constexpr size_type first_segment_log = 4;
+	static constexpr size_type max_segments = 48;
+
+	/* values of segment::state other than offsets */
+	static constexpr std::uint64_t segment_empty = 0;
+	static constexpr std::uint64_t segment_allocating = 1;
+
+	struct segment {
+		/* destination of the fail-safe allocation */
+		PMEMoid oid;
+		/*
+		 * Offset of the segment data from the container, which is
+		 * read by other threads, or one of segment_empty and
+		 * segment_allocating. Restored from oid by
+		 * runtime_initialize().
+		 */
+		obj::p<std::atomic<std::uint64_t>> state;
+	};
+
+	/* private helper methods */
+	static size_type segment_of(size_type idx) noexcept;
+	static size_type segment_base(size_type seg) noexcept;
+	static size_type segment_size(size_type seg) noexcept;
+	obj::pool_base get_pool() const noexcept;
+	pointer get(size_type n) const noexcept;
+	void allocate_segment(size_type seg);
+	void allocate_segments(size_type first, size_type last);
+	size_type reserve_range(size_type count);
+	template <typename Construct>
+	void construct_range(size_type first, size_type last,
+			     Construct &&construct);
+	template <typename Construct>
+	void internal_grow(size_type first, size_type last,
+			   Construct &&construct);
+	void value_initialize(size_type first, size_type last,
+			      std::true_type) noexcept;
+	void value_initialize(size_type first, size_type last,
+			      std::false_type) noexcept;
+	void wait_for_size(size_type count) const;
+	bool wait_for_reserved_size(size_type count) const;
+	void set_cached_size(size_type s);
+	size_type get_cached_size() const;
+	void check_tx_stage_none() const;
+
+	/* number of published elements */
+	obj::p<std::atomic<size_type>> _storage_size;
+	/* number of reserved indexes, restored by runtime_initialize() */
+	obj::p<std::atomic<size_type>> _reserved;
+
+	segment _segments[max_segments];
+};
+
+/**
+ * Constructor.
+ */
+template <typename T>
+concurrent_segment_vector<T>::concurrent_segment_vector()
+{
+	_storage_size.get_rw() = 0;
+	_reserved.get_rw() = 0;
+
+	for (auto &s : _segments) {
+		s.oid = OID_NULL;
+		s.state.get_rw() = segment_empty;
+	}
+}
+
+/**
+ * Destructor. Destroys all elements and frees all segments.
+ */
+template <typename T>
+concurrent_segment_vector<T>::~concurrent_segment_vector()
+{
+	try {
+		free_data();
+	} catch (...) {
+		std::terminate();
+	}
+}
+
+/**
+ * Restores the volatile state of the container after the pool is opened:
+ * addresses of segments and the counter of reserved indexes. Elements which
+ * were constructed, but not published before a crash, are dropped.
+ *
+ * @pre must be called before any other method, outside of a transaction.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::runtime_initialize()
+{
+	check_tx_stage_none();
+
+	auto base = reinterpret_cast<std::uintptr_t>(this);
+	for (auto &s : _segments) {
+		std::uint64_t state = segment_empty;
+		if (!OID_IS_NULL(s.oid))
+			state = reinterpret_cast<std::uintptr_t>(
+					pmemobj_direct(s.oid)) -
+				base;
+
+		s.state.get_rw().store(state, std::memory_order_relaxed);
+	}
+
+	_reserved.get_rw().store(get_cached_size(), std::memory_order_release);
+}
+
+/**
+ * Appends count default constructed elements. Thread safe.
+ *
+ * @param[in] count number of elements to append.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @return iterator to the first appended element.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::grow_by(size_type count)
+{
+	check_tx_stage_none();
+
+	auto first = reserve_range(count);
+	internal_grow(first, first + count,
+		      [&](pointer p) { new (p) value_type(); });
+
+	return iterator(this, first);
+}
+
+/**
+ * Appends count copies of value. Thread safe.
+ *
+ * @param[in] count number of elements to append.
+ * @param[in] value value of all appended elements.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @return iterator to the first appended element.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::grow_by(size_type count, const value_type &value)
+{
+	check_tx_stage_none();
+
+	auto first = reserve_range(count);
+	internal_grow(first, first + count,
+		      [&](pointer p) { new (p) value_type(value); });
+
+	return iterator(this, first);
+}
+
+/**
+ * Appends default constructed elements until size() is at least count.
+ * Thread safe.
+ *
+ * If other threads are appending elements up to position count, waits
+ * until they finish. If they fail and give their elements back, appends
+ * the elements itself.
+ *
+ * @param[in] count minimal size of the container.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @post size() >= count
+ *
+ * @return iterator to the first appended element or to the element at
+ * position count, if no elements were appended.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::grow_to_at_least(size_type count)
+{
+	check_tx_stage_none();
+
+	if (count > max_size())
+		throw std::length_error("New size exceeds max size.");
+
+	do {
+		auto first = _reserved.get_ro().load(std::memory_order_acquire);
+		while (first < count) {
+			if (_reserved.get_rw().compare_exchange_weak(first,
+								     count)) {
+				internal_grow(first, count, [&](pointer p) {
+					new (p) value_type();
+				});
+
+				return iterator(this, first);
+			}
+		}
+	} while (!wait_for_reserved_size(count));
+
+	return iterator(this, count);
+}
+
+/**
+ * Appends copies of value until size() is at least count. Thread safe.
+ *
+ * If other threads are appending elements up to position count, waits
+ * until they finish. If they fail and give their elements back, appends
+ * the elements itself.
+ *
+ * @param[in] count minimal size of the container.
+ * @param[in] value value of all appended elements.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @post size() >= count
+ *
+ * @return iterator to the first appended element or to the element at
+ * position count, if no elements were appended.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::grow_to_at_least(size_type count,
+					       const value_type &value)
+{
+	check_tx_stage_none();
+
+	if (count > max_size())
+		throw std::length_error("New size exceeds max size.");
+
+	do {
+		auto first = _reserved.get_ro().load(std::memory_order_acquire);
+		while (first < count) {
+			if (_reserved.get_rw().compare_exchange_weak(first,
+								     count)) {
+				internal_grow(first, count, [&](pointer p) {
+					new (p) value_type(value);
+				});
+
+				return iterator(this, first);
+			}
+		}
+	} while (!wait_for_reserved_size(count));
+
+	return iterator(this, count);
+}
+
+/**
+ * Appends a copy of value. Thread safe.
+ *
+ * @param[in] value the value of the element to be appended.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @return iterator to the appended element.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::push_back(const value_type &value)
+{
+	return emplace_back(value);
+}
+
+/**
+ * Appends value using move semantics. Thread safe.
+ *
+ * @param[in] value the value of the element to be appended.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @return iterator to the appended element.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::push_back(value_type &&value)
+{
+	return emplace_back(std::move(value));
+}
+
+/**
+ * Appends an element constructed in-place from args. Thread safe.
+ *
+ * @param[in] args arguments to forward to the constructor of the element.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @return iterator to the appended element.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if the new size would exceed max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ * @throw rethrows constructor exception.
+ */
+template <typename T>
+template <typename... Args>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::emplace_back(Args &&... args)
+{
+	check_tx_stage_none();
+
+	auto first = reserve_range(1);
+	internal_grow(first, first + 1, [&](pointer p) {
+		new (p) value_type(std::forward<Args>(args)...);
+	});
+
+	return iterator(this, first);
+}
+
+/**
+ * Allocates segments for at least capacity_new elements, so that growth
+ * up to this size does not have to allocate memory. Thread safe.
+ *
+ * @param[in] capacity_new new capacity.
+ *
+ * @pre must be called outside of a transaction.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ * @throw std::length_error if capacity_new > max_size().
+ * @throw std::bad_alloc when allocating a segment failed.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::reserve(size_type capacity_new)
+{
+	check_tx_stage_none();
+
+	if (capacity_new > max_size())
+		throw std::length_error("New capacity exceeds max size.");
+
+	allocate_segments(0, capacity_new);
+}
+
+/**
+ * Access element at specific index with bounds checking and add it to a
+ * transaction.
+ *
+ * @param[in] n index number.
+ *
+ * @return reference to element number n.
+ *
+ * @throw std::out_of_range if n is not within the range of the container.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::reference
+concurrent_segment_vector<T>::at(size_type n)
+{
+	if (n >= size())
+		throw std::out_of_range("concurrent_segment_vector::at");
+
+	return (*this)[n];
+}
+
+/**
+ * Access element at specific index with bounds checking.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n.
+ *
+ * @throw std::out_of_range if n is not within the range of the container.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_reference
+concurrent_segment_vector<T>::at(size_type n) const
+{
+	if (n >= size())
+		throw std::out_of_range("concurrent_segment_vector::at");
+
+	return (*this)[n];
+}
+
+/**
+ * Access element at specific index with bounds checking. In contradiction to
+ * at(), const_at() will return const_reference not depending on the
+ * const-qualification of the object it is called on.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n.
+ *
+ * @throw std::out_of_range if n is not within the range of the container.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_reference
+concurrent_segment_vector<T>::const_at(size_type n) const
+{
+	return at(n);
+}
+
+/**
+ * Access element at specific index and add it to a transaction. No bounds
+ * checking is performed.
+ *
+ * @param[in] n index number.
+ *
+ * @return reference to element number n.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::reference
+	concurrent_segment_vector<T>::operator[](size_type n)
+{
+	reference element = *get(n);
+
+	detail::conditional_add_to_tx(&element, 1,
+				      POBJ_XADD_ASSUME_INITIALIZED);
+
+	return element;
+}
+
+/**
+ * Access element at specific index. No bounds checking is performed.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_reference
+	concurrent_segment_vector<T>::operator[](
+		size_type n) const
+{
+	return *get(n);
+}
+
+/**
+ * Returns true if there is no element in the container.
+ */
+template <typename T>
+bool
+concurrent_segment_vector<T>::empty() const
+{
+	return size() == 0;
+}
+
+/**
+ * Returns number of elements which were appended by already finished
+ * growth operations. Thread safe.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::size() const
+{
+	return get_cached_size();
+}
+
+/**
+ * @return maximum number of elements the container is able to hold.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::max_size() const noexcept
+{
+	return segment_base(max_segments);
+}
+
+/**
+ * Returns an iterator to the beginning.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::begin()
+{
+	return iterator(this, 0);
+}
+
+/**
+ * Returns an iterator to the end, as observed at the time of the call.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::iterator
+concurrent_segment_vector<T>::end()
+{
+	return iterator(this, size());
+}
+
+/**
+ * Returns a const iterator to the beginning.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_iterator
+concurrent_segment_vector<T>::begin() const
+{
+	return const_iterator(this, 0);
+}
+
+/**
+ * Returns a const iterator to the end, as observed at the time of the call.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_iterator
+concurrent_segment_vector<T>::end() const
+{
+	return const_iterator(this, size());
+}
+
+/**
+ * Returns a const iterator to the beginning.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_iterator
+concurrent_segment_vector<T>::cbegin() const
+{
+	return begin();
+}
+
+/**
+ * Returns a const iterator to the end, as observed at the time of the call.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::const_iterator
+concurrent_segment_vector<T>::cend() const
+{
+	return end();
+}
+
+/**
+ * Removes all elements from the container. Segments are not freed.
+ * Not thread safe.
+ *
+ * @pre must be called outside of growth operations.
+ *
+ * @post empty() == true.
+ *
+ * @throw pmem::transaction_error when the transaction failed.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::clear()
+{
+	auto pop = get_pool();
+
+	obj::flat_transaction::run(pop, [&] {
+		auto size = get_cached_size();
+		for (size_type i = 0; i < size; ++i)
+			detail::destroy<value_type>(*get(i));
+
+		_storage_size.get_rw() = 0;
+		_reserved.get_rw() = 0;
+	});
+}
+
+/**
+ * Removes all elements from the container and frees all allocated segments.
+ * Not thread safe.
+ *
+ * @post empty() == true.
+ *
+ * @throw pmem::transaction_free_error when freeing a segment failed.
+ * @throw pmem::transaction_error when the transaction failed.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::free_data()
+{
+	auto pop = get_pool();
+
+	obj::flat_transaction::run(pop, [&] {
+		clear();
+
+		for (auto &s : _segments) {
+			if (OID_IS_NULL(s.oid))
+				continue;
+
+			if (pmemobj_tx_free(s.oid) != 0)
+				throw pmem::transaction_free_error(
+					"failed to delete persistent memory object")
+					.with_pmemobj_errormsg();
+
+			detail::conditional_add_to_tx(&s.oid);
+			s.oid = OID_NULL;
+			s.state.get_rw() = segment_empty;
+		}
+	});
+}
+
+/**
+ * Private helper function.
+ *
+ * @return index of the segment which holds element number idx.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::segment_of(size_type idx) noexcept
+{
+	if (idx < (size_type(1) << first_segment_log))
+		return 0;
+
+	return static_cast<size_type>(detail::Log2(idx)) - first_segment_log +
+		1;
+}
+
+/**
+ * Private helper function.
+ *
+ * @return index of the first element of the segment.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::segment_base(size_type seg) noexcept
+{
+	if (seg == 0)
+		return 0;
+
+	return size_type(1) << (first_segment_log + seg - 1);
+}
+
+/**
+ * Private helper function.
+ *
+ * @return number of elements in the segment.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::segment_size(size_type seg) noexcept
+{
+	if (seg == 0)
+		return size_type(1) << first_segment_log;
+
+	return segment_base(seg);
+}
+
+/**
+ * Private helper function.
+ *
+ * @pre segment of the element must be allocated.
+ *
+ * @return pointer to element number n.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::pointer
+concurrent_segment_vector<T>::get(size_type n) const noexcept
+{
+	auto seg = segment_of(n);
+	auto state = _segments[seg].state.get_ro().load(
+		std::memory_order_acquire);
+
+	assert(state != segment_empty && state != segment_allocating);
+
+	auto data = reinterpret_cast<pointer>(
+		reinterpret_cast<std::uintptr_t>(this) + state);
+
+	return data + (n - segment_base(seg));
+}
+
+/**
+ * Private helper function. Allocates the segment, unless it is already
+ * allocated. If another thread is allocating it, waits until it is done.
+ *
+ * @throw std::bad_alloc when allocating the segment failed.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::allocate_segment(size_type seg)
+{
+	auto &s = _segments[seg];
+	auto &state = s.state.get_rw();
+
+	auto current = state.load(std::memory_order_acquire);
+	while (current == segment_empty || current == segment_allocating) {
+		if (current == segment_allocating) {
+			std::this_thread::yield();
+			current = state.load(std::memory_order_acquire);
+			continue;
+		}
+
+		if (!state.compare_exchange_weak(current, segment_allocating,
+						 std::memory_order_acq_rel))
+			continue;
+
+		auto pop = get_pool();
+		auto size = segment_size(seg) * sizeof(value_type);
+		if (pmemobj_alloc(pop.handle(), &s.oid, size,
+				  detail::type_num<value_type>(), nullptr,
+				  nullptr) != 0) {
+			state.store(segment_empty, std::memory_order_release);
+			throw std::bad_alloc();
+		}
+
+		current = reinterpret_cast<std::uintptr_t>(
+				  pmemobj_direct(s.oid)) -
+			reinterpret_cast<std::uintptr_t>(this);
+		state.store(current, std::memory_order_release);
+	}
+}
+
+/**
+ * Private helper function. Allocates all segments which hold elements from
+ * the range [first, last).
+ *
+ * @throw std::bad_alloc when allocating a segment failed.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::allocate_segments(size_type first,
+						size_type last)
+{
+	if (first == last)
+		return;
+
+	for (auto seg = segment_of(first); seg <= segment_of(last - 1); ++seg)
+		allocate_segment(seg);
+}
+
+/**
+ * Private helper function. Reserves count indexes after all indexes reserved
+ * so far.
+ *
+ * @return the first reserved index.
+ *
+ * @throw std::length_error if the new size would exceed max_size().
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::reserve_range(size_type count)
+{
+	auto &reserved = _reserved.get_rw();
+
+	auto first = reserved.load(std::memory_order_acquire);
+	do {
+		if (count > max_size() - first)
+			throw std::length_error("New size exceeds max size.");
+	} while (!reserved.compare_exchange_weak(first, first + count));
+
+	return first;
+}
+
+/**
+ * Private helper function. Constructs elements from the range [first, last)
+ * in a transaction. The range is reserved by the calling thread, so
+ * transactions of other threads do not modify it.
+ *
+ * @param[in] construct functor which constructs an element at the given
+ * address.
+ */
+template <typename T>
+template <typename Construct>
+void
+concurrent_segment_vector<T>::construct_range(size_type first, size_type last,
+					      Construct &&construct)
+{
+	allocate_segments(first, last);
+
+	auto pop = get_pool();
+	obj::flat_transaction::run(pop, [&] {
+		/* memory past the published size holds no live elements */
+		for (auto i = first; i < last;) {
+			auto seg = segment_of(i);
+			auto seg_last = (std::min)(
+				last, segment_base(seg) + segment_size(seg));
+
+			detail::conditional_add_to_tx(get(i), seg_last - i,
+						      POBJ_XADD_NO_SNAPSHOT);
+			i = seg_last;
+		}
+
+		for (auto i = first; i < last; ++i)
+			construct(get(i));
+	});
+}
+
+/**
+ * Private helper function. Constructs elements from the range [first, last),
+ * reserved by the calling thread, and publishes them after all elements
+ * before them are published.
+ *
+ * If the construction fails, the range is given back, or, if other threads
+ * reserved elements after it, it is value-initialized and published.
+ *
+ * @param[in] construct functor which constructs an element at the given
+ * address.
+ */
+template <typename T>
+template <typename Construct>
+void
+concurrent_segment_vector<T>::internal_grow(size_type first, size_type last,
+					    Construct &&construct)
+{
+	try {
+		construct_range(first, last, construct);
+	} catch (...) {
+		auto reserved = last;
+		if (!_reserved.get_rw().compare_exchange_strong(reserved,
+								first)) {
+			value_initialize(
+				first, last,
+				std::is_default_constructible<value_type>{});
+
+			wait_for_size(first);
+			set_cached_size(last);
+		}
+
+		throw;
+	}
+
+	wait_for_size(first);
+	set_cached_size(last);
+}
+
+/**
+ * Private helper function. Fills a range, whose construction failed, with
+ * value-initialized elements.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::value_initialize(size_type first,
+					       size_type last,
+					       std::true_type) noexcept
+{
+	construct_range(first, last, [](pointer p) { new (p) value_type(); });
+}
+
+/**
+ * Private helper function. A range whose construction failed cannot be
+ * filled with elements of a type which is not default constructible.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::value_initialize(size_type, size_type,
+					       std::false_type) noexcept
+{
+	std::terminate();
+}
+
+/**
+ * Private helper function. Waits until size() is at least count.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::wait_for_size(size_type count) const
+{
+	while (get_cached_size() < count)
+		std::this_thread::yield();
+}
+
+/**
+ * Private helper function. Waits until size() is at least count, as long as
+ * indexes up to count stay reserved.
+ *
+ * @return true if size() is at least count, false if a thread which reserved
+ * indexes before count failed to construct its elements and gave them back.
+ */
+template <typename T>
+bool
+concurrent_segment_vector<T>::wait_for_reserved_size(size_type count) const
+{
+	while (get_cached_size() < count) {
+		if (_reserved.get_ro().load(std::memory_order_acquire) < count)
+			return false;
+
+		std::this_thread::yield();
+	}
+
+	return true;
+}
+
+/**
+ * Private helper function. Checks if there is no active transaction.
+ *
+ * @throw pmem::transaction_scope_error if called inside of a transaction.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::check_tx_stage_none() const
+{
+	if (pmemobj_tx_stage() != TX_STAGE_NONE)
+		throw pmem::transaction_scope_error(
+			"Function called inside transaction scope.");
+}
+
+/**
+ * Set cached storage size, persist it and make valgrind annotations.
+ */
+template <typename T>
+void
+concurrent_segment_vector<T>::set_cached_size(size_type s)
+{
+	auto pop = get_pool();
+
+	/* Helgrind does not understand std::atomic */
+#if LIBPMEMOBJ_CPP_VG_HELGRIND_ENABLED
+	VALGRIND_HG_DISABLE_CHECKING(&_storage_size, sizeof(_storage_size));
+#endif
+
+#if LIBPMEMOBJ_CPP_VG_HELGRIND_ENABLED || LIBPMEMOBJ_CPP_VG_DRD_ENABLED
+	ANNOTATE_HAPPENS_BEFORE(&_storage_size);
+#endif
+
+	_storage_size.get_rw().store(s, std::memory_order_release);
+	pop.persist(_storage_size);
+}
+
+/**
+ * Get cached storage size and make valgrind annotations.
+ */
+template <typename T>
+typename concurrent_segment_vector<T>::size_type
+concurrent_segment_vector<T>::get_cached_size() const
+{
+	auto s = _storage_size.get_ro().load(std::memory_order_acquire);
+
+#if LIBPMEMOBJ_CPP_VG_HELGRIND_ENABLED || LIBPMEMOBJ_CPP_VG_DRD_ENABLED
+	ANNOTATE_HAPPENS_AFTER(&_storage_size);
+#endif
+
+	return s;
+}
+
+/**
+ * Private helper function.
+ *
+ * @return pool_base object where the container resides.
+ */
+template <typename T>
+obj::pool_base
+concurrent_segment_vector<T>::get_pool() const noexcept
+{
+	auto pop = pmemobj_pool_by_ptr(this);
+	assert(pop != nullptr);
+	return obj::pool_base(pop);
+}
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_CONCURRENT_SEGMENT_VECTOR_HPP */
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Group commit of small, independent transactions.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_GROUP_COMMIT_HPP
+#define LIBPMEMOBJ_CPP_GROUP_COMMIT_HPP
+
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Executes small, independent updates submitted by many threads in shared
+ * transactions.
+ *
+ * Each transaction::run() pays for its own begin, commit and the fences
+ * which persist its undo log. group_commit instead queues submitted
+ * functions and a dedicated committer thread executes a batch of them
+ * (up to max_batch) inside of a single flat_transaction. Futures returned
+ * by submit() become ready only after the batch is committed, so the fence
+ * cost is amortized across all updates in the batch.
+ *
+ * A batch is formed from functions which were queued while the previous
+ * one was being committed. If max_delay is non-zero, the committer
+ * additionally waits up to max_delay for a batch to fill, which bounds
+ * the latency added to each update.
+ *
+ * If any function in a batch throws (or aborts the transaction), the whole
+ * batch is rolled back and its functions are executed again, each in its
+ * own transaction, so that only the failing ones report an exception
+ * through their futures. Functions must therefore be safe to execute more
+ * than once, i.e. they must not have side effects outside of the pool.
+ *
+ * All functions are executed by the committer thread, one after another.
+ * Data they modify must not be accessed concurrently by other threads
+ * without synchronization. Functions must not wait for futures of other
+ * updates.
+ *
+ * group_commit is a volatile object. The destructor executes all updates
+ * which are still queued.
+ */
+class group_commit {
+public:
+	/**
+	 * Starts the committer thread.
+	 *
+	 * @param[in] pop pool in which the transactions are run.
+	 * @param[in] max_batch maximum number of updates executed in one
+	 * transaction.
+	 * @param[in] max_delay maximum time for which the committer waits
+	 * for a batch to fill.
+	 *
+	 * @throw std::system_error if the thread could not be started.
+	 */
+	explicit group_commit(obj::pool_base &pop, std::size_t max_batch = 64,
+			      std::chrono::microseconds max_delay =
+				      std::chrono::microseconds::zero())
+	    : pop(pop),
+	      max_batch((std::max)(max_batch, std::size_t(1))),
+	      max_delay(max_delay)
+	{
+		committer = std::thread([this] { loop(); });
+	}
+
+	/**
+	 * Deleted copy constructor.
+	 */
+	group_commit(const group_commit &) = delete;
+
+	/**
+	 * Deleted assignment operator.
+	 */
+	group_commit &operator=(const group_commit &) = delete;
+
+	/**
+	 * Destructor. Executes all queued updates and stops the committer
+	 * thread.
+	 */
+	~group_commit()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		cv.notify_all();
+		committer.join();
+	}
+
+	/**
+	 * Queues the function for execution in a transaction.
+	 *
+	 * @param[in] f function to execute, called without arguments.
+	 *
+	 * @return future which becomes ready once the transaction in which
+	 * f was executed is committed. If f throws (or the transaction fails)
+	 * the future holds the exception.
+	 */
+	template <typename F>
+	std::future<void>
+	submit(F &&f)
+	{
+		request r{std::function<void()>(std::forward<F>(f)),
+			  std::promise<void>()};
+		auto ret = r.promise.get_future();
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			queue.emplace_back(std::move(r));
+		}
+
+		cv.notify_one();
+
+		return ret;
+	}
+
+private:
+	struct request {
+		std::function<void()> f;
+		std::promise<void> promise;
+	};
+
+	void
+	loop()
+	{
+		std::vector<request> batch;
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			cv.wait(lock,
+				[&] { return stopping || !queue.empty(); });
+
+			if (queue.empty())
+				return;
+
+			if (max_delay.count() != 0)
+				cv.wait_for(lock, max_delay, [&] {
+					return stopping ||
+						queue.size() >= max_batch;
+				});
+
+			while (!queue.empty() && batch.size() < max_batch) {
+				batch.emplace_back(std::move(queue.front()));
+				queue.pop_front();
+			}
+
+			lock.unlock();
+			execute(batch);
+			batch.clear();
+			lock.lock();
+		}
+	}
+
+	/*
+	 * Executes all requests in one transaction. If that fails, executes
+	 * each of them in a separate transaction.
+	 */
+	void
+	execute(std::vector<request> &batch) noexcept
+	{
+		if (batch.size() > 1) {
+			try {
+				obj::flat_transaction::run(pop, [&] {
+					for (auto &r : batch)
+						r.f();
+				});
+
+				for (auto &r : batch)
+					r.promise.set_value();
+
+				return;
+			} catch (...) {
+			}
+		}
+
+		for (auto &r : batch) {
+			try {
+				obj::flat_transaction::run(pop, r.f);
+				r.promise.set_value();
+			} catch (...) {
+				r.promise.set_exception(
+					std::current_exception());
+			}
+		}
+	}
+
+	obj::pool_base pop;
+	const std::size_t max_batch;
+	const std::chrono::microseconds max_delay;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<request> queue;
+	bool stopping = false;
+
+	std::thread committer;
+};
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_GROUP_COMMIT_HPP */
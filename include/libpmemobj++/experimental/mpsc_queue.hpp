@@ -9,6 +9,7 @@
 #ifndef LIBPMEMOBJ_MPSC_QUEUE_HPP
 #define LIBPMEMOBJ_MPSC_QUEUE_HPP
 
+#include <libpmemobj++/container/vector.hpp>
 #include <libpmemobj++/detail/common.hpp>
 #include <libpmemobj++/detail/enumerable_thread_specific.hpp>
 #include <libpmemobj++/detail/ringbuf.hpp>
@@ -17,11 +18,14 @@
 #include <libpmemobj++/string_view.hpp>
 #include <libpmemobj++/transaction.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace pmem
 {
@@ -45,15 +49,24 @@ namespace experimental
  * previous run of application. If try_consume_batch() is not called, produce
  * may fail, even if the queue is empty.
  *
+ * If pmem_segments_type object and max_segments greater than 0 are passed to
+ * the constructor, producers do not fail when the log is full. Instead,
+ * additional log segments are allocated from the pool and stored in the
+ * pmem_segments_type object. Segments are freed once the consumer catches up
+ * with the producers.
+ *
  * @snippet mpsc_queue/mpsc_queue.cpp mpsc_queue_single_threaded_example
  */
 class mpsc_queue {
 public:
 	class worker;
 	class pmem_log_type;
+	class pmem_segments_type;
 	class batch_type;
 
 	mpsc_queue(pmem_log_type &pmem, size_t max_workers = 1);
+	mpsc_queue(pmem_log_type &pmem, size_t max_workers,
+		   pmem_segments_type &segments, size_t max_segments);
 
 	worker register_worker();
 
@@ -88,8 +101,38 @@ private:
 		char *end;
 	};
 
+	/* Volatile description of an overflow log segment. Segments are
+	 * filled sequentially, end is the offset of the first unused byte. */
+	struct segment {
+		pmem_log_type *log;
+		char *buf;
+		size_t size;
+		size_t end;
+	};
+
+	/* State of the chained log segments. Producers append to the last
+	 * segment under the mutex. While active is set, producers skip the
+	 * ring buffer, so that elements are consumed in the order they were
+	 * produced. */
+	struct overflow_type {
+		std::mutex mutex;
+		std::atomic<bool> active;
+		std::vector<segment> segments;
+	};
+
+	mpsc_queue(pmem_log_type &pmem, size_t max_workers,
+		   pmem_segments_type *segments, size_t max_segments);
+
 	void clear_cachelines(first_block *block, size_t size);
 	void restore_offsets();
+	void restore_segments();
+
+	segment make_segment(pmem_log_type *log);
+	void append_segment(size_t size);
+	void release_segments();
+
+	template <typename Function>
+	void consume_segments(Function &&f, bool &consumed);
 
 	size_t consume_cachelines(size_t *offset);
 	void release_cachelines(size_t len);
@@ -105,6 +148,10 @@ private:
 	size_t buf_size;
 	pmem_log_type *pmem;
 
+	pmem_segments_type *pmem_segments;
+	std::unique_ptr<overflow_type> overflow;
+	size_t max_segments;
+
 	/* Stores offset and length of next message to be consumed. Only
 	 * valid if ring_buffer->consume_in_progress. */
 	size_t consume_offset = 0;
@@ -164,6 +211,11 @@ public:
 		void produce_cachelines();
 		void store_to_log(pmem::obj::string_view data, char *log_data);
 
+		template <typename Function>
+		bool try_produce_segment(pmem::obj::string_view data,
+					 size_t req_size,
+					 Function &&on_produce);
+
 		friend class mpsc_queue;
 	};
 
@@ -189,16 +241,68 @@ public:
 
 		friend class mpsc_queue;
 	};
+
+	/**
+	 * Type representing persistent list of additional log segments,
+	 * which may be managed by mpsc_queue together with pmem_log_type.
+	 *
+	 * Segments are kept in a separate object, so that the layout of
+	 * pmem_log_type is the same as in previous versions. Object of this
+	 * type has to be managed by pmem::obj::pool and passed to every
+	 * mpsc_queue created for the same pmem_log_type object, otherwise
+	 * elements stored in segments are not consumed. Segments are freed
+	 * together with this object.
+	 */
+	class pmem_segments_type {
+	public:
+		pmem_segments_type() = default;
+		~pmem_segments_type();
+
+	private:
+		pmem::obj::vector<pmem::obj::persistent_ptr<pmem_log_type>>
+			logs;
+
+		friend class mpsc_queue;
+	};
 };
 
 /**
- * mpsc_queue constructor.
+ * mpsc_queue constructor. try_produce() fails if there is no space in
+ * the log.
  *
  * @param[in] pmem reference to already allocated pmem_log_type object
  * @param[in] max_workers maximum number of workers which may be added to
  * mpsc_queue at the same time.
  */
 mpsc_queue::mpsc_queue(pmem_log_type &pmem, size_t max_workers)
+    : mpsc_queue(pmem, max_workers, nullptr, 0)
+{
+}
+
+/**
+ * mpsc_queue constructor. If there is no space in the log, try_produce()
+ * stores data in additional log segments.
+ *
+ * @param[in] pmem reference to already allocated pmem_log_type object
+ * @param[in] max_workers maximum number of workers which may be added to
+ * mpsc_queue at the same time.
+ * @param[in] segments reference to already allocated pmem_segments_type
+ * object, which stores segments of the log.
+ * @param[in] max_segments maximum number of additional log segments which
+ * may be allocated when the log is full. If 0, try_produce() fails if there
+ * is no space in the log.
+ */
+mpsc_queue::mpsc_queue(pmem_log_type &pmem, size_t max_workers,
+		       pmem_segments_type &segments, size_t max_segments)
+    : mpsc_queue(pmem, max_workers, &segments, max_segments)
+{
+}
+
+mpsc_queue::mpsc_queue(pmem_log_type &pmem, size_t max_workers,
+		       pmem_segments_type *segments, size_t max_segments)
+    : pmem_segments(segments),
+      overflow(new overflow_type()),
+      max_segments(max_segments)
 {
 	pop = pmem::obj::pool_by_vptr(&pmem);
 
@@ -216,6 +320,7 @@ mpsc_queue::mpsc_queue(pmem_log_type &pmem, size_t max_workers)
 	this->pmem = &pmem;
 
 	restore_offsets();
+	restore_segments();
 }
 
 ptrdiff_t
@@ -323,6 +428,115 @@ mpsc_queue::restore_offsets()
 	w.produce_cachelines();
 }
 
+void
+mpsc_queue::restore_segments()
+{
+	overflow->active = false;
+
+	if (pmem_segments) {
+		const auto &logs = pmem_segments->logs;
+		for (auto &log : logs)
+			overflow->segments.push_back(make_segment(log.get()));
+	}
+
+	/* Elements stored in segments are newer than the ones in the ring
+	 * buffer, producers have to continue appending to segments. */
+	if (!overflow->segments.empty())
+		overflow->active = true;
+}
+
+mpsc_queue::segment
+mpsc_queue::make_segment(pmem_log_type *log)
+{
+	/* data() skips the unaligned beginning of the buffer */
+	auto seg_data = log->data();
+
+	segment seg;
+	seg.log = log;
+	seg.buf = const_cast<char *>(seg_data.data());
+	seg.size = seg_data.size();
+
+	assert(reinterpret_cast<uintptr_t>(seg.buf) %
+		       pmem::detail::CACHELINE_SIZE ==
+	       0);
+	assert(seg.size % pmem::detail::CACHELINE_SIZE == 0);
+
+	/* Segments are never wrapped around - all produced elements are
+	 * stored contiguously, starting from the consumer offset. */
+	seg.end = log->written;
+	while (seg.end < seg.size) {
+		auto b = reinterpret_cast<first_block *>(seg.buf + seg.end);
+		if (b->size == 0)
+			break;
+
+		auto size = b->size & (~size_t(first_block::DIRTY_FLAG));
+		seg.end += pmem::detail::align_up(size + sizeof(b->size),
+						  pmem::detail::CACHELINE_SIZE);
+	}
+
+	seg.end = (std::min)(seg.end, seg.size);
+
+	return seg;
+}
+
+/* Allocates new segment, capable of storing at least size bytes, and appends
+ * it to the persistent list. Must be called with overflow->mutex held. */
+void
+mpsc_queue::append_segment(size_t size)
+{
+	assert(pmem_segments != nullptr);
+
+	auto &logs = pmem_segments->logs;
+
+	/* Additional cacheline is needed, because data() aligns the beginning
+	 * of the buffer up to a cacheline. */
+	auto seg_size =
+		(std::max)(size, buf_size) + pmem::detail::CACHELINE_SIZE;
+
+	pmem::obj::flat_transaction::run(pop, [&] {
+		logs.push_back(
+			pmem::obj::make_persistent<pmem_log_type>(seg_size));
+	});
+
+	overflow->segments.push_back(make_segment(logs.cback().get()));
+}
+
+/* Frees segments which were entirely consumed. Must be called with
+ * overflow->mutex held. */
+void
+mpsc_queue::release_segments()
+{
+	auto &segments = overflow->segments;
+
+	auto it = std::find_if(segments.begin(), segments.end(),
+			       [](const segment &seg) {
+				       return seg.log->written != seg.end;
+			       });
+
+	if (it != segments.begin()) {
+		auto &logs = pmem_segments->logs;
+		auto count = static_cast<size_t>(it - segments.begin());
+
+		pmem::obj::flat_transaction::run(pop, [&] {
+			for (size_t i = 0; i < count; ++i) {
+				assert(logs.const_at(i).get() ==
+				       segments[i].log);
+				pmem::obj::delete_persistent<pmem_log_type>(
+					logs.const_at(i));
+			}
+
+			logs.erase(logs.cbegin(),
+				   logs.cbegin() +
+					   static_cast<ptrdiff_t>(count));
+		});
+
+		segments.erase(segments.begin(), it);
+	}
+
+	if (segments.empty())
+		overflow->active = false;
+}
+
 /**
  * Constructs pmem_log_type object
  *
@@ -333,6 +547,17 @@ mpsc_queue::pmem_log_type::pmem_log_type(size_t size)
 {
 }
 
+/**
+ * Destroys pmem_segments_type object, together with all log segments.
+ *
+ * @pre must be called in transaction scope.
+ */
+mpsc_queue::pmem_segments_type::~pmem_segments_type()
+{
+	for (auto it = logs.cbegin(); it != logs.cend(); ++it)
+		pmem::obj::delete_persistent<pmem_log_type>(*it);
+}
+
 /**
  * Returns  pmem::obj::string_view which allows to read-only access to the
  * underlying buffer.
@@ -415,7 +640,7 @@ mpsc_queue::try_consume_batch(Function &&f)
 			size_t offset;
 			auto len = consume_cachelines(&offset);
 			if (!len)
-				return consumed;
+				break;
 
 			consume_offset = offset;
 			consume_len = len;
@@ -439,6 +664,7 @@ mpsc_queue::try_consume_batch(Function &&f)
 
 			auto b = reinterpret_cast<first_block *>(data);
 			clear_cachelines(b, consume_len);
+			assert(consume_offset + consume_len <= buf_size);
 
 			if (consume_offset + consume_len < buf_size)
 				pmem->written = consume_offset + consume_len;
@@ -462,9 +688,54 @@ mpsc_queue::try_consume_batch(Function &&f)
 		 * call store_explicit in consume */
 	}
 
+	/* Elements from segments can be consumed only when all elements
+	 * from the ring buffer were consumed. Otherwise, elements stored by
+	 * a single producer might be consumed out of order. */
+	if (overflow->active.load(std::memory_order_acquire) &&
+	    ringbuf::ringbuf_empty(ring_buffer.get()))
+		consume_segments(f, consumed);
+
 	return consumed;
 }
 
+template <typename Function>
+void
+mpsc_queue::consume_segments(Function &&f, bool &consumed)
+{
+	std::vector<segment> segments;
+	{
+		std::lock_guard<std::mutex> lock(overflow->mutex);
+		segments = overflow->segments;
+	}
+
+	/* Producers never modify data below seg.end, hence consumer might
+	 * access it without holding the lock. */
+	pmem::obj::flat_transaction::run(pop, [&] {
+		for (auto &seg : segments) {
+			auto written = seg.log->written.get_ro();
+			if (written == seg.end)
+				continue;
+
+			auto data = seg.buf + written;
+			auto len = seg.end - written;
+			auto begin = iterator(data, data + len);
+			auto end = iterator(data + len, data + len);
+
+			if (begin != end) {
+				consumed = true;
+				f(batch_type(begin, end));
+			}
+
+			clear_cachelines(reinterpret_cast<first_block *>(data),
+					 len);
+			seg.log->written = seg.end;
+		}
+	});
+
+	std::lock_guard<std::mutex> lock(overflow->mutex);
+	release_segments();
+}
+
 inline mpsc_queue::worker::worker(mpsc_queue *q)
 {
 	queue = q;
@@ -531,14 +802,24 @@ mpsc_queue::worker::try_produce(pmem::obj::string_view data,
 	auto req_size =
 		pmem::detail::align_up(data.size() + sizeof(first_block::size),
 				       pmem::detail::CACHELINE_SIZE);
+
+	if (queue->overflow->active.load(std::memory_order_acquire))
+		return try_produce_segment(data, req_size,
+					   std::forward<Function>(on_produce));
+
 	auto offset = acquire_cachelines(req_size);
 
 #if LIBPMEMOBJ_CPP_VG_HELGRIND_ENABLED
 	ANNOTATE_HAPPENS_AFTER(queue->ring_buffer.get());
 #endif
 
-	if (offset == -1)
-		return false;
+	if (offset == -1) {
+		if (queue->max_segments == 0)
+			return false;
+
+		return try_produce_segment(data, req_size,
+					   std::forward<Function>(on_produce));
+	}
 
 	store_to_log(data, queue->buf + offset);
 
@@ -554,6 +835,46 @@ mpsc_queue::worker::try_produce(pmem::obj::string_view data,
 	return true;
 }
 
+template <typename Function>
+bool
+mpsc_queue::worker::try_produce_segment(pmem::obj::string_view data,
+					size_t req_size, Function &&on_produce)
+{
+	auto &overflow = *queue->overflow;
+
+	std::lock_guard<std::mutex> lock(overflow.mutex);
+
+	overflow.active = true;
+
+	/* Empty elements are never visible for the consumer. Moreover, zeroed
+	 * cacheline marks the end of the segment on recovery. */
+	if (data.size() == 0) {
+		on_produce(pmem::obj::string_view());
+		return true;
+	}
+
+	auto &segments = overflow.segments;
+	if (segments.empty() ||
+	    segments.back().size - segments.back().end < req_size) {
+		if (segments.size() >= queue->max_segments)
+			return false;
+
+		queue->append_segment(req_size);
+	}
+
+	auto &seg = segments.back();
+	auto log_data = seg.buf + seg.end;
+
+	store_to_log(data, log_data);
+
+	on_produce(pmem::obj::string_view(
+		log_data + sizeof(first_block::size), data.size()));
+
+	seg.end += req_size;
+
+	return true;
+}
+
 inline void
 mpsc_queue::worker::store_to_log(pmem::obj::string_view data, char *log_data)
 {
@@ -694,8 +1015,6 @@ mpsc_queue::clear_cachelines(first_block *block, size_t size)
 		block->size = 0;
 		block++;
 	}
-
-	assert(end <= reinterpret_cast<first_block *>(buf + buf_size));
 }
 
 mpsc_queue::iterator &
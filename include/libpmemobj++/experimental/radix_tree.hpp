@@ -3661,8 +3661,8 @@ template <typename>
 struct is_string : std::false_type {
 };
 
-template <typename CharT, typename Traits>
-struct is_string<obj::basic_string<CharT, Traits>> : std::true_type {
+template <typename CharT, typename Traits, std::size_t N>
+struct is_string<obj::basic_string<CharT, Traits, N>> : std::true_type {
 };
 
 template <typename CharT, typename Traits>
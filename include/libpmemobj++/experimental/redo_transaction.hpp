@@ -0,0 +1,358 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Redo-log based (deferred-write) transaction.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_REDO_TRANSACTION_HPP
+#define LIBPMEMOBJ_CPP_REDO_TRANSACTION_HPP
+
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/pexceptions.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj/action_base.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Transaction which buffers all modifications in volatile memory and
+ * applies them only on commit, using libpmemobj's redo log (action API).
+ *
+ * pmem::obj::transaction is undo-log based: each modified range is
+ * snapshotted (copied to the undo log and persisted) before it is
+ * overwritten, which costs a fence per range. redo_transaction instead
+ * records new values of the modified 8-byte words and publishes all of
+ * them at once with pmemobj_publish(). The redo log is persisted once and
+ * applied atomically, so the number of fences does not depend on the
+ * number of modified fields. Repeated writes to the same word are
+ * coalesced.
+ *
+ * Until commit() is called, the persistent memory is not modified at all:
+ * reads through get() observe pending values, while plain reads observe
+ * the old ones. If the redo_transaction is destroyed (or abort() is
+ * called) before commit(), all pending writes are discarded.
+ *
+ * Only trivially copyable objects can be modified. Whole, naturally
+ * aligned 8-byte words which overlap the object are written on commit.
+ * Bytes of those words which were not set are read from the memory by
+ * commit(), so neighbouring data modified after set() keeps its new value,
+ * but it must not be modified by other threads concurrently with commit().
+ *
+ * If commit() is called inside of a (undo-log based) transaction, the
+ * writes are published with pmemobj_tx_publish() and become a part of
+ * that transaction.
+ *
+ * Allocations and frees are not supported - use action_batch (which
+ * publishes them together with value sets) or pmem::obj::transaction
+ * for those.
+ *
+ * This class is not thread safe.
+ */
+class redo_transaction {
+public:
+	/**
+	 * Creates an empty redo_transaction for the pool.
+	 *
+	 * @param[in] pop pool which all modified objects belong to.
+	 */
+	explicit redo_transaction(obj::pool_base &pop) noexcept
+	    : pop(pop.handle())
+	{
+	}
+
+	/**
+	 * Deleted copy constructor.
+	 */
+	redo_transaction(const redo_transaction &) = delete;
+
+	/**
+	 * Deleted assignment operator.
+	 */
+	redo_transaction &operator=(const redo_transaction &) = delete;
+
+	/**
+	 * Destructor. Discards all pending writes.
+	 */
+	~redo_transaction() = default;
+
+	/**
+	 * Executes the function and commits all writes it made through the
+	 * redo_transaction passed to it. If the function throws, the writes
+	 * are discarded and the exception is rethrown.
+	 *
+	 * @param[in] pop pool which all modified objects belong to.
+	 * @param[in] f function to execute, called as f(redo_transaction&).
+	 *
+	 * @throw pmem::pool_invalid_argument if f modifies an object which
+	 * is not in the pool.
+	 * @throw pmem::transaction_error if publishing failed.
+	 * @throw rethrow exception from f.
+	 */
+	template <typename F>
+	static void
+	run(obj::pool_base &pop, F &&f)
+	{
+		redo_transaction tx(pop);
+		f(tx);
+		tx.commit();
+	}
+
+	/**
+	 * Sets new value of the object. The value is stored in the
+	 * persistent memory on commit().
+	 *
+	 * @param[in] ptr pointer to the object, which must reside in the
+	 * pool.
+	 * @param[in] value new value of the object.
+	 *
+	 * @throw pmem::pool_invalid_argument if ptr is not in the pool.
+	 * @throw std::bad_alloc if the volatile buffer cannot grow.
+	 */
+	template <typename T>
+	void
+	set(T *ptr, const T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+			      "T must be trivially copyable");
+
+		if (pmemobj_pool_by_ptr(ptr) != pop)
+			throw pmem::pool_invalid_argument(
+				"Object is not in the pool.");
+
+		write(ptr, &value, sizeof(T));
+	}
+
+	/**
+	 * Sets new value of the persistent property.
+	 *
+	 * @param[in] field property, which must reside in the pool.
+	 * @param[in] value new value of the property.
+	 *
+	 * @throw pmem::pool_invalid_argument if field is not in the pool.
+	 * @throw std::bad_alloc if the volatile buffer cannot grow.
+	 */
+	template <typename T>
+	void
+	set(obj::p<T> &field, const T &value)
+	{
+		set(const_cast<T *>(&field.get_ro()), value);
+	}
+
+	/**
+	 * Returns value of the object, including writes pending in this
+	 * redo_transaction.
+	 *
+	 * @param[in] ptr pointer to the object.
+	 */
+	template <typename T>
+	T
+	get(const T *ptr) const
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+			      "T must be trivially copyable");
+
+		T value;
+		read(&value, ptr, sizeof(T));
+
+		return value;
+	}
+
+	/**
+	 * Returns value of the persistent property, including writes
+	 * pending in this redo_transaction.
+	 *
+	 * @param[in] field persistent property.
+	 */
+	template <typename T>
+	T
+	get(const obj::p<T> &field) const
+	{
+		return get(&field.get_ro());
+	}
+
+	/**
+	 * Atomically applies all pending writes and clears the
+	 * redo_transaction, so that it can be reused.
+	 *
+	 * @throw pmem::transaction_error if publishing failed. Pending
+	 * writes are kept in that case.
+	 * @throw std::bad_alloc if the action array cannot be allocated.
+	 */
+	void
+	commit()
+	{
+		if (words.empty())
+			return;
+
+		std::vector<pobj_action> actions;
+		append_actions(actions);
+		publish(pop, actions);
+
+		words.clear();
+	}
+
+	/**
+	 * Discards all pending writes.
+	 */
+	void
+	abort() noexcept
+	{
+		words.clear();
+	}
+
+	/**
+	 * @return number of 8-byte words which will be written on commit.
+	 */
+	std::size_t
+	size() const noexcept
+	{
+		return words.size();
+	}
+
+	/**
+	 * @return true if there are no pending writes.
+	 */
+	bool
+	empty() const noexcept
+	{
+		return words.empty();
+	}
+
+private:
+	friend class action_batch;
+
+	using word_type = uint64_t;
+
+	static constexpr std::uintptr_t word_size = sizeof(word_type);
+
+	/* new bytes of a word and the mask of bytes which were set */
+	struct pending_word {
+		word_type value;
+		word_type mask;
+	};
+
+	/*
+	 * Appends a pmemobj_set_value() action for each pending word, merging
+	 * the bytes which were set with the current content of the word.
+	 */
+	void
+	append_actions(std::vector<pobj_action> &actions) const
+	{
+		auto first = actions.size();
+		actions.resize(first + words.size());
+
+		for (auto &w : words) {
+			auto value = (*w.first & ~w.second.mask) |
+				(w.second.value & w.second.mask);
+			pmemobj_set_value(pop, &actions[first++], w.first,
+					  value);
+		}
+	}
+
+	/*
+	 * Publishes the actions, as a part of the current transaction if
+	 * there is one.
+	 */
+	static void
+	publish(PMEMobjpool *pop, std::vector<pobj_action> &actions)
+	{
+		int ret;
+		if (pmemobj_tx_stage() == TX_STAGE_WORK)
+			ret = pmemobj_tx_publish(actions.data(),
+						 actions.size());
+		else
+			ret = pmemobj_publish(pop, actions.data(),
+					      actions.size());
+
+		if (ret != 0)
+			throw pmem::transaction_error(
+				"Failed to publish actions.")
+				.with_pmemobj_errormsg();
+	}
+
+	/*
+	 * Splits the range into aligned words and stores the new bytes in
+	 * the pending value of each word, marking them in its mask.
+	 */
+	void
+	write(void *dst, const void *src, std::size_t size)
+	{
+		auto begin = reinterpret_cast<std::uintptr_t>(dst);
+		auto end = begin + size;
+		auto *in = static_cast<const char *>(src);
+
+		for (auto w = begin & ~(word_size - 1); w < end;
+		     w += word_size) {
+			auto &pending = words[reinterpret_cast<word_type *>(w)];
+
+			auto *value = reinterpret_cast<char *>(&pending.value);
+			auto *mask = reinterpret_cast<char *>(&pending.mask);
+			auto first = (std::max)(w, begin);
+			auto last = (std::min)(w + word_size, end);
+			std::memcpy(value + (first - w), in + (first - begin),
+				    last - first);
+			std::memset(mask + (first - w), 0xff, last - first);
+		}
+	}
+
+	/*
+	 * Copies the range to dst, taking pending writes into account.
+	 */
+	void
+	read(void *dst, const void *src, std::size_t size) const
+	{
+		auto begin = reinterpret_cast<std::uintptr_t>(src);
+		auto end = begin + size;
+		auto *out = static_cast<char *>(dst);
+
+		std::memcpy(out, src, size);
+
+		for (auto w = begin & ~(word_size - 1); w < end;
+		     w += word_size) {
+			auto it = words.find(reinterpret_cast<word_type *>(w));
+			if (it == words.end())
+				continue;
+
+			auto *value = reinterpret_cast<const char *>(
+				&it->second.value);
+			auto *mask = reinterpret_cast<const char *>(
+				&it->second.mask);
+			auto first = (std::max)(w, begin);
+			auto last = (std::min)(w + word_size, end);
+			for (auto b = first; b < last; ++b) {
+				if (mask[b - w])
+					out[b - begin] = value[b - w];
+			}
+		}
+	}
+
+	PMEMobjpool *pop;
+
+	/* pending writes to modified words, ordered by address */
+	std::map<word_type *, pending_word> words;
+};
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_REDO_TRANSACTION_HPP */
@@ -0,0 +1,534 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Persistent slab allocator for fixed-size objects.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_SLAB_ALLOCATOR_HPP
+#define LIBPMEMOBJ_CPP_SLAB_ALLOCATOR_HPP
+
+#include <libpmemobj++/allocator.hpp>
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/detail/enumerable_thread_specific.hpp>
+#include <libpmemobj++/mutex.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/pexceptions.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+#include <libpmemobj/base.h>
+#include <libpmemobj/tx_base.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Persistent pool of fixed-size slots.
+ *
+ * The slab carves chunks of memory, allocated from libpmemobj, into slots
+ * of the same size and keeps freed slots on free lists for reuse. It is
+ * sharded: a thread always allocates from and frees to the shard selected
+ * by its thread index (the one used by enumerable_thread_specific), so
+ * threads do not contend with each other as long as there are no more of
+ * them than shards. Allocation and deallocation take constant time and
+ * modify at most a few words.
+ *
+ * All modifications of the slab are done in transactions, so it is always
+ * consistent after a crash and there is no recovery step. If called inside
+ * of a transaction, allocate() and deallocate() become part of it and are
+ * rolled back if it aborts. The shard is locked until the end of the
+ * outermost transaction, so locks of other shards must not be taken in the
+ * same transaction. If called outside of a transaction, each of them runs
+ * a transaction of its own; a slot allocated this way is lost if the
+ * application crashes before it is stored in the pool.
+ *
+ * Slots are aligned to slab::alignment. Memory of slots is returned to
+ * libpmemobj only by clear() and the destructor.
+ *
+ * The slab must be created with make_persistent. It is usually used
+ * through slab_allocator:
+ * @code
+ * root->slab = make_persistent<slab>(sizeof(node));
+ * slab_allocator<node> alloc(slab_alloc_policy<node>(root->slab));
+ * @endcode
+ */
+class slab {
+public:
+	/** Number of shards. */
+	static constexpr std::size_t shards = 64;
+
+	/** Alignment of slots. */
+	static constexpr std::size_t alignment = 16;
+
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] slot_size size of a single slot, rounded up to
+	 * the alignment.
+	 * @param[in] slots_per_chunk number of slots in a chunk allocated
+	 * at once from libpmemobj.
+	 *
+	 * @throw pmem::pool_error if the object is not in a pool.
+	 */
+	explicit slab(std::size_t slot_size, std::size_t slots_per_chunk = 1024)
+	{
+		PMEMoid oid = pmemobj_oid(this);
+		if (OID_IS_NULL(oid))
+			throw pmem::pool_error("Invalid pool handle.");
+
+		pool_uuid = oid.pool_uuid_lo;
+		self_off = oid.off;
+
+		_slot_size = slot_size > alignment ? round_up(slot_size)
+						   : alignment;
+		_slots_per_chunk = slots_per_chunk > 0 ? slots_per_chunk : 1;
+
+		for (auto &s : _shards) {
+			s.st.free = 0;
+			s.st.bump = 0;
+			s.st.end = 0;
+			s.st.chunks = 0;
+		}
+	}
+
+	/**
+	 * Destructor. Frees all chunks, all slots must have been
+	 * deallocated. Must be called in a transaction.
+	 */
+	~slab()
+	{
+		try {
+			clear();
+		} catch (...) {
+			std::terminate();
+		}
+	}
+
+	slab(const slab &) = delete;
+	slab &operator=(const slab &) = delete;
+
+	/**
+	 * @return size of a single slot.
+	 */
+	std::size_t
+	slot_size() const noexcept
+	{
+		return _slot_size;
+	}
+
+	/**
+	 * Allocates a slot. Does not construct any object in it.
+	 *
+	 * @return PMEMoid of the slot.
+	 *
+	 * @throw transaction_out_of_memory if there is no memory for
+	 * a new chunk.
+	 * @throw transaction_alloc_error on allocation failure.
+	 * @throw transaction_error on any other transaction failure.
+	 */
+	PMEMoid
+	allocate()
+	{
+		auto &s = local_shard();
+
+		if (pmemobj_tx_stage() == TX_STAGE_WORK)
+			return allocate(s);
+
+		PMEMoid ret = OID_NULL;
+		auto pop = get_pool();
+		flat_transaction::run(pop, [&] { ret = allocate(s); });
+
+		return ret;
+	}
+
+	/**
+	 * Returns a slot, obtained from allocate() of this slab, to the slab.
+	 *
+	 * @param[in] oid PMEMoid of the slot.
+	 *
+	 * @throw transaction_error on transaction failure.
+	 */
+	void
+	deallocate(PMEMoid oid)
+	{
+		if (OID_IS_NULL(oid))
+			return;
+
+		auto &s = local_shard();
+
+		if (pmemobj_tx_stage() == TX_STAGE_WORK) {
+			deallocate(s, oid.off);
+			return;
+		}
+
+		auto pop = get_pool();
+		flat_transaction::run(pop, [&] { deallocate(s, oid.off); });
+	}
+
+	/**
+	 * Frees all chunks, which invalidates all slots. Not thread safe.
+	 *
+	 * @throw transaction_free_error on free failure.
+	 * @throw transaction_error on any other transaction failure.
+	 */
+	void
+	clear()
+	{
+		auto pop = get_pool();
+
+		flat_transaction::run(pop, [&] {
+			for (auto &s : _shards)
+				clear(s);
+
+			detail::tx_snapshot_cache::get().invalidate();
+		});
+	}
+
+private:
+	/* Header of a chunk, which holds offset of the next chunk */
+	struct chunk_header {
+		uint64_t next;
+		uint64_t reserved;
+	};
+
+	struct shard {
+		obj::mutex mutex;
+
+		struct state {
+			/* head of the free list */
+			p<uint64_t> free;
+			/* never allocated slots of the last chunk */
+			p<uint64_t> bump;
+			p<uint64_t> end;
+			/* list of chunks */
+			p<uint64_t> chunks;
+		} st;
+
+		char padding[2 * detail::CACHELINE_SIZE - sizeof(obj::mutex) -
+			     sizeof(state)];
+	};
+
+	static std::size_t
+	round_up(std::size_t size) noexcept
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	static uint64_t *
+	link(char *slot) noexcept
+	{
+		return reinterpret_cast<uint64_t *>(slot);
+	}
+
+	char *
+	base() noexcept
+	{
+		return reinterpret_cast<char *>(this) - self_off;
+	}
+
+	pool_base
+	get_pool() const
+	{
+		return pool_base(pmemobj_pool_by_ptr(this));
+	}
+
+	shard &
+	local_shard()
+	{
+		return _shards[detail::this_thread_index() % shards];
+	}
+
+	/*
+	 * Locks the shard until the end of the outermost transaction and
+	 * adds its state to the transaction.
+	 */
+	void
+	acquire(shard &s)
+	{
+		if (pmemobj_tx_lock(TX_PARAM_MUTEX, s.mutex.native_handle()))
+			throw pmem::transaction_error(
+				"Failed to lock the shard of a slab.")
+				.with_pmemobj_errormsg();
+
+		detail::conditional_add_to_tx(&s.st);
+	}
+
+	PMEMoid
+	allocate(shard &s)
+	{
+		acquire(s);
+
+		uint64_t off;
+		if (s.st.free != 0) {
+			off = s.st.free.get_ro();
+			char *slot = base() + off;
+
+			/* restores the free list on abort */
+			detail::conditional_add_to_tx(slot, _slot_size);
+			s.st.free = *link(slot);
+		} else {
+			if (s.st.bump == s.st.end)
+				new_chunk(s);
+
+			off = s.st.bump.get_ro();
+			s.st.bump += _slot_size;
+
+			/* slot is not in use, but must be flushed on commit */
+			detail::conditional_add_to_tx(base() + off, _slot_size,
+						      POBJ_XADD_NO_SNAPSHOT);
+		}
+
+		return PMEMoid{pool_uuid, off};
+	}
+
+	void
+	deallocate(shard &s, uint64_t off)
+	{
+		acquire(s);
+
+		char *slot = base() + off;
+		detail::conditional_add_to_tx(link(slot));
+
+		*link(slot) = s.st.free.get_ro();
+		s.st.free = off;
+	}
+
+	void
+	clear(shard &s)
+	{
+		detail::conditional_add_to_tx(&s.st);
+
+		while (s.st.chunks != 0) {
+			PMEMoid chunk{pool_uuid, s.st.chunks.get_ro()};
+			s.st.chunks = *link(base() + chunk.off);
+
+			detail::tx_stats_on_free(chunk);
+			if (pmemobj_tx_free(chunk) != 0)
+				throw pmem::transaction_free_error(
+					"failed to delete persistent memory object")
+					.with_pmemobj_errormsg();
+		}
+
+		s.st.free = 0;
+		s.st.bump = 0;
+		s.st.end = 0;
+	}
+
+	void
+	new_chunk(shard &s)
+	{
+		auto size = sizeof(chunk_header) +
+			_slot_size * _slots_per_chunk;
+
+		PMEMoid chunk = pmemobj_tx_alloc(
+			size, detail::type_num<chunk_header>());
+		if (OID_IS_NULL(chunk)) {
+			if (errno == ENOMEM)
+				throw pmem::transaction_out_of_memory(
+					"Failed to allocate persistent memory object")
+					.with_pmemobj_errormsg();
+			else
+				throw pmem::transaction_alloc_error(
+					"Failed to allocate persistent memory object")
+					.with_pmemobj_errormsg();
+		}
+
+		detail::tx_snapshot_cache::get().insert_allocation(
+			pmemobj_direct(chunk), size);
+		detail::tx_stats_on_alloc(size);
+
+		*link(base() + chunk.off) = s.st.chunks.get_ro();
+		s.st.chunks = chunk.off;
+		s.st.bump = chunk.off + sizeof(chunk_header);
+		s.st.end = s.st.bump + _slot_size * _slots_per_chunk;
+	}
+
+	p<uint64_t> pool_uuid;
+	p<uint64_t> self_off;
+	p<uint64_t> _slot_size;
+	p<uint64_t> _slots_per_chunk;
+
+	shard _shards[shards];
+};
+
+/**
+ * Allocation policy which serves allocations from a slab.
+ *
+ * Allocations which fit in a slot of the slab (cnt * sizeof(T) bytes with
+ * alignment of T not greater than slab::alignment) are served from the slab,
+ * all other ones by standard_alloc_policy. A default-constructed policy
+ * has no slab and always uses standard_alloc_policy.
+ *
+ * Unlike standard_alloc_policy, allocations from the slab can also be done
+ * outside of a transaction (see slab).
+ */
+template <typename T>
+class slab_alloc_policy {
+public:
+	/*
+	 * Important typedefs.
+	 */
+	using value_type = T;
+	using pointer = persistent_ptr<value_type>;
+	using const_void_pointer = persistent_ptr<const void>;
+	using size_type = std::size_t;
+	using bool_type = bool;
+
+	/**
+	 * Rebind to a different type.
+	 */
+	template <class U>
+	struct rebind {
+		using other = slab_alloc_policy<U>;
+	};
+
+	/**
+	 * Defaulted constructor.
+	 */
+	slab_alloc_policy() = default;
+
+	/**
+	 * Constructs policy which allocates from the slab.
+	 */
+	explicit slab_alloc_policy(persistent_ptr<slab> s) : _slab(s)
+	{
+	}
+
+	/**
+	 * Explicit copy constructor.
+	 */
+	explicit slab_alloc_policy(slab_alloc_policy const &rhs)
+	    : _slab(rhs._slab)
+	{
+	}
+
+	/**
+	 * Type converting constructor.
+	 */
+	template <typename U>
+	explicit slab_alloc_policy(slab_alloc_policy<U> const &rhs)
+	    : _slab(rhs.get_slab())
+	{
+	}
+
+	/**
+	 * Allocate storage for cnt objects of type T. Does not construct the
+	 * objects.
+	 *
+	 * @param[in] cnt the number of objects to allocate memory for.
+	 *
+	 * @throw transaction_scope_error if the storage does not fit in
+	 * a slot and it is called outside of a transaction.
+	 * @throw transaction_out_of_memory if there is no free memory of
+	 * requested size.
+	 * @throw transaction_alloc_error on transactional allocation failure.
+	 */
+	pointer
+	allocate(size_type cnt, const_void_pointer = 0)
+	{
+		if (!fits(cnt))
+			return standard_alloc_policy<T>().allocate(cnt);
+
+		return pointer(_slab->allocate());
+	}
+
+	/**
+	 * Deallocates storage pointed to p, which must be a value returned by
+	 * a previous call to allocate with the same cnt that has not been
+	 * invalidated by an intervening call to deallocate.
+	 *
+	 * @param[in] p pointer to the memory to be deallocated.
+	 * @param[in] cnt the number of objects passed to allocate.
+	 */
+	void
+	deallocate(pointer p, size_type cnt = 1)
+	{
+		if (!fits(cnt)) {
+			standard_alloc_policy<T>().deallocate(p, cnt);
+			return;
+		}
+
+		_slab->deallocate(p.raw());
+	}
+
+	/**
+	 * The largest value that can meaningfully be passed to allocate().
+	 *
+	 * @return largest value that can be passed to allocate.
+	 */
+	size_type
+	max_size() const
+	{
+		return PMEMOBJ_MAX_ALLOC_SIZE / sizeof(value_type);
+	}
+
+	/**
+	 * @return the slab, nullptr if the policy has none.
+	 */
+	persistent_ptr<slab>
+	get_slab() const noexcept
+	{
+		return _slab;
+	}
+
+private:
+	bool
+	fits(size_type cnt) const
+	{
+		return _slab != nullptr && alignof(T) <= slab::alignment &&
+			cnt <= _slab->slot_size() / sizeof(T);
+	}
+
+	persistent_ptr<slab> _slab;
+};
+
+/**
+ * Determines if memory from another allocator can be deallocated from this one.
+ *
+ * @return true if both policies use the same slab.
+ */
+template <typename T, typename T2>
+inline bool
+operator==(slab_alloc_policy<T> const &lhs, slab_alloc_policy<T2> const &rhs)
+{
+	return lhs.get_slab() == rhs.get_slab();
+}
+
+/**
+ * Determines if memory from another allocator can be deallocated from this one.
+ *
+ * @return false.
+ */
+template <typename T, typename OtherAllocator>
+inline bool
+operator==(slab_alloc_policy<T> const &, OtherAllocator const &)
+{
+	return false;
+}
+
+/**
+ * Allocator which serves allocations of single objects from a slab.
+ */
+template <typename T>
+using slab_allocator = allocator<T, slab_alloc_policy<T>>;
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_SLAB_ALLOCATOR_HPP */
@@ -0,0 +1,805 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Append-only persistent string, optimized for accumulating data.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_STRING_BUILDER_HPP
+#define LIBPMEMOBJ_CPP_STRING_BUILDER_HPP
+
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pext.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/string_view.hpp>
+#include <libpmemobj++/transaction.hpp>
+#include <libpmemobj++/utils.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Persistent, append-only string, optimized for accumulating data (e.g.
+ * logs) with many small appends.
+ *
+ * Appending to pmem::obj::string runs a transaction and snapshots the
+ * modified part of the string on every call. basic_string_builder instead
+ * appends characters to the unused part of its buffer, which is never
+ * visible to readers, so it does not have to be snapshotted. The new
+ * characters are written with non-temporal stores and persisted, and then
+ * the new length is published with a single, failure-atomic 8-byte store.
+ * If a crash happens in the middle of append(), the string has either old
+ * or new content.
+ *
+ * A transaction is needed only when the buffer has to be reallocated. The
+ * capacity grows geometrically, hence the number of such transactions is
+ * logarithmic in the final length of the string.
+ *
+ * If append() is called inside of a transaction, the length is
+ * snapshotted, so that the string is restored on abort. If clear() is
+ * called inside of a transaction, the cleared characters are snapshotted
+ * as well, because the following appends overwrite them.
+ *
+ * Contrary to pmem::obj::string, content of the string can only be
+ * appended or cleared - it is not possible to modify characters which were
+ * already published. The string is not null-terminated (the terminator
+ * would have to be rewritten on every append); use view(), or data()
+ * together with size(), to read it.
+ *
+ * This class is not thread safe.
+ *
+ * @pre CharT must be a trivial type.
+ */
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_string_builder {
+public:
+	static_assert(std::is_trivial<CharT>::value,
+		      "CharT must be a trivial type");
+
+	/* Member types */
+	using traits_type = Traits;
+	using value_type = CharT;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using const_reference = const value_type &;
+	using const_pointer = const value_type *;
+	using const_iterator = const_pointer;
+	using view_type = basic_string_view<CharT, Traits>;
+
+	/* Initial capacity, in number of characters */
+	static constexpr size_type min_capacity = 64;
+
+	/* Constructors */
+	basic_string_builder();
+	basic_string_builder(const basic_string_builder &) = delete;
+
+	/* Destructor */
+	~basic_string_builder();
+
+	basic_string_builder &operator=(const basic_string_builder &) = delete;
+
+	/* Element access */
+	const_reference at(size_type n) const;
+	const_reference operator[](size_type n) const noexcept;
+	const CharT *data() const noexcept;
+	const CharT *cdata() const noexcept;
+	view_type view() const noexcept;
+	operator view_type() const noexcept;
+
+	/* Iterators */
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+
+	/* Capacity */
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type length() const noexcept;
+	size_type capacity() const noexcept;
+	size_type max_size() const noexcept;
+	void reserve(size_type new_cap);
+
+	/* Modifiers */
+	basic_string_builder &append(const CharT *s, size_type count);
+	basic_string_builder &append(const CharT *s);
+	basic_string_builder &append(view_type sv);
+	basic_string_builder &append(size_type count, CharT ch);
+	basic_string_builder &operator+=(const CharT *s);
+	basic_string_builder &operator+=(view_type sv);
+	basic_string_builder &operator+=(CharT ch);
+	void push_back(CharT ch);
+	void clear();
+	void free_data();
+
+private:
+	/* Published length of the string */
+	p<size_type> _size;
+	p<size_type> _capacity;
+	persistent_ptr<CharT[]> _data;
+
+	bool contains(const CharT *s) const noexcept;
+	void grow(size_type count);
+	void realloc(size_type new_cap);
+	void free_buffer();
+	void publish(pool_base &pb, size_type new_size);
+	pool_base get_pool() const noexcept;
+	void check_pmem() const;
+	void check_tx_stage_work() const;
+};
+
+using string_builder = basic_string_builder<char>;
+using wstring_builder = basic_string_builder<wchar_t>;
+using u16string_builder = basic_string_builder<char16_t>;
+using u32string_builder = basic_string_builder<char32_t>;
+
+/**
+ * Default constructor. Constructs an empty string, with no buffer
+ * allocated.
+ *
+ * @pre must be called in transaction scope.
+ *
+ * @throw pmem::pool_error if an object is not in persistent memory.
+ * @throw pmem::transaction_scope_error if constructor wasn't called in
+ * transaction.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits>::basic_string_builder()
+{
+	check_pmem();
+	check_tx_stage_work();
+
+	_size = 0;
+	_capacity = 0;
+	_data = nullptr;
+}
+
+/**
+ * Destructor.
+ * Note that free_data may throw a transaction_free_error when freeing
+ * underlying buffer failed. It is recommended to call free_data manually
+ * before object destruction, otherwise application can be terminated on
+ * failure.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits>::~basic_string_builder()
+{
+	try {
+		free_data();
+	} catch (...) {
+		std::terminate();
+	}
+}
+
+/**
+ * Access element at specific index with bounds checking.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n in underlying buffer.
+ *
+ * @throw std::out_of_range if n is not within the range of the string.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::const_reference
+basic_string_builder<CharT, Traits>::at(size_type n) const
+{
+	if (n >= size())
+		throw std::out_of_range("string_builder::at");
+
+	return cdata()[n];
+}
+
+/**
+ * Access element at specific index.
+ *
+ * @param[in] n index number.
+ *
+ * @return const_reference to element number n in underlying buffer.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::const_reference
+	basic_string_builder<CharT, Traits>::operator[](size_type n) const
+	noexcept
+{
+	return cdata()[n];
+}
+
+/**
+ * @return const pointer to the underlying buffer. Note that the string is
+ * not null-terminated.
+ */
+template <typename CharT, typename Traits>
+const CharT *
+basic_string_builder<CharT, Traits>::data() const noexcept
+{
+	return _data.get();
+}
+
+/**
+ * @return const pointer to the underlying buffer. Note that the string is
+ * not null-terminated.
+ */
+template <typename CharT, typename Traits>
+const CharT *
+basic_string_builder<CharT, Traits>::cdata() const noexcept
+{
+	return _data.get();
+}
+
+/**
+ * @return basic_string_view of the published content of the string.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::view_type
+basic_string_builder<CharT, Traits>::view() const noexcept
+{
+	return view_type(cdata(), size());
+}
+
+/**
+ * Conversion to basic_string_view of the published content of the string.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits>::operator view_type() const noexcept
+{
+	return view();
+}
+
+/**
+ * @return const iterator to the beginning.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::const_iterator
+basic_string_builder<CharT, Traits>::begin() const noexcept
+{
+	return cbegin();
+}
+
+/**
+ * @return const iterator to the beginning.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::const_iterator
+basic_string_builder<CharT, Traits>::cbegin() const noexcept
+{
+	return cdata();
+}
+
+/**
+ * @return const iterator to the end.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::const_iterator
+basic_string_builder<CharT, Traits>::end() const noexcept
+{
+	return cend();
+}
+
+/**
+ * @return const iterator to the end.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::const_iterator
+basic_string_builder<CharT, Traits>::cend() const noexcept
+{
+	return cdata() + size();
+}
+
+/**
+ * @return true if string is empty, false otherwise.
+ */
+template <typename CharT, typename Traits>
+bool
+basic_string_builder<CharT, Traits>::empty() const noexcept
+{
+	return size() == 0;
+}
+
+/**
+ * @return number of published characters in the string.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::size_type
+basic_string_builder<CharT, Traits>::size() const noexcept
+{
+	return _size;
+}
+
+/**
+ * @return number of published characters in the string.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::size_type
+basic_string_builder<CharT, Traits>::length() const noexcept
+{
+	return size();
+}
+
+/**
+ * @return number of characters which can be held in currently allocated
+ * buffer.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::size_type
+basic_string_builder<CharT, Traits>::capacity() const noexcept
+{
+	return _capacity;
+}
+
+/**
+ * @return maximum number of characters the string is able to hold due to
+ * PMDK limitations.
+ */
+template <typename CharT, typename Traits>
+typename basic_string_builder<CharT, Traits>::size_type
+basic_string_builder<CharT, Traits>::max_size() const noexcept
+{
+	return PMEMOBJ_MAX_ALLOC_SIZE / sizeof(CharT);
+}
+
+/**
+ * Increases the capacity of the string to at least new_cap
+ * transactionally. If new_cap is not greater than the current capacity(),
+ * the method does nothing.
+ *
+ * @param[in] new_cap new capacity.
+ *
+ * @post capacity() >= new_cap
+ *
+ * @throw std::length_error if new_cap > max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::reserve(size_type new_cap)
+{
+	if (new_cap > max_size())
+		throw std::length_error("New capacity exceeds max size.");
+
+	if (new_cap > capacity())
+		realloc(new_cap);
+}
+
+/**
+ * Appends characters in the range [s, s + count) to the string. If there
+ * is enough capacity, no transaction is run: characters are copied to the
+ * unused part of the buffer and then the new length is atomically
+ * published. Otherwise, buffer is first reallocated in a transaction.
+ *
+ * The range may be a part of this string.
+ *
+ * @param[in] s pointer to the characters to be appended.
+ * @param[in] count number of characters to be appended.
+ *
+ * @return *this
+ *
+ * @post size() == size() + count
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::append(const CharT *s, size_type count)
+{
+	if (count == 0)
+		return *this;
+
+	if (count > capacity() - size()) {
+		/* s might point to the buffer which is about to be freed */
+		if (contains(s)) {
+			auto offset = s - cdata();
+			grow(count);
+			s = cdata() + offset;
+		} else {
+			grow(count);
+		}
+	}
+
+	auto pb = get_pool();
+	pmemobj_memcpy(pb.handle(), _data.get() + size(), s,
+		       count * sizeof(CharT),
+		       PMEMOBJ_F_MEM_NONTEMPORAL | PMEMOBJ_F_MEM_NODRAIN);
+	publish(pb, size() + count);
+
+	return *this;
+}
+
+/**
+ * Appends null-terminated string pointed to by s to the string.
+ *
+ * @param[in] s pointer to the null-terminated string to be appended.
+ *
+ * @return *this
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::append(const CharT *s)
+{
+	return append(s, traits_type::length(s));
+}
+
+/**
+ * Appends characters from sv to the string.
+ *
+ * @param[in] sv basic_string_view of characters to be appended.
+ *
+ * @return *this
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::append(view_type sv)
+{
+	return append(sv.data(), sv.size());
+}
+
+/**
+ * Appends count copies of character ch to the string.
+ *
+ * @param[in] count number of characters to be appended.
+ * @param[in] ch character value to be appended.
+ *
+ * @return *this
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::append(size_type count, CharT ch)
+{
+	if (count == 0)
+		return *this;
+
+	if (count > capacity() - size())
+		grow(count);
+
+	auto pb = get_pool();
+	auto dest = _data.get() + size();
+	traits_type::assign(dest, count, ch);
+	pb.flush(dest, count * sizeof(CharT));
+	publish(pb, size() + count);
+
+	return *this;
+}
+
+/**
+ * Appends null-terminated string pointed to by s to the string.
+ *
+ * @param[in] s pointer to the null-terminated string to be appended.
+ *
+ * @return *this
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::operator+=(const CharT *s)
+{
+	return append(s);
+}
+
+/**
+ * Appends characters from sv to the string.
+ *
+ * @param[in] sv basic_string_view of characters to be appended.
+ *
+ * @return *this
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::operator+=(view_type sv)
+{
+	return append(sv);
+}
+
+/**
+ * Appends character ch to the string.
+ *
+ * @param[in] ch character to be appended.
+ *
+ * @return *this
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+basic_string_builder<CharT, Traits> &
+basic_string_builder<CharT, Traits>::operator+=(CharT ch)
+{
+	return append(1, ch);
+}
+
+/**
+ * Appends character ch to the string.
+ *
+ * @param[in] ch character to be appended.
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::push_back(CharT ch)
+{
+	append(1, ch);
+}
+
+/**
+ * Removes all characters from the string, by atomically publishing zero
+ * length. Buffer is not freed.
+ *
+ * Inside of a transaction, the cleared characters are snapshotted, so that
+ * they are restored on abort even if they were overwritten by append().
+ *
+ * @post size() == 0
+ *
+ * @throw pmem::transaction_error when snapshotting failed (if called in a
+ * transaction).
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::clear()
+{
+	if (_data != nullptr)
+		detail::conditional_add_to_tx(_data.get(), size(),
+					      POBJ_XADD_ASSUME_INITIALIZED);
+
+	auto pb = get_pool();
+	publish(pb, 0);
+}
+
+/**
+ * Clears the content of the string and frees the buffer transactionally.
+ *
+ * @post size() == 0
+ * @post capacity() == 0
+ * @post data() == nullptr
+ *
+ * @throw pmem::transaction_error when snapshotting failed.
+ * @throw pmem::transaction_free_error when freeing underlying buffer
+ * failed.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::free_data()
+{
+	if (_data == nullptr)
+		return;
+
+	auto pb = get_pool();
+	flat_transaction::run(pb, [&] {
+		free_buffer();
+
+		_data = nullptr;
+		_size = 0;
+		_capacity = 0;
+	});
+}
+
+/**
+ * Private helper function. Checks if s points to the buffer of the string.
+ */
+template <typename CharT, typename Traits>
+bool
+basic_string_builder<CharT, Traits>::contains(const CharT *s) const noexcept
+{
+	std::less_equal<const CharT *> le;
+	std::less<const CharT *> lt;
+
+	return _data != nullptr && le(cdata(), s) && lt(s, cend());
+}
+
+/**
+ * Private helper function. Makes room for at least count more characters.
+ * Capacity is at least doubled, to amortize the cost of reallocation.
+ *
+ * @throw std::length_error if new length would exceed max_size().
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::grow(size_type count)
+{
+	if (count > max_size() - size())
+		throw std::length_error("New size exceeds max size.");
+
+	size_type new_cap = (std::max)(size() + count, size_type(min_capacity));
+	if (capacity() <= max_size() / 2)
+		new_cap = (std::max)(new_cap, capacity() * 2);
+
+	realloc((std::min)(new_cap, max_size()));
+}
+
+/**
+ * Private helper function. Transactionally allocates a new buffer for
+ * new_cap characters, copies the published content to it and frees the
+ * old buffer. The new buffer is not snapshotted, because it is freed if
+ * the transaction aborts.
+ *
+ * @pre new_cap > size()
+ *
+ * @throw pmem::transaction_alloc_error when allocating new memory failed.
+ * @throw pmem::transaction_free_error when freeing old buffer failed.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::realloc(size_type new_cap)
+{
+	assert(new_cap > size());
+
+	auto pb = get_pool();
+	flat_transaction::run(pb, [&] {
+		/*
+		 * We need to cache pmemobj_tx_alloc return value and only
+		 * after that assign it to _data, because when
+		 * pmemobj_tx_alloc fails, it aborts transaction.
+		 */
+		persistent_ptr<CharT[]> res = pmemobj_tx_alloc(
+			sizeof(CharT) * new_cap, detail::type_num<CharT>());
+
+		if (res == nullptr) {
+			const char *msg =
+				"Failed to allocate persistent memory object";
+			if (errno == ENOMEM)
+				throw pmem::transaction_out_of_memory(msg)
+					.with_pmemobj_errormsg();
+			else
+				throw pmem::transaction_alloc_error(msg)
+					.with_pmemobj_errormsg();
+		}
+
+		detail::tx_stats_on_alloc(sizeof(CharT) * new_cap);
+
+		if (_data != nullptr) {
+			pmemobj_memcpy(pb.handle(), res.get(), _data.get(),
+				       size() * sizeof(CharT),
+				       PMEMOBJ_F_MEM_NONTEMPORAL);
+
+			free_buffer();
+		}
+
+		_data = res;
+		_capacity = new_cap;
+	});
+}
+
+/**
+ * Private helper function. Must be called during transaction. Frees the
+ * underlying buffer.
+ *
+ * @pre must be called in transaction scope.
+ * @pre _data != nullptr
+ *
+ * @throw pmem::transaction_free_error when freeing buffer failed.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::free_buffer()
+{
+	assert(pmemobj_tx_stage() == TX_STAGE_WORK);
+
+	detail::tx_stats_on_free(*_data.raw_ptr());
+	if (pmemobj_tx_free(*_data.raw_ptr()) != 0)
+		throw pmem::transaction_free_error(
+			"failed to delete persistent memory object")
+			.with_pmemobj_errormsg();
+
+	detail::tx_snapshot_cache::get().invalidate();
+}
+
+/**
+ * Private helper function. Waits until characters written (and flushed)
+ * beyond the published length reach persistence domain and then
+ * atomically publishes new_size as the length of the string. Inside of a
+ * transaction, the length is snapshotted first.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::publish(pool_base &pb,
+					     size_type new_size)
+{
+	static_assert(sizeof(_size) == 8, "Length must be stored atomically");
+
+	pb.drain();
+
+	_size = new_size;
+	pb.persist(_size);
+}
+
+/**
+ * Private helper function.
+ *
+ * @return pool_base object where string resides.
+ *
+ * @pre string must reside in persistent memory pool.
+ */
+template <typename CharT, typename Traits>
+pool_base
+basic_string_builder<CharT, Traits>::get_pool() const noexcept
+{
+	return pmem::obj::pool_by_vptr(this);
+}
+
+/**
+ * Private helper function. Checks if string resides on pmem and throws an
+ * exception if not.
+ *
+ * @throw pool_error if string doesn't reside on pmem.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::check_pmem() const
+{
+	if (nullptr == pmemobj_pool_by_ptr(this))
+		throw pmem::pool_error("Object is not on pmem.");
+}
+
+/**
+ * Private helper function. Checks if current transaction stage is equal
+ * to TX_STAGE_WORK and throws an exception otherwise.
+ *
+ * @throw pmem::transaction_scope_error if current transaction stage is not
+ * equal to TX_STAGE_WORK.
+ */
+template <typename CharT, typename Traits>
+void
+basic_string_builder<CharT, Traits>::check_tx_stage_work() const
+{
+	if (pmemobj_tx_stage() != TX_STAGE_WORK)
+		throw pmem::transaction_scope_error(
+			"Call made out of transaction scope.");
+}
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_STRING_BUILDER_HPP */
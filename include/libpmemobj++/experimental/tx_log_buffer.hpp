@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Persistent, per-thread log buffers for large transactions.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_TX_LOG_BUFFER_HPP
+#define LIBPMEMOBJ_CPP_TX_LOG_BUFFER_HPP
+
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/detail/enumerable_thread_specific.hpp>
+#include <libpmemobj++/make_persistent_array.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pexceptions.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <exception>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Persistent set of per-thread transaction log buffers.
+ *
+ * Transactions which snapshot (or allocate) more than fits in the default
+ * log space of libpmemobj extend their logs by allocating memory inside of
+ * the transaction. tx_log_buffer keeps, for each thread, a persistent
+ * buffer for each log type, which is preallocated with reserve() and
+ * appended to every transaction started with run(). A transaction whose
+ * logs fit in the reserved buffers does not allocate any log memory.
+ *
+ * Buffers only grow and are reused by subsequent transactions of the same
+ * thread, so their sizes should be estimated with
+ * transaction::log_snapshots_max_size() and
+ * transaction::log_intents_max_size() for the largest expected
+ * transaction.
+ *
+ * The object must reside in persistent memory, in the same pool as data
+ * modified by the transactions. reserve() and run() are thread safe, but
+ * must be called outside of a transaction.
+ *
+ * Example usage:
+ * @code
+ * auto size = transaction::log_snapshots_max_size({sizeof(big_array)});
+ * r->log_buffer.reserve(transaction::log_type::snapshot, size);
+ * r->log_buffer.run([&] { r->big_array = new_value; });
+ * @endcode
+ */
+class tx_log_buffer {
+public:
+	using log_type = obj::transaction::log_type;
+
+	/**
+	 * Default constructor. No buffers are allocated.
+	 */
+	tx_log_buffer() = default;
+
+	/**
+	 * Deleted copy constructor.
+	 */
+	tx_log_buffer(const tx_log_buffer &) = delete;
+
+	/**
+	 * Deleted assignment operator.
+	 */
+	tx_log_buffer &operator=(const tx_log_buffer &) = delete;
+
+	/**
+	 * Destructor. Frees all buffers.
+	 */
+	~tx_log_buffer()
+	{
+		try {
+			clear();
+		} catch (...) {
+			std::terminate();
+		}
+	}
+
+	/**
+	 * Makes sure that the buffer of given type of the calling thread is
+	 * at least size bytes large. A smaller buffer is reallocated in a
+	 * separate transaction.
+	 *
+	 * @param[in] type type of the log.
+	 * @param[in] size minimal size of the buffer.
+	 *
+	 * @pre must be called outside of a transaction.
+	 *
+	 * @throw pmem::transaction_scope_error if called inside of a
+	 * transaction.
+	 * @throw pmem::transaction_alloc_error if the allocation failed.
+	 */
+	void
+	reserve(log_type type, std::size_t size)
+	{
+		auto &s = local();
+		auto i = static_cast<std::size_t>(type);
+
+		if (s.sizes[i] >= size)
+			return;
+
+		auto pop = get_pool();
+		obj::flat_transaction::run(pop, [&] {
+			if (s.buffers[i] != nullptr)
+				delete_persistent<char[]>(s.buffers[i],
+							  s.sizes[i]);
+
+			s.buffers[i] = make_persistent<char[]>(size);
+			s.sizes[i] = size;
+		});
+	}
+
+	/**
+	 * Returns size of the buffer of given type of the calling thread.
+	 *
+	 * @param[in] type type of the log.
+	 *
+	 * @pre must be called outside of a transaction.
+	 *
+	 * @throw pmem::transaction_scope_error if called inside of a
+	 * transaction.
+	 */
+	std::size_t
+	size(log_type type)
+	{
+		return local().sizes[static_cast<std::size_t>(type)];
+	}
+
+	/**
+	 * Executes f in a transaction to which all reserved buffers of the
+	 * calling thread are appended (see transaction::log_append_buffer()).
+	 *
+	 * @param[in] f function to execute in the transaction.
+	 *
+	 * @pre must be called outside of a transaction.
+	 *
+	 * @throw pmem::transaction_scope_error if called inside of a
+	 * transaction.
+	 * @throw transaction_error on any error pertaining the execution
+	 * of the transaction.
+	 * @throw manual_tx_abort on manual transaction abort.
+	 * @throw rethrow exception from f.
+	 */
+	template <typename F>
+	void
+	run(F &&f)
+	{
+		auto &s = local();
+		auto pop = get_pool();
+
+		obj::transaction::run(pop, [&] {
+			for (std::size_t i = 0; i < log_types; ++i) {
+				if (s.buffers[i] == nullptr)
+					continue;
+
+				obj::transaction::log_append_buffer(
+					static_cast<log_type>(i),
+					s.buffers[i].get(), s.sizes[i]);
+			}
+
+			f();
+		});
+	}
+
+	/**
+	 * Frees buffers of all threads. Not thread safe.
+	 *
+	 * @throw pmem::transaction_error if the transaction failed.
+	 */
+	void
+	clear()
+	{
+		auto pop = get_pool();
+		obj::flat_transaction::run(pop, [&] {
+			for (auto &s : slots) {
+				for (std::size_t i = 0; i < log_types; ++i) {
+					if (s.buffers[i] == nullptr)
+						continue;
+
+					delete_persistent<char[]>(s.buffers[i],
+								  s.sizes[i]);
+					s.buffers[i] = nullptr;
+					s.sizes[i] = 0;
+				}
+			}
+		});
+
+		slots.clear();
+	}
+
+private:
+	static constexpr std::size_t log_types = 2;
+
+	struct slot {
+		obj::persistent_ptr<char[]> buffers[log_types];
+		obj::p<std::size_t> sizes[log_types] = {};
+	};
+
+	slot &
+	local()
+	{
+		if (pmemobj_tx_stage() == TX_STAGE_WORK)
+			throw pmem::transaction_scope_error(
+				"Function must be called outside of a transaction.");
+
+		return slots.local();
+	}
+
+	obj::pool_base
+	get_pool() const noexcept
+	{
+		auto pop = pmemobj_pool_by_ptr(this);
+		assert(pop != nullptr);
+		return obj::pool_base(pop);
+	}
+
+	detail::enumerable_thread_specific<slot> slots;
+};
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_TX_LOG_BUFFER_HPP */
@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/**
+ * @file
+ * Transaction statistics.
+ */
+
+#ifndef LIBPMEMOBJ_CPP_EXPERIMENTAL_TX_STATS_HPP
+#define LIBPMEMOBJ_CPP_EXPERIMENTAL_TX_STATS_HPP
+
+#include <libpmemobj++/detail/tx_stats.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pmem
+{
+
+namespace obj
+{
+
+namespace experimental
+{
+
+/**
+ * Statistics of transactions started by basic_transaction and
+ * flat_transaction.
+ *
+ * Statistics are only gathered if LIBPMEMOBJ_CPP_USE_TX_STATS is defined
+ * (consistently, in all translation units) before any libpmemobj-cpp
+ * header is included. Otherwise, all hooks in the transaction layer are
+ * empty and collect() returns no entries.
+ *
+ * Counters are kept per thread and per call site. The call site of
+ * a transaction started by transaction::run() is the (mangled) name of
+ * the type of the function passed to it, which identifies the function
+ * in which a lambda was defined. Other transactions can be labeled with
+ * site_scope; unlabeled ones are reported as "unknown". Everything done
+ * in nested transactions is accounted to the outermost one.
+ *
+ * Statistics of a thread are kept after it exits, until reset() is
+ * called.
+ *
+ * The typical usage example would be:
+ * @code
+ * tx_stats::periodic_dump dumper(std::cerr, std::chrono::seconds(10));
+ * // or, at any time:
+ * for (auto &e : tx_stats::collect())
+ *	if (e.values.redundant_snapshots > e.values.snapshots) ...
+ * @endcode
+ */
+class tx_stats {
+public:
+	/**
+	 * Counters of one call site.
+	 */
+	struct counters {
+		/** Number of outermost transactions started. */
+		std::uint64_t transactions = 0;
+		/** Number of committed transactions. */
+		std::uint64_t commits = 0;
+		/** Number of aborted transactions. */
+		std::uint64_t aborts = 0;
+		/** Number of ranges added to the undo log. */
+		std::uint64_t snapshots = 0;
+		/** Total size of ranges added to the undo log. */
+		std::uint64_t snapshot_bytes = 0;
+		/** Number of snapshots skipped, because the range was
+		 * already in the undo log. */
+		std::uint64_t redundant_snapshots = 0;
+		/** Number of transactional allocations. */
+		std::uint64_t allocations = 0;
+		/** Total requested size of transactional allocations. */
+		std::uint64_t allocation_bytes = 0;
+		/** Number of transactional frees. */
+		std::uint64_t frees = 0;
+		/** Total usable size of freed objects. */
+		std::uint64_t free_bytes = 0;
+		/** Total time from begin to the end of transactions. */
+		std::chrono::nanoseconds duration{0};
+		/** Longest time from begin to the end of a transaction. */
+		std::chrono::nanoseconds max_duration{0};
+		/** Total time spent in committing transactions. */
+		std::chrono::nanoseconds commit_duration{0};
+	};
+
+	/**
+	 * Counters of one call site in one thread.
+	 */
+	struct entry {
+		/** Thread which ran the transactions. */
+		std::thread::id thread;
+		/** Call site of the transactions. */
+		std::string site;
+		/** Counters. */
+		counters values;
+	};
+
+	/**
+	 * Sets the call site of the outermost transaction started in the
+	 * scope of this object (unless it is started by transaction::run(),
+	 * which sets its own call site). Does nothing if created inside of
+	 * a transaction.
+	 */
+	class site_scope {
+	public:
+		/**
+		 * @param[in] name name of the call site. It must be valid
+		 * until the end of the scope, e.g. a string literal.
+		 */
+		explicit site_scope(const char *name) : scope(name)
+		{
+		}
+
+	private:
+		detail::tx_stats_site_scope scope;
+	};
+
+	/**
+	 * Periodically reports statistics from a separate thread.
+	 */
+	class periodic_dump {
+	public:
+		/**
+		 * Starts a thread which calls f with the result of collect()
+		 * every interval. Does nothing if statistics are disabled.
+		 *
+		 * @param[in] f function called with collected entries.
+		 * @param[in] interval time between calls.
+		 */
+		periodic_dump(std::function<void(const std::vector<entry> &)> f,
+			      std::chrono::milliseconds interval)
+		{
+			if (!enabled())
+				return;
+
+			worker = std::thread([this, f, interval] {
+				std::unique_lock<std::mutex> lock(mutex);
+				while (!cv.wait_for(lock, interval,
+						    [&] { return stop; }))
+					f(collect());
+			});
+		}
+
+		/**
+		 * Starts a thread which writes statistics to the stream every
+		 * interval (see tx_stats::dump()).
+		 *
+		 * @param[in] os output stream.
+		 * @param[in] interval time between dumps.
+		 */
+		periodic_dump(std::ostream &os,
+			      std::chrono::milliseconds interval)
+		    : periodic_dump(
+			      [&os](const std::vector<entry> &entries) {
+				      tx_stats::dump(os, entries);
+			      },
+			      interval)
+		{
+		}
+
+		/**
+		 * Stops the thread.
+		 */
+		~periodic_dump()
+		{
+			if (!worker.joinable())
+				return;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				stop = true;
+			}
+
+			cv.notify_one();
+			worker.join();
+		}
+
+		periodic_dump(const periodic_dump &) = delete;
+		periodic_dump &operator=(const periodic_dump &) = delete;
+
+	private:
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool stop = false;
+		std::thread worker;
+	};
+
+	/**
+	 * @return true if statistics are gathered.
+	 */
+	static constexpr bool
+	enabled() noexcept
+	{
+#ifdef LIBPMEMOBJ_CPP_USE_TX_STATS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * Returns counters of all call sites of all threads. Counters of
+	 * transactions which are running concurrently may be partially
+	 * updated.
+	 */
+	static std::vector<entry>
+	collect()
+	{
+		std::vector<entry> ret;
+
+#ifdef LIBPMEMOBJ_CPP_USE_TX_STATS
+		auto threads = detail::tx_stats_registry::get().threads();
+
+		for (auto &t : threads) {
+			std::unique_lock<std::mutex> lock(t->mutex);
+
+			for (auto &s : t->sites) {
+				ret.emplace_back();
+				ret.back().thread = t->id;
+				ret.back().site = s.first;
+				read(*s.second, ret.back().values);
+			}
+		}
+#endif
+
+		return ret;
+	}
+
+	/**
+	 * Zeroes all counters and drops statistics of threads which have
+	 * exited. Counters of transactions which are running concurrently
+	 * may be partially reset.
+	 */
+	static void
+	reset()
+	{
+#ifdef LIBPMEMOBJ_CPP_USE_TX_STATS
+		auto &registry = detail::tx_stats_registry::get();
+		registry.remove_exited();
+
+		for (auto &t : registry.threads()) {
+			std::unique_lock<std::mutex> lock(t->mutex);
+
+			for (auto &s : t->sites)
+				clear(*s.second);
+		}
+#endif
+	}
+
+	/**
+	 * Writes the entries to the stream, one line per entry.
+	 *
+	 * @param[in] os output stream.
+	 * @param[in] entries entries to write.
+	 */
+	static void
+	dump(std::ostream &os, const std::vector<entry> &entries)
+	{
+		for (auto &e : entries) {
+			auto &v = e.values;
+			auto avg = [&](std::chrono::nanoseconds d) {
+				return v.transactions
+					? static_cast<std::uint64_t>(
+						  d.count()) / v.transactions
+					: 0;
+			};
+
+			os << "thread " << e.thread << " site " << e.site
+			   << ": transactions " << v.transactions
+			   << " commits " << v.commits << " aborts "
+			   << v.aborts << " snapshots " << v.snapshots << " ("
+			   << v.snapshot_bytes << " B) redundant "
+			   << v.redundant_snapshots << " allocations "
+			   << v.allocations << " (" << v.allocation_bytes
+			   << " B) frees " << v.frees << " (" << v.free_bytes
+			   << " B) avg_duration_ns " << avg(v.duration)
+			   << " max_duration_ns " << v.max_duration.count()
+			   << " avg_commit_ns " << avg(v.commit_duration)
+			   << "\n";
+		}
+
+		os.flush();
+	}
+
+	/**
+	 * Writes current statistics to the stream (see collect()).
+	 *
+	 * @param[in] os output stream.
+	 */
+	static void
+	dump(std::ostream &os)
+	{
+		dump(os, collect());
+	}
+
+	tx_stats() = delete;
+
+private:
+#ifdef LIBPMEMOBJ_CPP_USE_TX_STATS
+	static void
+	read(const detail::tx_site_counters &c, counters &v)
+	{
+		auto r = [](const detail::tx_site_counters::counter &x) {
+			return x.load(std::memory_order_relaxed);
+		};
+		auto ns = [&](const detail::tx_site_counters::counter &x) {
+			return std::chrono::nanoseconds(
+				static_cast<std::chrono::nanoseconds::rep>(
+					r(x)));
+		};
+
+		v.transactions = r(c.transactions);
+		v.commits = r(c.commits);
+		v.aborts = r(c.aborts);
+		v.snapshots = r(c.snapshots);
+		v.snapshot_bytes = r(c.snapshot_bytes);
+		v.redundant_snapshots = r(c.redundant_snapshots);
+		v.allocations = r(c.allocations);
+		v.allocation_bytes = r(c.allocation_bytes);
+		v.frees = r(c.frees);
+		v.free_bytes = r(c.free_bytes);
+		v.duration = ns(c.duration_ns);
+		v.max_duration = ns(c.max_duration_ns);
+		v.commit_duration = ns(c.commit_ns);
+	}
+
+	static void
+	clear(detail::tx_site_counters &c)
+	{
+		for (auto *x :
+		     {&c.transactions, &c.commits, &c.aborts, &c.snapshots,
+		      &c.snapshot_bytes, &c.redundant_snapshots,
+		      &c.allocations, &c.allocation_bytes, &c.frees,
+		      &c.free_bytes, &c.duration_ns, &c.max_duration_ns,
+		      &c.commit_ns})
+			x->store(0, std::memory_order_relaxed);
+	}
+#endif
+};
+
+} /* namespace experimental */
+
+} /* namespace obj */
+
+} /* namespace pmem */
+
+#endif /* LIBPMEMOBJ_CPP_EXPERIMENTAL_TX_STATS_HPP */
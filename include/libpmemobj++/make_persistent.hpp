@@ -67,6 +67,10 @@ make_persistent(allocation_flag flag, Args &&... args)
 				.with_pmemobj_errormsg();
 	}
 
+	detail::tx_snapshot_cache::get().insert_allocation(ptr.get(),
+							   sizeof(T));
+	detail::tx_stats_on_alloc(sizeof(T));
+
 	detail::create<T, Args...>(ptr.get(), std::forward<Args>(args)...);
 
 	return ptr;
@@ -131,10 +135,13 @@ delete_persistent(typename detail::pp_if_not_array<T>::type ptr)
 	 */
 	detail::destroy<T>(*ptr);
 
+	detail::tx_stats_on_free(*ptr.raw_ptr());
 	if (pmemobj_tx_free(*ptr.raw_ptr()) != 0)
 		throw pmem::transaction_free_error(
 			"failed to delete persistent memory object")
 			.with_pmemobj_errormsg();
+
+	detail::tx_snapshot_cache::get().invalidate();
 }
 
 } /* namespace obj */
@@ -77,6 +77,10 @@ make_persistent(std::size_t N, allocation_flag flag = allocation_flag::none())
 				.with_pmemobj_errormsg();
 	}
 
+	detail::tx_snapshot_cache::get().insert_allocation(ptr.get(),
+							   sizeof(I) * N);
+	detail::tx_stats_on_alloc(sizeof(I) * N);
+
 	/*
 	 * cache raw pointer to data - using persistent_ptr.get() in a loop
 	 * is expensive.
@@ -137,6 +141,10 @@ make_persistent(allocation_flag flag = allocation_flag::none())
 				.with_pmemobj_errormsg();
 	}
 
+	detail::tx_snapshot_cache::get().insert_allocation(ptr.get(),
+							   sizeof(I) * N);
+	detail::tx_stats_on_alloc(sizeof(I) * N);
+
 	/*
 	 * cache raw pointer to data - using persistent_ptr.get() in a loop
 	 * is expensive.
@@ -198,10 +206,13 @@ delete_persistent(typename detail::pp_if_array<T>::type ptr, std::size_t N)
 		detail::destroy<I>(
 			data[static_cast<std::ptrdiff_t>(N) - 1 - i]);
 
+	detail::tx_stats_on_free(*ptr.raw_ptr());
 	if (pmemobj_tx_free(*ptr.raw_ptr()) != 0)
 		throw pmem::transaction_free_error(
 			"failed to delete persistent memory object")
 			.with_pmemobj_errormsg();
+
+	detail::tx_snapshot_cache::get().invalidate();
 }
 
 /**
@@ -245,10 +256,13 @@ delete_persistent(typename detail::pp_if_size_array<T>::type ptr)
 		detail::destroy<I>(
 			data[static_cast<std::ptrdiff_t>(N) - 1 - i]);
 
+	detail::tx_stats_on_free(*ptr.raw_ptr());
 	if (pmemobj_tx_free(*ptr.raw_ptr()) != 0)
 		throw pmem::transaction_free_error(
 			"failed to delete persistent memory object")
 			.with_pmemobj_errormsg();
+
+	detail::tx_snapshot_cache::get().invalidate();
 }
 
 } /* namespace obj */
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2016-2020, Intel Corporation */
+/* Copyright 2016-2021, Intel Corporation */
 
 /**
  * @file
@@ -9,6 +9,7 @@
 #ifndef LIBPMEMOBJ_CPP_MUTEX_HPP
 #define LIBPMEMOBJ_CPP_MUTEX_HPP
 
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
 #include <libpmemobj++/pexceptions.hpp>
 #include <libpmemobj/thread.h>
 #include <libpmemobj/tx_base.h>
@@ -68,7 +69,7 @@ public:
 	void
 	lock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_mutex_lock(pop, &this->plock))
 			throw pmem::lock_error(ret, std::system_category(),
 					       "Failed to lock a mutex.")
@@ -92,7 +93,7 @@ public:
 	bool
 	try_lock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_mutex_trylock(pop, &this->plock);
 
 		if (ret == 0)
@@ -115,7 +116,7 @@ public:
 	void
 	unlock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_mutex_unlock(pop, &this->plock);
 		if (ret)
 			throw pmem::lock_error(ret, std::system_category(),
@@ -21,6 +21,7 @@
 
 #include <libpmemobj++/detail/common.hpp>
 #include <libpmemobj++/detail/ctl.hpp>
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
 #include <libpmemobj++/detail/pool_data.hpp>
 #include <libpmemobj++/p.hpp>
 #include <libpmemobj++/persistent_ptr_base.hpp>
@@ -267,6 +268,9 @@ public:
 
 		pmemobj_close(this->pop);
 		this->pop = nullptr;
+
+		/* another pool may be mapped at the same addresses */
+		detail::pool_by_ptr_invalidate();
 	}
 
 	/**
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2016-2020, Intel Corporation */
+/* Copyright 2016-2021, Intel Corporation */
 
 /**
  * @file
@@ -9,6 +9,7 @@
 #ifndef LIBPMEMOBJ_CPP_SHARED_MUTEX_HPP
 #define LIBPMEMOBJ_CPP_SHARED_MUTEX_HPP
 
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
 #include <libpmemobj/thread.h>
 #include <libpmemobj/tx_base.h>
 
@@ -69,7 +70,7 @@ public:
 	void
 	lock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_rwlock_wrlock(pop, &this->plock))
 			throw pmem::lock_error(ret, std::system_category(),
 					       "Failed to lock a shared mutex.")
@@ -94,7 +95,7 @@ public:
 	void
 	lock_shared()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_rwlock_rdlock(pop, &this->plock))
 			throw pmem::lock_error(
 				ret, std::system_category(),
@@ -118,7 +119,7 @@ public:
 	bool
 	try_lock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_rwlock_trywrlock(pop, &this->plock);
 
 		if (ret == 0)
@@ -150,7 +151,7 @@ public:
 	bool
 	try_lock_shared()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_rwlock_tryrdlock(pop, &this->plock);
 
 		if (ret == 0)
@@ -172,7 +173,7 @@ public:
 	void
 	unlock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_rwlock_unlock(pop, &this->plock);
 		if (ret)
 			throw pmem::lock_error(
@@ -15,6 +15,8 @@
 #include <string>
 #include <utility>
 
+#include <libpmemobj++/detail/string_search.hpp>
+
 #if __cpp_lib_string_view
 #include <string_view>
 #endif
@@ -493,6 +495,11 @@ typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::find(const CharT *s, size_type pos,
 				       size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find(
+			reinterpret_cast<const char *>(data()), size(),
+			reinterpret_cast<const char *>(s), pos, count);
+
 	auto sz = size();
 
 	if (pos > sz)
@@ -570,6 +577,11 @@ typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::rfind(const CharT *s, size_type pos,
 					size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_rfind(
+			reinterpret_cast<const char *>(data()), size(),
+			reinterpret_cast<const char *>(s), pos, count);
+
 	if (count <= size()) {
 		pos = (std::min)(size() - count, pos);
 		do {
@@ -652,6 +664,11 @@ typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::find_first_of(const CharT *s, size_type pos,
 						size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_first_of(
+			reinterpret_cast<const char *>(data()), size(),
+			reinterpret_cast<const char *>(s), pos, count, false);
+
 	size_type first_of = npos;
 	for (const CharT *c = s; c != s + count; ++c) {
 		size_type found = find(*c, pos);
@@ -735,6 +752,11 @@ basic_string_view<CharT, Traits>::find_first_not_of(const CharT *s,
 						    size_type pos,
 						    size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_first_of(
+			reinterpret_cast<const char *>(data()), size(),
+			reinterpret_cast<const char *>(s), pos, count, true);
+
 	if (pos >= size())
 		return npos;
 
@@ -818,6 +840,11 @@ typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::find_last_of(const CharT *s, size_type pos,
 					       size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_last_of(
+			reinterpret_cast<const char *>(data()), size(),
+			reinterpret_cast<const char *>(s), pos, count, false);
+
 	if (size() == 0 || count == 0)
 		return npos;
 
@@ -909,6 +936,11 @@ basic_string_view<CharT, Traits>::find_last_not_of(const CharT *s,
 						   size_type pos,
 						   size_type count) const
 {
+	if (pmem::detail::is_byte_string<CharT, Traits>::value)
+		return pmem::detail::byte_string_find_last_of(
+			reinterpret_cast<const char *>(data()), size(),
+			reinterpret_cast<const char *>(s), pos, count, true);
+
 	if (size() > 0) {
 		pos = (std::min)(pos, size() - 1);
 		do {
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2016-2020, Intel Corporation */
+/* Copyright 2016-2021, Intel Corporation */
 
 /**
  * @file
@@ -12,6 +12,7 @@
 #include <chrono>
 
 #include <libpmemobj++/detail/conversions.hpp>
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
 #include <libpmemobj/thread.h>
 
 namespace pmem
@@ -71,7 +72,7 @@ public:
 	void
 	lock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		if (int ret = pmemobj_mutex_lock(pop, &this->plock))
 			throw pmem::lock_error(ret, std::system_category(),
 					       "Failed to lock a mutex.")
@@ -95,7 +96,7 @@ public:
 	bool
 	try_lock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_mutex_trylock(pop, &this->plock);
 
 		if (ret == 0)
@@ -167,7 +168,7 @@ public:
 	void
 	unlock()
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 		int ret = pmemobj_mutex_unlock(pop, &this->plock);
 		if (ret)
 			throw pmem::lock_error(ret, std::system_category(),
@@ -204,7 +205,7 @@ private:
 	bool
 	timedlock_impl(const std::chrono::time_point<Clock, Duration> &abs_time)
 	{
-		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		PMEMobjpool *pop = detail::pool_by_ptr(this);
 
 		/* convert to my clock */
 		const typename Clock::time_point their_now = Clock::now();
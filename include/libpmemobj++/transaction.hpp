@@ -12,6 +12,7 @@
 #include <array>
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <libpmemobj++/detail/common.hpp>
@@ -83,6 +84,11 @@ public:
 					"failed to start transaction")
 					.with_pmemobj_errormsg();
 
+			if (!nested) {
+				detail::tx_snapshot_cache::get().begin();
+				detail::tx_stats_on_begin();
+			}
+
 			auto err = add_lock(locks...);
 
 			if (err) {
@@ -202,8 +208,10 @@ public:
 				return;
 
 			/* transaction ended normally */
-			if (pmemobj_tx_stage() == TX_STAGE_WORK)
+			if (pmemobj_tx_stage() == TX_STAGE_WORK) {
+				detail::tx_stats_on_commit();
 				pmemobj_tx_commit();
+			}
 			/* transaction aborted, throw an exception */
 			else if (pmemobj_tx_stage() == TX_STAGE_ONABORT ||
 				 (pmemobj_tx_stage() == TX_STAGE_FINALLY &&
@@ -327,6 +335,7 @@ public:
 		if (pmemobj_tx_stage() != TX_STAGE_WORK)
 			throw pmem::transaction_error("wrong stage for commit");
 
+		detail::tx_stats_on_commit();
 		pmemobj_tx_commit();
 	}
 
@@ -364,8 +373,9 @@ public:
 	 *
 	 * @param[in,out] pool the pool in which the transaction will take
 	 *	place.
-	 * @param[in] tx an std::function<void ()> which will perform
-	 *	operations within this transaction.
+	 * @param[in] tx a function object callable without arguments which
+	 *	will perform operations within this transaction. It is called
+	 *	directly, without being wrapped in an std::function.
 	 * @param[in,out] locks locks to be taken for the duration of
 	 *	the transaction.
 	 *
@@ -373,10 +383,12 @@ public:
 	 *	of the transaction.
 	 * @throw manual_tx_abort on manual transaction abort.
 	 */
-	template <typename... Locks>
+	template <typename F, typename... Locks>
 	static void
-	run(obj::pool_base &pool, std::function<void()> tx, Locks &... locks)
+	run(obj::pool_base &pool, F &&tx, Locks &... locks)
 	{
+		detail::tx_stats_site_scope site(
+			detail::tx_stats_site_name<F>());
 		manual worker(pool, locks...);
 
 		tx();
@@ -384,6 +396,7 @@ public:
 		auto stage = pmemobj_tx_stage();
 
 		if (stage == TX_STAGE_WORK) {
+			detail::tx_stats_on_commit();
 			pmemobj_tx_commit();
 		} else if (stage == TX_STAGE_ONABORT) {
 			throw pmem::transaction_error("transaction aborted");
@@ -441,6 +454,114 @@ public:
 					"Could not take a snapshot of given memory range.")
 					.with_pmemobj_errormsg();
 		}
+
+		detail::tx_stats_on_snapshot(sizeof(*addr) * num);
+	}
+
+	/*! \enum log_type
+		\brief Types of transaction logs.
+
+		To read more about PMDK's transaction logs, see manpage
+		pmemobj_tx_log_append_buffer(3):
+		https://pmem.io/pmdk/manpages/linux/master/libpmemobj/pmemobj_tx_log_append_buffer.3
+	 */
+	enum class log_type {
+		snapshot = TX_LOG_TYPE_SNAPSHOT, /**< undo log of snapshots */
+		intent = TX_LOG_TYPE_INTENT /**< redo log of allocations,
+					       frees and published actions */
+	};
+
+	/**
+	 * Appends a user-provided buffer to the log of given type of the
+	 * current transaction. Once the log fills its default space, entries
+	 * are stored in appended buffers before libpmemobj allocates any
+	 * additional log memory, so a transaction with buffers large enough
+	 * (see log_snapshots_max_size() and log_intents_max_size()) does not
+	 * allocate inside of it.
+	 *
+	 * The buffer has to be within the pool registered in the transaction.
+	 * It must not be accessed nor freed until the transaction ends and its
+	 * previous content is overwritten.
+	 *
+	 * @param[in] type type of the log.
+	 * @param[in] addr pointer to the buffer.
+	 * @param[in] size size of the buffer.
+	 *
+	 * @pre this function must be called during transaction.
+	 *
+	 * @throw transaction_error when appending the buffer failed or if
+	 * function wasn't called during transaction.
+	 */
+	static void
+	log_append_buffer(log_type type, void *addr, size_t size)
+	{
+		if (TX_STAGE_WORK != pmemobj_tx_stage())
+			throw pmem::transaction_error(
+				"wrong stage for appending a log buffer.");
+
+		if (pmemobj_tx_log_append_buffer(
+			    static_cast<pobj_log_type>(type), addr, size))
+			throw pmem::transaction_error(
+				"Could not append the log buffer.")
+				.with_pmemobj_errormsg();
+	}
+
+	/**
+	 * Enables or disables automatic allocation of log extensions of given
+	 * type for the current transaction. With automatic allocation
+	 * disabled, a transaction which runs out of log space (including
+	 * appended buffers) fails instead of allocating more.
+	 *
+	 * @param[in] type type of the log.
+	 * @param[in] on_off true to enable, false to disable automatic
+	 * allocation.
+	 *
+	 * @pre this function must be called during transaction.
+	 *
+	 * @throw transaction_error on failure or if function wasn't called
+	 * during transaction.
+	 */
+	static void
+	log_auto_alloc(log_type type, bool on_off)
+	{
+		if (TX_STAGE_WORK != pmemobj_tx_stage())
+			throw pmem::transaction_error(
+				"wrong stage for changing log auto allocation.");
+
+		if (pmemobj_tx_log_auto_alloc(static_cast<pobj_log_type>(type),
+					      on_off ? 1 : 0))
+			throw pmem::transaction_error(
+				"Could not change log auto allocation.")
+				.with_pmemobj_errormsg();
+	}
+
+	/**
+	 * Calculates the size of a snapshot log buffer which can hold
+	 * snapshots of ranges of given sizes.
+	 *
+	 * @param[in] sizes sizes of snapshotted ranges.
+	 *
+	 * @return size of the buffer, in bytes.
+	 */
+	static size_t
+	log_snapshots_max_size(std::vector<size_t> sizes)
+	{
+		return pmemobj_tx_log_snapshots_max_size(sizes.data(),
+							 sizes.size());
+	}
+
+	/**
+	 * Calculates the size of an intent log buffer which can hold given
+	 * number of intents (allocations, frees and published actions).
+	 *
+	 * @param[in] nintents number of intents.
+	 *
+	 * @return size of the buffer, in bytes.
+	 */
+	static size_t
+	log_intents_max_size(size_t nintents)
+	{
+		return pmemobj_tx_log_intents_max_size(nintents);
 	}
 
 	/*! \enum stage
@@ -531,6 +652,15 @@ private:
 	static void
 	c_callback(PMEMobjpool *pop, enum pobj_tx_stage obj_stage, void *arg)
 	{
+		/*
+		 * Ranges snapshotted so far are only known to be in the undo
+		 * log while the transaction is in TX_STAGE_WORK.
+		 */
+		if (obj_stage != TX_STAGE_WORK)
+			detail::tx_snapshot_cache::get().end();
+
+		detail::tx_stats_on_stage(obj_stage);
+
 		/*
 		 * We cannot do anything when in TX_STAGE_NONE because
 		 * pmemobj_tx_get_user_data() can only be called when there is
@@ -680,8 +810,9 @@ public:
 	 *
 	 * @param[in,out] pool the pool in which the transaction will take
 	 *	place.
-	 * @param[in] tx an std::function<void ()> which will perform
-	 *	operations within this transaction.
+	 * @param[in] tx a function object callable without arguments which
+	 *	will perform operations within this transaction. It is called
+	 *	directly, without being wrapped in an std::function.
 	 * @param[in,out] locks locks to be taken for the duration of
 	 *	the transaction.
 	 *
@@ -689,11 +820,12 @@ public:
 	 *	of the transaction.
 	 * @throw manual_tx_abort on manual transaction abort.
 	 */
-	template <typename... Locks>
+	template <typename F, typename... Locks>
 	static void
-	run(obj::pool_base &pool, std::function<void()> tx, Locks &... locks)
+	run(obj::pool_base &pool, F &&tx, Locks &... locks)
 	{
-		detail::transaction_base<false>::run(pool, tx, locks...);
+		detail::transaction_base<false>::run(
+			pool, std::forward<F>(tx), locks...);
 	}
 
 	/*
@@ -809,8 +941,9 @@ public:
 	 *
 	 * @param[in,out] pool the pool in which the transaction will take
 	 *	place.
-	 * @param[in] tx an std::function<void ()> which will perform
-	 *	operations within this transaction.
+	 * @param[in] tx a function object callable without arguments which
+	 *	will perform operations within this transaction. It is called
+	 *	directly, without being wrapped in an std::function.
 	 * @param[in,out] locks locks to be taken for the duration of
 	 *	the transaction.
 	 *
@@ -818,11 +951,12 @@ public:
 	 *	of the transaction.
 	 * @throw manual_tx_abort on manual transaction abort.
 	 */
-	template <typename... Locks>
+	template <typename F, typename... Locks>
 	static void
-	run(obj::pool_base &pool, std::function<void()> tx, Locks &... locks)
+	run(obj::pool_base &pool, F &&tx, Locks &... locks)
 	{
-		detail::transaction_base<true>::run(pool, tx, locks...);
+		detail::transaction_base<true>::run(
+			pool, std::forward<F>(tx), locks...);
 	}
 
 	/*
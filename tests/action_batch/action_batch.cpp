@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/action_batch.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <stdexcept>
+
+namespace nvobj = pmem::obj;
+namespace nvobje = pmem::obj::experimental;
+
+struct node {
+	node(int v, nvobj::persistent_ptr<node> n) : value(v), next(n)
+	{
+	}
+
+	explicit node(bool do_throw)
+	{
+		if (do_throw)
+			throw std::runtime_error("node");
+	}
+
+	nvobj::p<int> value;
+	nvobj::persistent_ptr<node> next;
+};
+
+struct root {
+	nvobj::persistent_ptr<node> head;
+	nvobj::p<uint64_t> count;
+};
+
+namespace
+{
+size_t
+count_objects(nvobj::pool<struct root> &pop)
+{
+	size_t n = 0;
+	for (auto oid = pmemobj_first(pop.handle()); !OID_IS_NULL(oid);
+	     oid = pmemobj_next(oid))
+		++n;
+
+	return n;
+}
+
+/*
+ * Allocates two nodes and links them with one publish.
+ */
+void
+test_publish(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto objects = count_objects(pop);
+
+	nvobje::action_batch batch(pop);
+
+	auto first = batch.reserve<node>(1, nullptr);
+	auto second = batch.reserve<node>(2, r->head);
+	batch.set(first->next, second);
+	batch.set(r->head, first);
+	batch.set(r->count, r->count + 2);
+
+	UT_ASSERTeq(batch.size(), 7);
+
+	/* nothing is visible before publish */
+	UT_ASSERT(r->head == nullptr);
+	UT_ASSERTeq(r->count, 0);
+	UT_ASSERT(first->next == nullptr);
+
+	batch.publish();
+
+	UT_ASSERT(batch.empty());
+	UT_ASSERT(r->head == first);
+	UT_ASSERT(r->head->next == second);
+	UT_ASSERTeq(r->head->value, 1);
+	UT_ASSERTeq(r->head->next->value, 2);
+	UT_ASSERTeq(r->count, 2);
+	UT_ASSERTeq(count_objects(pop), objects + 2);
+}
+
+/*
+ * Unpublished reservations are released.
+ */
+void
+test_cancel(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto objects = count_objects(pop);
+	auto head = r->head;
+
+	{
+		nvobje::action_batch batch(pop);
+		auto n = batch.reserve<node>(3, r->head);
+		batch.set(r->head, n);
+	}
+
+	UT_ASSERT(r->head == head);
+	UT_ASSERTeq(count_objects(pop), objects);
+
+	nvobje::action_batch batch(pop);
+	auto n = batch.reserve<node>(3, r->head);
+	batch.set(r->head, n);
+	batch.cancel();
+	batch.publish();
+
+	UT_ASSERT(r->head == head);
+	UT_ASSERTeq(count_objects(pop), objects);
+}
+
+void
+test_ctor_throw(nvobj::pool<struct root> &pop)
+{
+	auto objects = count_objects(pop);
+
+	nvobje::action_batch batch(pop);
+
+	try {
+		batch.reserve<node>(true);
+		UT_ASSERT(0);
+	} catch (std::runtime_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(batch.empty());
+
+	batch.reserve<node>(nvobj::allocation_flag_atomic::none(), false);
+	batch.publish();
+
+	UT_ASSERTeq(count_objects(pop), objects + 1);
+}
+
+/*
+ * Unlinks the first node and frees it with one publish.
+ */
+void
+test_defer_free(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto objects = count_objects(pop);
+	auto head = r->head;
+
+	nvobje::action_batch batch(pop);
+	batch.set(r->head, head->next);
+	batch.defer_free(head);
+	batch.defer_free(nvobj::persistent_ptr<node>());
+
+	UT_ASSERTeq(batch.size(), 3);
+	UT_ASSERTeq(count_objects(pop), objects);
+
+	batch.publish();
+
+	UT_ASSERTeq(r->head->value, 2);
+	UT_ASSERTeq(count_objects(pop), objects - 1);
+}
+
+/*
+ * Published inside of a transaction, actions are rolled back with it.
+ */
+void
+test_inside_tx(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto objects = count_objects(pop);
+	auto head = r->head;
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			nvobje::action_batch batch(pop);
+			auto n = batch.reserve<node>(4, r->head);
+			batch.set(r->head, n);
+			batch.publish();
+
+			UT_ASSERTeq(r->head->value, 4);
+
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(r->head == head);
+	UT_ASSERTeq(count_objects(pop), objects);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "action_batch",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	test_publish(pop);
+	test_cancel(pop);
+	test_ctor_throw(pop);
+	test_defer_free(pop);
+	test_inside_tx(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
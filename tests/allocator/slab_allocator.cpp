@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * slab_allocator.cpp -- pmem::obj::experimental::slab_allocator test
+ */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/slab_allocator.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#define LAYOUT "cpp"
+
+namespace nvobj = pmem::obj;
+namespace nvobjex = pmem::obj::experimental;
+
+namespace
+{
+
+struct foo {
+	foo(int v) : value(v)
+	{
+	}
+
+	nvobj::p<int> value;
+	nvobj::p<char> data[20];
+};
+
+struct root {
+	nvobj::persistent_ptr<nvobjex::slab> slab;
+	nvobj::persistent_ptr<foo> pfoo;
+};
+
+static constexpr size_t slots_per_chunk = 16;
+
+using foo_allocator = nvobjex::slab_allocator<foo>;
+
+foo_allocator
+make_allocator(nvobj::pool<root> &pop)
+{
+	return foo_allocator(nvobjex::slab_alloc_policy<foo>(pop.root()->slab));
+}
+
+/*
+ * test_alloc -- allocate, construct and reuse slots in transactions
+ */
+void
+test_alloc(nvobj::pool<root> &pop)
+{
+	auto r = pop.root();
+	auto al = make_allocator(pop);
+
+	UT_ASSERTeq(r->slab->slot_size(), 32);
+
+	nvobj::persistent_ptr<foo> first;
+	nvobj::transaction::run(pop, [&] {
+		first = al.allocate(1);
+		al.construct(first, 1);
+		UT_ASSERTeq(first->value, 1);
+
+		auto second = al.allocate(1);
+		UT_ASSERT(second != first);
+		UT_ASSERTeq(second.raw().off - first.raw().off, 32);
+		al.deallocate(second);
+
+		/* freed slots are reused first */
+		UT_ASSERT(al.allocate(1) == second);
+		al.deallocate(second);
+	});
+
+	UT_ASSERTeq(first->value, 1);
+
+	nvobj::transaction::run(pop, [&] {
+		al.destroy(first);
+		al.deallocate(first);
+	});
+
+	/* more slots than in a single chunk */
+	std::vector<nvobj::persistent_ptr<foo>> ptrs;
+	nvobj::transaction::run(pop, [&] {
+		for (size_t i = 0; i < 3 * slots_per_chunk; ++i) {
+			ptrs.push_back(al.allocate(1));
+			al.construct(ptrs.back(), static_cast<int>(i));
+		}
+	});
+
+	for (size_t i = 0; i < ptrs.size(); ++i)
+		UT_ASSERTeq(ptrs[i]->value, static_cast<int>(i));
+
+	nvobj::transaction::run(pop, [&] {
+		for (auto &ptr : ptrs)
+			al.deallocate(ptr);
+	});
+}
+
+/*
+ * test_abort -- allocations and deallocations are rolled back with
+ * the transaction
+ */
+void
+test_abort(nvobj::pool<root> &pop)
+{
+	auto r = pop.root();
+	auto al = make_allocator(pop);
+
+	nvobj::transaction::run(pop, [&] {
+		r->pfoo = al.allocate(1);
+		al.construct(r->pfoo, 5);
+	});
+
+	nvobj::persistent_ptr<foo> aborted;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			aborted = al.allocate(1);
+			al.construct(aborted, 6);
+			al.deallocate(r->pfoo);
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	/* the object was not freed and the aborted slot is free again */
+	UT_ASSERTeq(r->pfoo->value, 5);
+
+	nvobj::transaction::run(pop, [&] {
+		auto ptr = al.allocate(1);
+		UT_ASSERT(ptr == aborted);
+		UT_ASSERT(ptr != r->pfoo);
+		al.deallocate(ptr);
+	});
+}
+
+/*
+ * test_no_tx -- slots can be allocated outside of transactions
+ */
+void
+test_no_tx(nvobj::pool<root> &pop)
+{
+	auto al = make_allocator(pop);
+
+	auto ptr = al.allocate(1);
+	nvobj::transaction::run(pop, [&] { al.construct(ptr, 7); });
+	UT_ASSERTeq(ptr->value, 7);
+
+	al.deallocate(ptr);
+	UT_ASSERT(al.allocate(1) == ptr);
+	al.deallocate(ptr);
+
+	/* allocations which do not fit are served by the standard policy */
+	try {
+		al.allocate(2);
+		UT_ASSERT(0);
+	} catch (pmem::transaction_scope_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+}
+
+/*
+ * test_fallback -- allocations which do not fit in a slot go to the heap
+ */
+void
+test_fallback(nvobj::pool<root> &pop)
+{
+	auto al = make_allocator(pop);
+	nvobjex::slab_allocator<foo> heap_al;
+
+	UT_ASSERT(al == make_allocator(pop));
+	UT_ASSERT(al != heap_al);
+	UT_ASSERT(al != nvobj::allocator<foo>());
+
+	nvobj::transaction::run(pop, [&] {
+		auto arr = al.allocate(4);
+		UT_ASSERT(pmemobj_alloc_usable_size(arr.raw()) >=
+			  4 * sizeof(foo));
+		al.deallocate(arr, 4);
+
+		auto ptr = heap_al.allocate(1);
+		UT_ASSERT(pmemobj_alloc_usable_size(ptr.raw()) >=
+			  sizeof(foo));
+		heap_al.deallocate(ptr);
+	});
+
+	/* rebound allocator shares the slab */
+	foo_allocator::rebind<char>::other char_al(al);
+	UT_ASSERT(char_al == al);
+
+	nvobj::transaction::run(pop, [&] {
+		auto ptr = char_al.allocate(32);
+		auto fptr = al.allocate(1);
+		al.deallocate(fptr);
+		char_al.deallocate(ptr, 32);
+
+		UT_ASSERT(char_al.allocate(32).raw().off == ptr.raw().off);
+		char_al.deallocate(ptr, 32);
+	});
+}
+
+/*
+ * test_concurrent -- threads allocate distinct slots
+ */
+void
+test_concurrent(nvobj::pool<root> &pop)
+{
+	static constexpr size_t concurrency = 8;
+	static constexpr size_t thread_items = 100;
+
+	auto al = make_allocator(pop);
+
+	std::vector<std::vector<nvobj::persistent_ptr<foo>>> ptrs(concurrency);
+	parallel_exec(concurrency, [&](size_t thread_id) {
+		for (size_t i = 0; i < thread_items; ++i) {
+			if (i % 2) {
+				ptrs[thread_id].push_back(al.allocate(1));
+			} else {
+				nvobj::transaction::run(pop, [&] {
+					ptrs[thread_id].push_back(
+						al.allocate(1));
+				});
+			}
+		}
+	});
+
+	std::vector<uint64_t> offs;
+	for (auto &v : ptrs)
+		for (auto &ptr : v)
+			offs.push_back(ptr.raw().off);
+
+	std::sort(offs.begin(), offs.end());
+	UT_ASSERT(std::adjacent_find(offs.begin(), offs.end()) == offs.end());
+
+	parallel_exec(concurrency, [&](size_t thread_id) {
+		for (auto &ptr : ptrs[thread_id])
+			al.deallocate(ptr);
+	});
+}
+
+/*
+ * test_reopen -- state of the slab is persistent
+ */
+void
+test_reopen(nvobj::pool<root> &pop, const char *path)
+{
+	nvobj::persistent_ptr<foo> freed;
+	{
+		auto al = make_allocator(pop);
+		freed = al.allocate(1);
+		al.deallocate(freed);
+	}
+
+	pop.close();
+	pop = nvobj::pool<root>::open(path, LAYOUT);
+
+	auto al = make_allocator(pop);
+	UT_ASSERTeq(pop.root()->pfoo->value, 5);
+
+	auto ptr = al.allocate(1);
+	UT_ASSERT(ptr == freed);
+	al.deallocate(ptr);
+
+	auto r = pop.root();
+	nvobj::transaction::run(pop, [&] {
+		al.deallocate(r->pfoo);
+		r->pfoo = nullptr;
+
+		nvobj::delete_persistent<nvobjex::slab>(r->slab);
+		r->slab = nullptr;
+	});
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	nvobj::pool<root> pop;
+
+	try {
+		pop = nvobj::pool<root>::create(path, LAYOUT,
+						PMEMOBJ_MIN_POOL * 20,
+						S_IWUSR | S_IRUSR);
+	} catch (pmem::pool_error &pe) {
+		UT_FATAL("!pool::create: %s %s", pe.what(), path);
+	}
+
+	nvobj::transaction::run(pop, [&] {
+		pop.root()->slab = nvobj::make_persistent<nvobjex::slab>(
+			sizeof(foo), slots_per_chunk);
+	});
+
+	test_alloc(pop);
+	test_abort(pop);
+	test_no_tx(pop);
+	test_fallback(pop);
+	test_concurrent(pop);
+	test_reopen(pop, path);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -304,6 +304,34 @@ struct move_insertable {
 	}
 };
 
+/**
+ *  trivially_copy_insertable_copy_assignable - helper class
+ *  Instance of that type is trivially copy constructible, but its copy
+ *  assignment operator is user-provided and marks the assigned object.
+ */
+struct trivially_copy_insertable_copy_assignable {
+	int value;
+	bool assigned;
+
+	/* emplace ctor is needed to create first object */
+	trivially_copy_insertable_copy_assignable(int val)
+	    : value(val), assigned(false)
+	{
+	}
+
+	trivially_copy_insertable_copy_assignable(
+		const trivially_copy_insertable_copy_assignable &other) =
+		default;
+
+	trivially_copy_insertable_copy_assignable &
+	operator=(const trivially_copy_insertable_copy_assignable &other)
+	{
+		value = other.value;
+		assigned = true;
+		return *this;
+	}
+};
+
 struct CompoundType {
 	int counter = 0;
 
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * concurrent_hash_map_alloc_class.cpp -- pmem::obj::concurrent_hash_map test
+ * of allocating nodes from a dedicated allocation class
+ */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/allocation_class.hpp>
+#include <libpmemobj++/container/concurrent_hash_map.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+
+#define LAYOUT "concurrent_hash_map"
+
+namespace nvobj = pmem::obj;
+
+using persistent_map_type =
+	nvobj::concurrent_hash_map<nvobj::p<int>, nvobj::p<int>>;
+
+using node_type = nvobj::concurrent_hash_map_internal::hash_map_node<
+	nvobj::p<int>, nvobj::p<int>, nvobj::shared_mutex,
+	nvobj::concurrent_hash_map_internal::shared_mutex_scoped_lock<
+		nvobj::shared_mutex>>;
+
+struct root {
+	nvobj::persistent_ptr<persistent_map_type> map;
+};
+
+static constexpr size_t concurrency = 4;
+static constexpr int thread_items = 100;
+
+namespace
+{
+/*
+ * Returns number of objects in the pool, which have exactly the usable size
+ * of the allocation class of nodes.
+ */
+size_t
+count_class_objects(nvobj::pool<root> &pop)
+{
+	auto class_size = nvobj::allocation_class<node_type>::unit_size() -
+		nvobj::allocation_class<node_type>::header_size;
+
+	size_t ret = 0;
+	for (auto oid = pmemobj_first(pop.handle()); !OID_IS_NULL(oid);
+	     oid = pmemobj_next(oid)) {
+		if (pmemobj_alloc_usable_size(oid) == class_size)
+			++ret;
+	}
+
+	return ret;
+}
+
+void
+insert(persistent_map_type &map, int begin)
+{
+	parallel_exec(concurrency, [&](size_t thread_id) {
+		int b = begin + static_cast<int>(thread_id) * thread_items;
+		for (int i = b; i < b + thread_items; ++i) {
+			persistent_map_type::value_type val(i, i);
+			UT_ASSERT(map.insert(val));
+		}
+	});
+}
+
+void
+test_alloc_class(nvobj::pool<root> &pop, const char *path)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		r->map = nvobj::make_persistent<persistent_map_type>();
+	});
+
+	UT_ASSERT(!r->map->uses_node_allocation_class());
+
+	/* nodes allocated before the option is set stay where they are */
+	r->map->insert(persistent_map_type::value_type(-1, -1));
+
+	r->map->use_node_allocation_class();
+	UT_ASSERT(r->map->uses_node_allocation_class());
+
+	insert(*r->map, 0);
+
+	auto total = static_cast<size_t>(thread_items) * concurrency;
+	UT_ASSERTeq(r->map->size(), total + 1);
+
+	UT_ASSERT(count_class_objects(pop) >= total);
+
+	/* the option is persistent */
+	pop.close();
+	pop = nvobj::pool<root>::open(path, LAYOUT);
+	r = pop.root();
+
+	r->map->runtime_initialize();
+	UT_ASSERT(r->map->uses_node_allocation_class());
+
+	insert(*r->map, static_cast<int>(total));
+	UT_ASSERTeq(r->map->size(), 2 * total + 1);
+
+	UT_ASSERT(count_class_objects(pop) >= 2 * total);
+
+	for (int i = -1; i < static_cast<int>(2 * total); ++i) {
+		persistent_map_type::const_accessor acc;
+		UT_ASSERT(r->map->find(acc, i));
+		UT_ASSERTeq(acc->second, i);
+	}
+
+	UT_ASSERT(r->map->erase(-1));
+	UT_ASSERT(r->map->erase(0));
+
+	r->map->use_node_allocation_class(false);
+	UT_ASSERT(!r->map->uses_node_allocation_class());
+
+	r->map->clear();
+	UT_ASSERTeq(count_class_objects(pop), 0);
+
+	nvobj::transaction::run(pop, [&] {
+		nvobj::delete_persistent<persistent_map_type>(r->map);
+		r->map = nullptr;
+	});
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	nvobj::pool<root> pop;
+
+	try {
+		pop = nvobj::pool<root>::create(path, LAYOUT,
+						PMEMOBJ_MIN_POOL * 20,
+						S_IWUSR | S_IRUSR);
+	} catch (pmem::pool_error &pe) {
+		UT_FATAL("!pool::create: %s %s", pe.what(), path);
+	}
+
+	test_alloc_class(pop, path);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
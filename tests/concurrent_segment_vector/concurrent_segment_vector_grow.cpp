@@ -0,0 +1,329 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * concurrent_segment_vector_grow.cpp -- tests for concurrent growth of
+ * pmem::obj::experimental::concurrent_segment_vector
+ */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/concurrent_segment_vector.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace nvobj = pmem::obj;
+
+using container_type =
+	nvobj::experimental::concurrent_segment_vector<nvobj::p<size_t>>;
+
+/* element whose copying from a negative value fails */
+struct throwing_element {
+	throwing_element() : value(0)
+	{
+	}
+
+	throwing_element(int v) : value(v)
+	{
+	}
+
+	throwing_element(const throwing_element &other);
+
+	nvobj::p<int> value;
+};
+
+using throwing_container_type =
+	nvobj::experimental::concurrent_segment_vector<throwing_element>;
+
+struct root {
+	nvobj::persistent_ptr<container_type> pptr;
+	nvobj::persistent_ptr<throwing_container_type> throwing_pptr;
+};
+
+/* set when a failing copy may throw */
+static std::atomic<bool> may_throw;
+
+throwing_element::throwing_element(const throwing_element &other)
+    : value(other.value)
+{
+	if (value >= 0)
+		return;
+
+	while (!may_throw.load())
+		std::this_thread::yield();
+
+	/* give the other thread time to wait for the elements */
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	throw std::runtime_error("construction failed");
+}
+
+static const size_t concurrency = 8;
+static const size_t num_ops = 100;
+
+/*
+ * test_push_back -- appends elements from multiple threads and checks if each
+ * of them is stored exactly once, at the position returned by push_back()
+ */
+static void
+test_push_back(nvobj::pool<struct root> &pop)
+{
+	auto v = pop.root()->pptr;
+
+	UT_ASSERT(v->empty());
+
+	parallel_exec(concurrency, [&](size_t thread_index) {
+		for (size_t i = 0; i < num_ops; ++i) {
+			auto value = thread_index * num_ops + i;
+			auto it = v->push_back(value);
+
+			UT_ASSERTeq(*it, value);
+			UT_ASSERT(v->size() > static_cast<size_t>(
+						     it - v->begin()));
+		}
+	});
+
+	UT_ASSERTeq(v->size(), concurrency * num_ops);
+
+	std::vector<size_t> values(v->cbegin(), v->cend());
+	std::sort(values.begin(), values.end());
+	for (size_t i = 0; i < values.size(); ++i)
+		UT_ASSERTeq(values[i], i);
+
+	v->clear();
+	UT_ASSERT(v->empty());
+}
+
+/*
+ * test_grow_by -- appends ranges of elements from multiple threads, while
+ * other threads read already added elements
+ */
+static void
+test_grow_by(nvobj::pool<struct root> &pop)
+{
+	auto v = pop.root()->pptr;
+
+	parallel_exec(concurrency, [&](size_t thread_index) {
+		if (thread_index % 2 == 0) {
+			for (size_t i = 0; i < num_ops; ++i) {
+				auto it = v->grow_by(thread_index + 1,
+						     thread_index);
+				auto first =
+					static_cast<size_t>(it - v->begin());
+				for (size_t j = 0; j <= thread_index; ++j)
+					UT_ASSERTeq(v->const_at(first + j),
+						    thread_index);
+			}
+		} else {
+			for (size_t i = 0; i < num_ops; ++i) {
+				auto size = v->size();
+				for (size_t j = 0; j < size; ++j)
+					UT_ASSERT(v->const_at(j) % 2 == 0);
+			}
+		}
+	});
+
+	size_t expected_size = 0;
+	for (size_t i = 0; i < concurrency; i += 2)
+		expected_size += (i + 1) * num_ops;
+
+	UT_ASSERTeq(v->size(), expected_size);
+
+	v->free_data();
+}
+
+/*
+ * test_grow_to_at_least -- checks if growth to the same size from
+ * multiple threads appends elements only once
+ */
+static void
+test_grow_to_at_least(nvobj::pool<struct root> &pop)
+{
+	auto v = pop.root()->pptr;
+
+	parallel_exec(concurrency, [&](size_t thread_index) {
+		for (size_t i = 1; i <= num_ops; ++i) {
+			auto it = v->grow_to_at_least(i, 1);
+			UT_ASSERT(it - v->begin() <= static_cast<ptrdiff_t>(i));
+			UT_ASSERT(v->size() >= i);
+		}
+	});
+
+	UT_ASSERTeq(v->size(), num_ops);
+	for (auto &e : *v)
+		UT_ASSERTeq(e, 1);
+
+	v->reserve(2 * num_ops);
+	v->grow_to_at_least(2 * num_ops);
+	UT_ASSERTeq(v->size(), 2 * num_ops);
+	UT_ASSERTeq(v->const_at(2 * num_ops - 1), 0);
+
+	v->runtime_initialize();
+	UT_ASSERTeq(v->size(), 2 * num_ops);
+
+	v->free_data();
+}
+
+/*
+ * test_failed_growth -- checks if grow_to_at_least() appends elements, which
+ * another thread reserved, but failed to construct and gave back
+ */
+static void
+test_failed_growth(nvobj::pool<struct root> &pop)
+{
+	auto v = pop.root()->throwing_pptr;
+
+	may_throw = false;
+
+	parallel_exec(2, [&](size_t thread_index) {
+		if (thread_index == 0) {
+			bool exception_thrown = false;
+			try {
+				v->grow_by(10, throwing_element(1));
+				v->grow_by(10, throwing_element(-1));
+			} catch (std::runtime_error &) {
+				exception_thrown = true;
+			}
+
+			UT_ASSERT(exception_thrown);
+		} else {
+			while (v->size() < 10)
+				std::this_thread::yield();
+
+			may_throw = true;
+			auto it = v->grow_to_at_least(15);
+			UT_ASSERT(it - v->begin() <= 15);
+		}
+	});
+
+	UT_ASSERTeq(v->size(), 15);
+	for (size_t i = 0; i < v->size(); ++i)
+		UT_ASSERTeq(v->const_at(i).value, i < 10 ? 1 : 0);
+
+	v->free_data();
+}
+
+/*
+ * test_max_size -- checks if growth past max_size() throws
+ */
+static void
+test_max_size(nvobj::pool<struct root> &pop)
+{
+	auto v = pop.root()->pptr;
+
+	v->push_back(1);
+
+	bool exception_thrown = false;
+	try {
+		v->grow_by(v->max_size());
+	} catch (std::length_error &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+
+	exception_thrown = false;
+	try {
+		v->grow_to_at_least(v->max_size() + 1);
+	} catch (std::length_error &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(v->size(), 1);
+
+	auto it = v->push_back(2);
+	UT_ASSERTeq(it - v->begin(), 1);
+	UT_ASSERTeq(v->size(), 2);
+
+	v->free_data();
+}
+
+/*
+ * test_tx_scope -- checks if growth inside a transaction throws
+ */
+static void
+test_tx_scope(nvobj::pool<struct root> &pop)
+{
+	auto v = pop.root()->pptr;
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] { v->push_back(1); });
+	} catch (pmem::transaction_scope_error &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERT(v->empty());
+
+	exception_thrown = false;
+	try {
+		v->at(0);
+	} catch (std::out_of_range &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(
+		path, "concurrent_segment_vector_grow", PMEMOBJ_MIN_POOL * 4,
+		S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->pptr = nvobj::make_persistent<container_type>();
+			r->throwing_pptr = nvobj::make_persistent<
+				throwing_container_type>();
+		});
+
+		test_push_back(pop);
+		test_grow_by(pop);
+		test_grow_to_at_least(pop);
+		test_failed_growth(pop);
+		test_max_size(pop);
+		test_tx_scope(pop);
+
+		nvobj::transaction::run(pop, [&] {
+			nvobj::delete_persistent<container_type>(r->pptr);
+			nvobj::delete_persistent<throwing_container_type>(
+				r->throwing_pptr);
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
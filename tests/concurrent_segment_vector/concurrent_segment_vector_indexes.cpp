@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * concurrent_segment_vector_indexes.cpp -- checks if concurrent growth of
+ * pmem::obj::experimental::concurrent_segment_vector neither loses nor
+ * duplicates indexes
+ */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/concurrent_segment_vector.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace nvobj = pmem::obj;
+
+namespace
+{
+
+/* identifies the thread and the call which appended the element */
+struct element {
+	element() : thread(0), call(0)
+	{
+	}
+
+	element(size_t t, size_t c) : thread(t), call(c)
+	{
+	}
+
+	nvobj::p<size_t> thread;
+	nvobj::p<size_t> call;
+};
+
+using container_type = nvobj::experimental::concurrent_segment_vector<element>;
+
+struct root {
+	nvobj::persistent_ptr<container_type> pptr;
+};
+
+static const size_t concurrency = 16;
+static const size_t num_calls = 200;
+
+/* range of indexes [first, last) appended by a call */
+using range = std::pair<size_t, size_t>;
+
+/*
+ * append -- appends elements with all growth methods and adds ranges of
+ * indexes, at which they were appended, to ranges
+ */
+void
+append(container_type &v, std::vector<std::vector<range>> &ranges)
+{
+	parallel_exec_with_sync(concurrency, [&](size_t thread) {
+		auto first_call = ranges[thread].size();
+		for (size_t call = first_call; call < first_call + num_calls;
+		     ++call) {
+			size_t count = 1;
+			container_type::iterator it;
+
+			switch (call % 3) {
+				case 0:
+					it = v.push_back(element(thread, call));
+					break;
+				case 1:
+					it = v.emplace_back(thread, call);
+					break;
+				default:
+					count = (thread + call) % 7 + 1;
+					it = v.grow_by(count,
+						       element(thread, call));
+					break;
+			}
+
+			auto first = static_cast<size_t>(it - v.begin());
+			ranges[thread].emplace_back(first, first + count);
+
+			UT_ASSERT(v.size() >= first + count);
+		}
+	});
+}
+
+/*
+ * check -- checks if the ranges cover all indexes of the container exactly
+ * once and hold elements appended by the corresponding calls
+ */
+void
+check(container_type &v, const std::vector<std::vector<range>> &ranges)
+{
+	std::vector<range> all;
+	for (size_t thread = 0; thread < ranges.size(); ++thread) {
+		for (size_t call = 0; call < ranges[thread].size(); ++call) {
+			auto &r = ranges[thread][call];
+			for (auto i = r.first; i < r.second; ++i) {
+				UT_ASSERTeq(v.const_at(i).thread, thread);
+				UT_ASSERTeq(v.const_at(i).call, call);
+			}
+
+			all.push_back(r);
+		}
+	}
+
+	std::sort(all.begin(), all.end());
+
+	size_t expected = 0;
+	for (auto &r : all) {
+		UT_ASSERTeq(r.first, expected);
+		expected = r.second;
+	}
+
+	UT_ASSERTeq(v.size(), expected);
+}
+
+/*
+ * test_indexes -- checks concurrent growth of an empty container and
+ * of a container whose size is restored after reopening the pool
+ */
+void
+test_indexes(nvobj::pool<struct root> &pop, const char *path)
+{
+	auto v = pop.root()->pptr;
+
+	std::vector<std::vector<range>> ranges(concurrency);
+
+	append(*v, ranges);
+	check(*v, ranges);
+
+	pop.close();
+	pop = nvobj::pool<root>::open(path, "concurrent_segment_vector");
+	v = pop.root()->pptr;
+
+	v->runtime_initialize();
+	check(*v, ranges);
+
+	append(*v, ranges);
+	check(*v, ranges);
+
+	/* grow_to_at_least from all threads appends each index once */
+	auto size = v->size();
+	parallel_exec_with_sync(concurrency, [&](size_t thread) {
+		for (size_t i = 1; i <= num_calls; ++i)
+			v->grow_to_at_least(size + i * concurrency / 2,
+					    element(thread, i));
+	});
+
+	UT_ASSERTeq(v->size(), size + num_calls * concurrency / 2);
+
+	v->free_data();
+	UT_ASSERT(v->empty());
+}
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "concurrent_segment_vector",
+					     PMEMOBJ_MIN_POOL * 20,
+					     S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->pptr = nvobj::make_persistent<container_type>();
+		});
+
+		test_indexes(pop, path);
+
+		r = pop.root();
+		nvobj::transaction::run(pop, [&] {
+			nvobj::delete_persistent<container_type>(r->pptr);
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ctl_arena.cpp -- pmem::obj::arena and pmem::obj::arena_per_thread test
+ */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/arena.hpp>
+#include <libpmemobj++/container/concurrent_hash_map.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <mutex>
+#include <set>
+
+#define LAYOUT "cpp"
+
+namespace nvobj = pmem::obj;
+
+namespace
+{
+struct foo {
+	char data[256];
+};
+
+static constexpr size_t concurrency = 8;
+
+using persistent_map_type =
+	nvobj::concurrent_hash_map<nvobj::p<int>, nvobj::p<int>>;
+
+struct root {
+	nvobj::persistent_ptr<foo> ptrs[concurrency];
+	nvobj::persistent_ptr<persistent_map_type> map;
+};
+
+void
+alloc(nvobj::pool<root> &pop, size_t i)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(
+		pop, [&] { r->ptrs[i] = nvobj::make_persistent<foo>(); });
+}
+
+void
+test_arena(nvobj::pool<root> &pop)
+{
+	auto total = nvobj::arena::count(pop);
+	UT_ASSERT(total > 0);
+	UT_ASSERT(nvobj::arena::automatic_count(pop) <= total);
+
+	auto a = nvobj::arena::create(pop);
+	UT_ASSERTeq(nvobj::arena::count(pop), total + 1);
+	UT_ASSERTeq(a.size(), 0);
+
+	a.automatic(false);
+	UT_ASSERT(!a.automatic());
+
+	auto prev = nvobj::arena::current(pop);
+	{
+		nvobj::arena::scoped_binding binding(a);
+		UT_ASSERTeq(nvobj::arena::current(pop).id(), a.id());
+
+		alloc(pop, 0);
+		UT_ASSERT(a.size() >= sizeof(foo));
+	}
+	UT_ASSERTeq(nvobj::arena::current(pop).id(), prev.id());
+
+	auto size = a.size();
+	alloc(pop, 1);
+	UT_ASSERTeq(a.size(), size);
+
+	try {
+		nvobj::arena(pop, total + 100).bind();
+		UT_ASSERT(0);
+	} catch (pmem::ctl_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+}
+
+void
+test_arena_per_thread(nvobj::pool<root> &pop)
+{
+	std::mutex mtx;
+	std::set<unsigned> ids;
+
+	parallel_exec_with_sync(concurrency, [&](size_t thread_id) {
+		nvobj::arena_per_thread::bind(pop);
+
+		auto a = nvobj::arena::current(pop);
+		UT_ASSERTeq(a.id(), nvobj::arena_per_thread::get(pop).id());
+
+		/* binding is cached */
+		nvobj::arena_per_thread::bind(pop);
+		UT_ASSERTeq(nvobj::arena::current(pop).id(), a.id());
+
+		alloc(pop, thread_id);
+		UT_ASSERT(a.size() >= sizeof(foo));
+
+		std::unique_lock<std::mutex> lock(mtx);
+		ids.insert(a.id());
+	});
+
+	/* every thread had its own arena */
+	UT_ASSERTeq(ids.size(), concurrency);
+
+	/* arenas are reused by new threads */
+	auto total = nvobj::arena::count(pop);
+	parallel_exec_with_sync(concurrency, [&](size_t) {
+		nvobj::arena_per_thread::bind(pop);
+	});
+	UT_ASSERTeq(nvobj::arena::count(pop), total);
+}
+
+/*
+ * test_hash_map -- inserting threads are bound to their own arenas
+ */
+void
+test_hash_map(nvobj::pool<root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		r->map = nvobj::make_persistent<persistent_map_type>();
+	});
+
+	UT_ASSERT(!r->map->uses_thread_arenas());
+	r->map->use_thread_arenas();
+	UT_ASSERT(r->map->uses_thread_arenas());
+
+	auto total = nvobj::arena::count(pop);
+	std::mutex mtx;
+	std::set<unsigned> ids;
+
+	parallel_exec_with_sync(concurrency, [&](size_t thread_id) {
+		for (int i = 0; i < 100; ++i) {
+			persistent_map_type::value_type val(
+				static_cast<int>(thread_id) * 100 + i, i);
+			UT_ASSERT(r->map->insert(val));
+		}
+
+		auto a = nvobj::arena::current(pop);
+		UT_ASSERTeq(a.id(), nvobj::arena_per_thread::get(pop).id());
+
+		std::unique_lock<std::mutex> lock(mtx);
+		ids.insert(a.id());
+	});
+
+	UT_ASSERTeq(ids.size(), concurrency);
+	UT_ASSERTeq(nvobj::arena::count(pop), total);
+	UT_ASSERTeq(r->map->size(), concurrency * 100);
+
+	r->map->use_thread_arenas(false);
+	UT_ASSERT(!r->map->uses_thread_arenas());
+
+	r->map->clear();
+	nvobj::transaction::run(pop, [&] {
+		nvobj::delete_persistent<persistent_map_type>(r->map);
+		r->map = nullptr;
+	});
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, LAYOUT, PMEMOBJ_MIN_POOL * 20,
+					     S_IWUSR | S_IRUSR);
+
+	test_arena(pop);
+	test_arena_per_thread(pop);
+	test_hash_map(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
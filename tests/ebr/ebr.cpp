@@ -120,8 +120,43 @@ test_ebr()
 		});
 }
 
+/* Register more workers than fits into a single block of slots */
+static void
+test_register()
+{
+	const size_t threads = 80;
+	pmem::detail::ebr ebr;
+
+	parallel_xexec(threads,
+		       [&](size_t id, std::function<void(void)> syncthreads) {
+			       auto w = ebr.register_worker();
+
+			       try {
+				       ebr.register_worker();
+				       ASSERT_UNREACHABLE;
+			       } catch (std::runtime_error &) {
+			       } catch (...) {
+				       ASSERT_UNREACHABLE;
+			       }
+
+			       syncthreads();
+
+			       w.critical([&] { ebr.sync(); });
+		       });
+
+	/* All workers are unregistered */
+	ebr.full_sync();
+
+	auto w = ebr.register_worker();
+	auto moved = std::move(w);
+	moved.critical([&] { UT_ASSERT(ebr.sync()); });
+}
+
 int
 main(int argc, char *argv[])
 {
-	return run_test([&] { test_ebr(); });
+	return run_test([&] {
+		test_ebr();
+		test_register();
+	});
 }
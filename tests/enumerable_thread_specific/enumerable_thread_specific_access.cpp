@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2019-2020, Intel Corporation */
+/* Copyright 2019-2021, Intel Corporation */
 
 #include "unittest.hpp"
 
@@ -190,6 +190,90 @@ test_multiple_tls(nvobj::pool<struct root> &pop)
 	}
 }
 
+/* local() called repeatedly by the same thread, interleaved with clear() and
+ * accesses to other object */
+void
+test_local_cache(nvobj::pool<struct root> &pop)
+{
+	auto tls1 = pop.root()->m_pptr1;
+	auto tls2 = pop.root()->m_pptr2;
+
+	tls1->clear();
+	tls2->clear();
+
+	tls1->local() = 1;
+	tls2->local() = 2;
+
+	UT_ASSERTeq(&tls1->local(), &tls1->local());
+	UT_ASSERTeq(tls1->local(), 1);
+	UT_ASSERTeq(tls2->local(), 2);
+	UT_ASSERTeq(tls1->local(), 1);
+
+	tls1->clear();
+	UT_ASSERT(tls1->empty());
+
+	UT_ASSERTeq(tls1->local(), 0);
+	UT_ASSERT(!tls1->empty());
+	UT_ASSERTeq(tls2->local(), 2);
+
+	tls1->clear();
+	tls2->clear();
+}
+
+/* local() called alternately on two objects by several threads, clearing one
+ * of them does not affect references cached for the other one */
+void
+test_alternating_tls(nvobj::pool<struct root> &pop)
+{
+	const size_t concurrency = 16;
+
+	auto tls1 = pop.root()->m_pptr1;
+	auto tls2 = pop.root()->m_pptr2;
+
+	tls1->clear();
+	tls2->clear();
+
+	parallel_exec_with_sync(concurrency, [&](size_t thread_index) {
+		test_t &ref1 = tls1->local();
+		test_t &ref2 = tls2->local();
+
+		ref1 = thread_index;
+		pop.persist(&ref1, sizeof(ref1));
+		ref2 = thread_index + concurrency;
+		pop.persist(&ref2, sizeof(ref2));
+
+		for (size_t i = 0; i < 100; ++i) {
+			UT_ASSERTeq(&tls1->local(), &ref1);
+			UT_ASSERTeq(&tls2->local(), &ref2);
+			UT_ASSERTeq(tls1->local(), thread_index);
+			UT_ASSERTeq(tls2->local(), thread_index + concurrency);
+		}
+	});
+
+	tls1->clear();
+	UT_ASSERT(tls1->empty());
+
+	{
+		std::set<size_t> values;
+		for (auto &e : *tls2)
+			values.insert(e);
+
+		for (size_t id = 0; id < concurrency; id++)
+			UT_ASSERT(values.count(id + concurrency) == 1);
+	}
+
+	test_t &ref2 = tls2->local();
+	for (size_t i = 0; i < 100; ++i) {
+		UT_ASSERTeq(tls1->local(), i);
+		UT_ASSERTeq(&tls2->local(), &ref2);
+		tls1->local()++;
+		pop.persist(&tls1->local(), sizeof(tls1->local()));
+	}
+
+	tls1->clear();
+	tls2->clear();
+}
+
 static void
 test(int argc, char *argv[])
 {
@@ -224,6 +308,9 @@ test(int argc, char *argv[])
 			test_with_spin(pop, 2048);
 		}
 
+		test_local_cache(pop);
+		test_alternating_tls(pop);
+
 		nvobj::transaction::run(pop, [&] {
 			nvobj::delete_persistent<container_type>(r->pptr);
 			nvobj::delete_persistent<container_type>(r->m_pptr1);
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/group_commit.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace nvobj = pmem::obj;
+namespace nvobje = pmem::obj::experimental;
+
+static constexpr size_t concurrency = 8;
+static constexpr size_t updates = 200;
+
+struct root {
+	nvobj::p<size_t> counter;
+	nvobj::p<size_t> values[concurrency];
+};
+
+namespace
+{
+void
+test_counter(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	{
+		nvobje::group_commit gc(pop);
+
+		parallel_exec(concurrency, [&](size_t tid) {
+			std::vector<std::future<void>> futures;
+			for (size_t i = 0; i < updates; ++i) {
+				futures.emplace_back(gc.submit([&, tid] {
+					r->counter = r->counter + 1;
+					r->values[tid] = r->values[tid] + 1;
+				}));
+			}
+
+			for (auto &f : futures)
+				f.get();
+
+			UT_ASSERTeq(r->values[tid], updates);
+		});
+	}
+
+	UT_ASSERTeq(r->counter, concurrency * updates);
+}
+
+/*
+ * Updates are executed in one transaction once the batch is full.
+ */
+void
+test_batch(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	size_t in_tx = 0;
+	std::vector<size_t> observed;
+
+	nvobje::group_commit gc(pop, 4, std::chrono::seconds(60));
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 0; i < 4; ++i) {
+		futures.emplace_back(gc.submit([&] {
+			observed.push_back(++in_tx);
+			nvobj::transaction::register_callback(
+				nvobj::transaction::stage::finally,
+				[&] { in_tx = 0; });
+
+			r->counter = r->counter + 1;
+		}));
+	}
+
+	for (auto &f : futures)
+		f.get();
+
+	UT_ASSERTeq(observed.size(), 4);
+	for (size_t i = 0; i < 4; ++i)
+		UT_ASSERTeq(observed[i], i + 1);
+	UT_ASSERTeq(r->counter, concurrency * updates + 4);
+}
+
+/*
+ * A failing update does not affect other updates from its batch.
+ */
+void
+test_exception(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto counter = r->counter.get_ro();
+
+	nvobje::group_commit gc(pop, 4, std::chrono::seconds(60));
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 0; i < 4; ++i) {
+		futures.emplace_back(gc.submit([&, i] {
+			r->counter = r->counter + 1;
+
+			if (i == 1)
+				throw std::runtime_error("update");
+			if (i == 2)
+				nvobj::transaction::abort(EINVAL);
+		}));
+	}
+
+	futures[0].get();
+	futures[3].get();
+
+	try {
+		futures[1].get();
+		UT_ASSERT(0);
+	} catch (std::runtime_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	try {
+		futures[2].get();
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(r->counter, counter + 2);
+}
+
+/*
+ * Queued updates are executed by the destructor.
+ */
+void
+test_destructor(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto counter = r->counter.get_ro();
+
+	std::future<void> future;
+	{
+		nvobje::group_commit gc(pop, 64, std::chrono::seconds(60));
+		future = gc.submit([&] { r->counter = r->counter + 1; });
+	}
+
+	UT_ASSERT(future.wait_for(std::chrono::seconds(0)) ==
+		  std::future_status::ready);
+	future.get();
+
+	UT_ASSERTeq(r->counter, counter + 1);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "group_commit",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	test_counter(pop);
+	test_batch(pop);
+	test_exception(pop);
+	test_destructor(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * allocation_class.cpp -- pmem::obj::allocation_class test
+ */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/allocation_class.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/make_persistent_atomic.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <string>
+
+#define LAYOUT "cpp"
+
+namespace nvobj = pmem::obj;
+
+namespace
+{
+struct node {
+	nvobj::p<int> value;
+	char data[44];
+};
+
+/* same size as node */
+struct other_node {
+	char data[48];
+};
+
+struct alignas(64) aligned_node {
+	char data[100];
+};
+
+static_assert(nvobj::allocation_class<node>::unit_size() == 64, "");
+static_assert(nvobj::allocation_class<node>::alignment() == 0, "");
+static_assert(nvobj::allocation_class<node>::units_per_block() == 1024, "");
+static_assert(nvobj::allocation_class<aligned_node>::unit_size() == 192, "");
+static_assert(nvobj::allocation_class<aligned_node>::alignment() == 64, "");
+
+struct root {
+	nvobj::persistent_ptr<node> pnode;
+	nvobj::persistent_ptr<aligned_node> paligned;
+};
+
+pobj_alloc_class_desc
+get_desc(nvobj::pool_base &pop, unsigned id)
+{
+	pobj_alloc_class_desc desc;
+	auto name = "heap.alloc_class." + std::to_string(id) + ".desc";
+
+	int ret = pmemobj_ctl_get(pop.handle(), name.c_str(), &desc);
+	UT_ASSERTeq(ret, 0);
+
+	return desc;
+}
+
+/*
+ * test_register -- classes are registered once per unit size and alignment
+ */
+void
+test_register(nvobj::pool<struct root> &pop)
+{
+	auto id = nvobj::allocation_class<node>::id(pop);
+
+	UT_ASSERTeq(nvobj::allocation_class<node>::id(pop), id);
+	UT_ASSERTeq(nvobj::allocation_class<other_node>::id(pop), id);
+	UT_ASSERT(nvobj::allocation_class<aligned_node>::id(pop) != id);
+
+	auto desc = get_desc(pop, id);
+	UT_ASSERTeq(desc.unit_size, nvobj::allocation_class<node>::unit_size());
+	UT_ASSERTeq(desc.header_type, POBJ_HEADER_COMPACT);
+
+	/* all threads see the same class */
+	parallel_exec(8, [&](size_t) {
+		UT_ASSERTeq(nvobj::allocation_class<node>::id(pop), id);
+	});
+}
+
+/*
+ * test_alloc -- objects allocated from the class have no rounding overhead
+ */
+void
+test_alloc(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		r->pnode = nvobj::make_persistent<node>(
+			nvobj::allocation_class<node>::flag(pop));
+		r->paligned = nvobj::make_persistent<aligned_node>(
+			nvobj::allocation_class<aligned_node>::flag(pop));
+	});
+
+	UT_ASSERTeq(pmemobj_alloc_usable_size(r->pnode.raw()), sizeof(node));
+	UT_ASSERT(pmemobj_alloc_usable_size(r->paligned.raw()) >=
+		  sizeof(aligned_node));
+
+	nvobj::transaction::run(pop, [&] {
+		nvobj::delete_persistent<node>(r->pnode);
+		nvobj::delete_persistent<aligned_node>(r->paligned);
+		r->pnode = nullptr;
+		r->paligned = nullptr;
+	});
+
+	nvobj::make_persistent_atomic<node>(
+		pop, r->pnode, nvobj::allocation_class<node>::flag_atomic(pop));
+
+	UT_ASSERTeq(pmemobj_alloc_usable_size(r->pnode.raw()), sizeof(node));
+
+	nvobj::delete_persistent_atomic<node>(r->pnode);
+}
+
+/*
+ * test_reopen -- classes are registered again in a reopened pool
+ */
+void
+test_reopen(nvobj::pool<struct root> &pop, const char *path)
+{
+	pop.close();
+	pop = nvobj::pool<root>::open(path, LAYOUT);
+
+	auto id = nvobj::allocation_class<node>::id(pop);
+	UT_ASSERTeq(get_desc(pop, id).unit_size,
+		    nvobj::allocation_class<node>::unit_size());
+
+	auto r = pop.root();
+	nvobj::transaction::run(pop, [&] {
+		r->pnode = nvobj::make_persistent<node>(
+			nvobj::allocation_class<node>::flag(pop));
+		nvobj::delete_persistent<node>(r->pnode);
+		r->pnode = nullptr;
+	});
+}
+
+/*
+ * test_foreign_pool -- pool not opened by libpmemobj-cpp is rejected
+ */
+void
+test_foreign_pool(const char *path)
+{
+	auto *handle = pmemobj_open(path, LAYOUT);
+	UT_ASSERT(handle != nullptr);
+
+	nvobj::pool_base pop(handle);
+
+	try {
+		(void)nvobj::allocation_class<node>::id(pop);
+		UT_ASSERT(0);
+	} catch (pmem::pool_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	pmemobj_close(handle);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	nvobj::pool<struct root> pop;
+
+	try {
+		pop = nvobj::pool<root>::create(path, LAYOUT, PMEMOBJ_MIN_POOL,
+						S_IWUSR | S_IRUSR);
+	} catch (pmem::pool_error &pe) {
+		UT_FATAL("!pool::create: %s %s", pe.what(), path);
+	}
+
+	test_register(pop);
+	test_alloc(pop);
+	test_reopen(pop, path);
+
+	pop.close();
+
+	test_foreign_pool(path);
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -314,6 +314,83 @@ test_random(void)
 	delete r;
 }
 
+static void
+test_lanes(void)
+{
+	ringbuf_lanes_t *r = new ringbuf_lanes_t(MAX_WORKERS, 2, 10);
+	ringbuf_worker_t *w1, *w2;
+	size_t len, woff;
+	ptrdiff_t off;
+
+	w1 = ringbuf_lanes_register(r, 0);
+	w2 = ringbuf_lanes_register(r, 1);
+
+	/*
+	 * Each producer acquires space in its own lane.
+	 */
+	off = ringbuf_lanes_acquire(r, w1, 3);
+	UT_ASSERT(off == 0);
+
+	off = ringbuf_lanes_acquire(r, w2, 3);
+	UT_ASSERT(off == 5);
+
+	len = ringbuf_lanes_consume(r, &woff);
+	UT_ASSERT(len == 0);
+
+	/*
+	 * Producer 2 commits first. Consumer is not blocked by producer 1.
+	 */
+	ringbuf_lanes_produce(r, w2);
+	len = ringbuf_lanes_consume(r, &woff);
+	UT_ASSERT(len == 3 && woff == 5);
+	ringbuf_lanes_release(r, len);
+
+	ringbuf_lanes_produce(r, w1);
+	len = ringbuf_lanes_consume(r, &woff);
+	UT_ASSERT(len == 3 && woff == 0);
+	ringbuf_lanes_release(r, len);
+
+	/*
+	 * Lane of producer 1 is not affected by producer 2 filling its lane.
+	 */
+	off = ringbuf_lanes_acquire(r, w2, 4);
+	UT_ASSERT(off == -1);
+
+	off = ringbuf_lanes_acquire(r, w2, 2);
+	UT_ASSERT(off == 8);
+	ringbuf_lanes_produce(r, w2);
+
+	off = ringbuf_lanes_acquire(r, w1, 1);
+	UT_ASSERT(off == 3);
+	ringbuf_lanes_produce(r, w1);
+
+	/*
+	 * Consumer alternates between lanes.
+	 */
+	len = ringbuf_lanes_consume(r, &woff);
+	UT_ASSERT(len == 2 && woff == 8);
+	ringbuf_lanes_release(r, len);
+
+	len = ringbuf_lanes_consume(r, &woff);
+	UT_ASSERT(len == 1 && woff == 3);
+	ringbuf_lanes_release(r, len);
+
+	len = ringbuf_lanes_consume(r, &woff);
+	UT_ASSERT(len == 0);
+
+	ringbuf_lanes_unregister(r, w1);
+	ringbuf_lanes_unregister(r, w2);
+	delete r;
+
+	try {
+		r = new ringbuf_lanes_t(MAX_WORKERS, 0, 10);
+		ASSERT_UNREACHABLE;
+	} catch (std::invalid_argument &) {
+	} catch (...) {
+		ASSERT_UNREACHABLE;
+	}
+}
+
 static void
 test_size()
 {
@@ -342,6 +419,7 @@ main(void)
 	test_multi();
 	test_overlap();
 	test_random();
+	test_lanes();
 	test_size();
 	return 0;
 }
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * segments.cpp -- Tests for chained log segments of
+ * pmem::obj::experimental::mpsc_queue
+ */
+
+#include "unittest.hpp"
+
+#include <string>
+#include <vector>
+
+#include <libpmemobj++/experimental/mpsc_queue.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/string_view.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#define LAYOUT "layout"
+
+using queue_type = pmem::obj::experimental::mpsc_queue;
+
+static constexpr size_t QUEUE_SIZE = 1024;
+static constexpr size_t MAX_SEGMENTS = 2;
+
+struct root {
+	pmem::obj::persistent_ptr<queue_type::pmem_log_type> log;
+	pmem::obj::persistent_ptr<queue_type::pmem_segments_type> segments;
+};
+
+static std::string
+make_value(size_t i)
+{
+	return std::to_string(i) + std::string(100, 'x');
+}
+
+static size_t
+produce_until_full(queue_type::worker &worker, size_t first)
+{
+	size_t i = first;
+	while (worker.try_produce(make_value(i)))
+		i++;
+
+	return i - first;
+}
+
+static std::vector<std::string>
+consume_all(queue_type &queue)
+{
+	std::vector<std::string> values_on_pmem;
+	while (queue.try_consume_batch([&](queue_type::batch_type acc) {
+		for (const auto &entry : acc)
+			values_on_pmem.emplace_back(entry.data(), entry.size());
+	}))
+		;
+
+	return values_on_pmem;
+}
+
+static void
+check_values(const std::vector<std::string> &values, size_t first)
+{
+	for (size_t i = 0; i < values.size(); i++)
+		UT_ASSERT(values[i] == make_value(first + i));
+}
+
+/* Each value occupies 2 cachelines. Log with MAX_SEGMENTS segments must be
+ * able to store more than MAX_SEGMENTS logs without segments. */
+static void
+check_capacity(size_t produced)
+{
+	UT_ASSERT(produced * pmem::detail::CACHELINE_SIZE * 2 >
+		  QUEUE_SIZE * MAX_SEGMENTS);
+}
+
+/* Produce more data than fits into the log, consume it and recover */
+static void
+segments_test(pmem::obj::pool<root> pop, bool create)
+{
+	auto proot = pop.root();
+
+	auto queue =
+		queue_type(*proot->log, 1, *proot->segments, MAX_SEGMENTS);
+
+	auto worker = queue.register_worker();
+
+	if (create) {
+		auto ret = queue.try_consume_batch(
+			[&](queue_type::batch_type acc) {
+				ASSERT_UNREACHABLE;
+			});
+		UT_ASSERT(!ret);
+
+		/* Elements which do not fit into the log are stored in
+		 * segments, until MAX_SEGMENTS are allocated. */
+		auto produced = produce_until_full(worker, 0);
+		check_capacity(produced);
+
+		auto values = consume_all(queue);
+		UT_ASSERTeq(values.size(), produced);
+		check_values(values, 0);
+
+		/* Segments are freed after consumption, so the log can grow
+		 * again. */
+		auto produced_again = produce_until_full(worker, produced);
+		check_capacity(produced_again);
+
+		values = consume_all(queue);
+		UT_ASSERTeq(values.size(), produced_again);
+		check_values(values, produced);
+
+		/* Leave data in the log and in segments for the next run */
+		check_capacity(produce_until_full(worker, 0));
+	} else {
+		/* Recover the data in second run of application */
+		auto values = consume_all(queue);
+		check_capacity(values.size());
+		check_values(values, 0);
+
+		check_capacity(produce_until_full(worker, 0));
+
+		/* Segments are freed together with the segments object */
+		pmem::obj::transaction::run(pop, [&] {
+			pmem::obj::delete_persistent<queue_type::pmem_log_type>(
+				proot->log);
+			pmem::obj::delete_persistent<
+				queue_type::pmem_segments_type>(
+				proot->segments);
+			proot->log = nullptr;
+			proot->segments = nullptr;
+		});
+	}
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name create", argv[0]);
+
+	const char *path = argv[1];
+	bool create = std::string(argv[2]) == "1";
+
+	pmem::obj::pool<struct root> pop;
+
+	if (create) {
+		pop = pmem::obj::pool<root>::create(std::string(path), LAYOUT,
+						    PMEMOBJ_MIN_POOL,
+						    S_IWUSR | S_IRUSR);
+
+		pmem::obj::transaction::run(pop, [&] {
+			pop.root()->log = pmem::obj::make_persistent<
+				queue_type::pmem_log_type>(QUEUE_SIZE);
+			pop.root()->segments = pmem::obj::make_persistent<
+				queue_type::pmem_segments_type>();
+		});
+	} else {
+		pop = pmem::obj::pool<root>::open(std::string(path), LAYOUT);
+	}
+
+	segments_test(pop, create);
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
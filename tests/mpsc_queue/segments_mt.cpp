@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * segments_mt.cpp -- Multithreaded tests for log segments of
+ * pmem::obj::experimental::mpsc_queue
+ */
+
+#include "unittest.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <libpmemobj++/experimental/mpsc_queue.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/string_view.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#define LAYOUT "layout"
+
+using queue_type = pmem::obj::experimental::mpsc_queue;
+
+static constexpr size_t QUEUE_SIZE = 1024;
+static constexpr size_t MAX_SEGMENTS = 8;
+
+struct root {
+	pmem::obj::persistent_ptr<queue_type::pmem_log_type> log;
+	pmem::obj::persistent_ptr<queue_type::pmem_segments_type> segments;
+};
+
+/* Each value occupies 2 cachelines */
+static std::string
+make_value(size_t thread, size_t i)
+{
+	auto prefix = std::to_string(thread) + ":" + std::to_string(i) + ":";
+	return prefix + std::string(100 - prefix.size(), 'x');
+}
+
+/*
+ * check_values -- checks if values produced by each thread were consumed
+ * exactly once and in the order they were produced
+ */
+static void
+check_values(const std::vector<std::string> &values,
+	     const std::vector<size_t> &produced)
+{
+	std::vector<size_t> next(produced.size(), 0);
+
+	for (auto &v : values) {
+		auto thread = std::stoul(v.substr(0, v.find(':')));
+		UT_ASSERT(thread < produced.size());
+		UT_ASSERT(v == make_value(thread, next[thread]));
+		next[thread]++;
+	}
+
+	for (size_t t = 0; t < produced.size(); t++)
+		UT_ASSERTeq(next[t], produced[t]);
+}
+
+static void
+consume(queue_type &queue, std::vector<std::string> &values)
+{
+	while (queue.try_consume_batch([&](queue_type::batch_type acc) {
+		for (const auto &entry : acc)
+			values.emplace_back(entry.data(), entry.size());
+	}))
+		;
+}
+
+/*
+ * fill_test -- producers fill the log and all segments concurrently, then
+ * the consumer consumes all values
+ */
+static void
+fill_test(queue_type &queue, size_t concurrency)
+{
+	std::vector<size_t> produced(concurrency, 0);
+
+	parallel_exec_with_sync(concurrency, [&](size_t thread) {
+		auto worker = queue.register_worker();
+		while (worker.try_produce(make_value(thread, produced[thread])))
+			produced[thread]++;
+	});
+
+	/* Values span the log and several segments */
+	size_t total = 0;
+	for (auto p : produced)
+		total += p;
+	UT_ASSERT(total * pmem::detail::CACHELINE_SIZE * 2 > QUEUE_SIZE * 3);
+
+	std::vector<std::string> values;
+	consume(queue, values);
+	UT_ASSERTeq(values.size(), total);
+	check_values(values, produced);
+}
+
+/*
+ * produce_consume_test -- producers produce values concurrently with the
+ * consumer, retrying when the log and all segments are full
+ */
+static void
+produce_consume_test(queue_type &queue, size_t concurrency, size_t count)
+{
+	std::vector<size_t> produced(concurrency, count);
+	std::vector<std::string> values;
+
+	std::atomic<size_t> threads_counter(concurrency);
+#if LIBPMEMOBJ_CPP_VG_HELGRIND_ENABLED
+	VALGRIND_HG_DISABLE_CHECKING(&threads_counter, sizeof(threads_counter));
+#endif
+
+	parallel_exec_with_sync(concurrency + 1, [&](size_t thread_id) {
+		if (thread_id == concurrency) {
+			while (threads_counter.load() > 0)
+				consume(queue, values);
+
+			consume(queue, values);
+		} else {
+			auto worker = queue.register_worker();
+			for (size_t i = 0; i < count; i++) {
+				while (!worker.try_produce(
+					make_value(thread_id, i)))
+					;
+			}
+
+			threads_counter--;
+		}
+	});
+
+	UT_ASSERTeq(values.size(), concurrency * count);
+	check_values(values, produced);
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	size_t concurrency = 8;
+	size_t count = 200;
+	if (On_valgrind) {
+		concurrency = 2;
+		count = 50;
+	}
+
+	auto pop = pmem::obj::pool<root>::create(
+		std::string(path), LAYOUT, PMEMOBJ_MIN_POOL, S_IWUSR | S_IRUSR);
+	auto proot = pop.root();
+
+	pmem::obj::transaction::run(pop, [&] {
+		proot->log =
+			pmem::obj::make_persistent<queue_type::pmem_log_type>(
+				QUEUE_SIZE);
+		proot->segments = pmem::obj::make_persistent<
+			queue_type::pmem_segments_type>();
+	});
+
+	{
+		auto queue = queue_type(*proot->log, concurrency,
+					*proot->segments, MAX_SEGMENTS);
+
+		auto ret = queue.try_consume_batch(
+			[&](queue_type::batch_type acc) {
+				ASSERT_UNREACHABLE;
+			});
+		UT_ASSERT(!ret);
+
+		fill_test(queue, concurrency);
+		produce_consume_test(queue, concurrency, count);
+		fill_test(queue, concurrency);
+	}
+
+	pmem::obj::transaction::run(pop, [&] {
+		pmem::obj::delete_persistent<queue_type::pmem_log_type>(
+			proot->log);
+		pmem::obj::delete_persistent<queue_type::pmem_segments_type>(
+			proot->segments);
+	});
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mutex_pool_cache.cpp -- test of locks from multiple pools, which are
+ * resolved by the cached pool lookup
+ */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/condition_variable.hpp>
+#include <libpmemobj++/detail/pool_by_ptr.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/mutex.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/shared_mutex.hpp>
+#include <libpmemobj++/timed_mutex.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#define LAYOUT "cpp"
+
+namespace nvobj = pmem::obj;
+
+namespace
+{
+
+struct locks {
+	nvobj::mutex pmutex;
+	nvobj::shared_mutex pshared_mutex;
+	nvobj::timed_mutex ptimed_mutex;
+	nvobj::condition_variable pcond;
+	unsigned counter;
+};
+
+/* pool root structure */
+struct root {
+	locks root_locks;
+	nvobj::persistent_ptr<locks> other_locks;
+};
+
+/* number of ops per thread */
+const unsigned num_ops = 200;
+
+/* the number of threads */
+const unsigned num_threads = 8;
+
+/*
+ * check_lookup -- (internal) cached lookup returns the same pool as
+ * pmemobj_pool_by_ptr
+ */
+void
+check_lookup(const void *ptr)
+{
+	UT_ASSERTeq(pmem::detail::pool_by_ptr(ptr), pmemobj_pool_by_ptr(ptr));
+}
+
+/*
+ * increment -- (internal) increment the counter under all kinds of locks
+ */
+void
+increment(locks &l)
+{
+	{
+		std::lock_guard<nvobj::mutex> lock(l.pmutex);
+		++l.counter;
+	}
+	{
+		std::lock_guard<nvobj::shared_mutex> lock(l.pshared_mutex);
+		++l.counter;
+	}
+	{
+		std::unique_lock<nvobj::timed_mutex> lock(
+			l.ptimed_mutex, std::chrono::milliseconds(100));
+		UT_ASSERT(lock.owns_lock());
+		++l.counter;
+	}
+	{
+		std::unique_lock<nvobj::mutex> lock(l.pmutex);
+		l.pcond.notify_all();
+		UT_ASSERT(!l.pcond.wait_for(lock, std::chrono::milliseconds(0),
+					    [] { return false; }));
+	}
+}
+
+/*
+ * init -- (internal) allocate locks outside of the root object
+ */
+void
+init(nvobj::pool<root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		r->other_locks = nvobj::make_persistent<locks>();
+	});
+}
+
+/*
+ * test_pools -- (internal) use locks of several pools from several threads
+ */
+void
+test_pools(nvobj::pool<root> &pop1, nvobj::pool<root> &pop2)
+{
+	auto r1 = pop1.root();
+	auto r2 = pop2.root();
+
+	locks *all[] = {&r1->root_locks, r1->other_locks.get(),
+			&r2->root_locks, r2->other_locks.get()};
+
+	for (auto l : all)
+		l->counter = 0;
+
+	parallel_exec(num_threads, [&](size_t) {
+		for (unsigned i = 0; i < num_ops; ++i) {
+			for (auto l : all) {
+				check_lookup(&l->pmutex);
+				check_lookup(&l->pcond);
+				increment(*l);
+			}
+		}
+	});
+
+	for (auto l : all)
+		UT_ASSERTeq(l->counter, 3 * num_ops * num_threads);
+
+	int on_stack;
+	check_lookup(&on_stack);
+	check_lookup(r1.get());
+	check_lookup(r2.get());
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	std::string path1 = std::string(argv[1]) + "_1";
+	std::string path2 = std::string(argv[1]) + "_2";
+
+	nvobj::pool<root> pop1, pop2;
+
+	try {
+		pop1 = nvobj::pool<root>::create(path1, LAYOUT,
+						 PMEMOBJ_MIN_POOL,
+						 S_IWUSR | S_IRUSR);
+		pop2 = nvobj::pool<root>::create(path2, LAYOUT,
+						 PMEMOBJ_MIN_POOL,
+						 S_IWUSR | S_IRUSR);
+	} catch (pmem::pool_error &pe) {
+		UT_FATAL("!pool::create: %s %s", pe.what(), argv[1]);
+	}
+
+	init(pop1);
+	init(pop2);
+
+	test_pools(pop1, pop2);
+
+	/* pools may be mapped at different addresses after reopening */
+	pop1.close();
+	pop2.close();
+
+	pop2 = nvobj::pool<root>::open(path2, LAYOUT);
+	pop1 = nvobj::pool<root>::open(path1, LAYOUT);
+
+	test_pools(pop1, pop2);
+
+	pop1.close();
+	pop2.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
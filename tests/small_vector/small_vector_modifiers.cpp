@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * small_vector_modifiers.cpp -- tests for pmem::obj::small_vector modifiers,
+ * which move elements between the inline buffer and the heap
+ */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/container/small_vector.hpp>
+#include <libpmemobj++/container/string.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <vector>
+
+namespace nvobj = pmem::obj;
+
+static constexpr size_t N = 4;
+
+using C = nvobj::small_vector<int, N>;
+using S = nvobj::small_vector<nvobj::string, N>;
+
+struct root {
+	nvobj::persistent_ptr<C> v1;
+	nvobj::persistent_ptr<C> v2;
+	nvobj::persistent_ptr<S> s;
+	nvobj::persistent_ptr<S> s_other;
+};
+
+static void
+check_sequence(const C &v, size_t count)
+{
+	UT_ASSERTeq(v.size(), count);
+
+	for (size_t i = 0; i < count; ++i)
+		UT_ASSERTeq(v.const_at(i), static_cast<int>(i));
+}
+
+/*
+ * test_push_pop -- checks if elements are moved to the heap when the inline
+ * buffer is full and back to the inline buffer by shrink_to_fit()
+ */
+static void
+test_push_pop(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v1;
+
+	UT_ASSERT(v.empty());
+	UT_ASSERTeq(v.capacity(), N);
+
+	for (int i = 0; i < static_cast<int>(N); ++i)
+		v.push_back(i);
+
+	check_sequence(v, N);
+	UT_ASSERTeq(v.capacity(), N);
+
+	v.push_back(static_cast<int>(N));
+	check_sequence(v, N + 1);
+	UT_ASSERT(v.capacity() >= 2 * N);
+
+	/* argument referencing an element of the container */
+	v.pop_back();
+	v.push_back(v[N - 1]);
+	UT_ASSERTeq(v.size(), N + 1);
+	UT_ASSERTeq(v.back(), static_cast<int>(N - 1));
+
+	v.pop_back();
+	v.shrink_to_fit();
+	check_sequence(v, N);
+	UT_ASSERTeq(v.capacity(), N);
+
+	v.pop_back();
+	v.push_back(v.front());
+	UT_ASSERTeq(v.back(), 0);
+	UT_ASSERTeq(v.capacity(), N);
+
+	v.free_data();
+	UT_ASSERT(v.empty());
+	UT_ASSERTeq(v.capacity(), N);
+}
+
+/*
+ * test_insert_erase -- checks insert() and erase() in both modes
+ */
+static void
+test_insert_erase(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v1;
+
+	v.assign({0, 2});
+	v.insert(v.cbegin() + 1, 1);
+	v.insert(v.cend(), 3);
+	check_sequence(v, N);
+	UT_ASSERTeq(v.capacity(), N);
+
+	auto it = v.insert(v.cbegin(), -1);
+	UT_ASSERTeq(*it, -1);
+	UT_ASSERTeq(v.size(), N + 1);
+	UT_ASSERT(v.capacity() > N);
+
+	it = v.erase(v.cbegin());
+	UT_ASSERTeq(*it, 0);
+	check_sequence(v, N);
+
+	v.shrink_to_fit();
+	UT_ASSERTeq(v.capacity(), N);
+
+	it = v.erase(v.cbegin() + 1, v.cbegin() + 3);
+	UT_ASSERTeq(*it, 3);
+	UT_ASSERTeq(v.size(), 2);
+	UT_ASSERTeq(v[0], 0);
+	UT_ASSERTeq(v[1], 3);
+
+	v.clear();
+	UT_ASSERT(v.empty());
+}
+
+/*
+ * test_resize_reserve -- checks resize() and reserve() crossing the inline
+ * capacity in both directions
+ */
+static void
+test_resize_reserve(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v1;
+
+	v.resize(N - 1, 5);
+	UT_ASSERTeq(v.size(), N - 1);
+	UT_ASSERTeq(v.capacity(), N);
+
+	v.resize(3 * N, 5);
+	UT_ASSERTeq(v.size(), 3 * N);
+	for (auto &e : v)
+		UT_ASSERTeq(e, 5);
+
+	v.resize(1);
+	UT_ASSERTeq(v.size(), 1);
+	UT_ASSERTeq(v[0], 5);
+
+	v.shrink_to_fit();
+	UT_ASSERTeq(v.capacity(), N);
+
+	v.reserve(N);
+	UT_ASSERTeq(v.capacity(), N);
+
+	v.reserve(10 * N);
+	UT_ASSERTeq(v.capacity(), 10 * N);
+	UT_ASSERTeq(v.size(), 1);
+	UT_ASSERTeq(v[0], 5);
+
+	v.free_data();
+}
+
+/*
+ * test_assign_swap -- checks assignment and swap of containers using the
+ * inline buffer and the heap
+ */
+static void
+test_assign_swap(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto &v1 = *r->v1;
+	auto &v2 = *r->v2;
+
+	std::vector<int> large(3 * N);
+	for (size_t i = 0; i < large.size(); ++i)
+		large[i] = static_cast<int>(i);
+
+	v1.assign(large.begin(), large.end());
+	v2.assign(large.begin(), large.begin() + 2);
+
+	check_sequence(v1, 3 * N);
+	check_sequence(v2, 2);
+
+	v1.swap(v2);
+	check_sequence(v1, 2);
+	check_sequence(v2, 3 * N);
+	UT_ASSERTeq(v1.capacity(), N);
+
+	nvobj::swap(v1, v2);
+	check_sequence(v1, 3 * N);
+	check_sequence(v2, 2);
+
+	v2 = v1;
+	UT_ASSERT(v1 == v2);
+
+	v2 = std::move(v1);
+	check_sequence(v2, 3 * N);
+	UT_ASSERT(v1.empty());
+	UT_ASSERTeq(v1.capacity(), N);
+	UT_ASSERT(v1 < v2);
+
+	v1 = {0, 1};
+	v2 = std::move(v1);
+	check_sequence(v2, 2);
+	UT_ASSERT(v1.empty());
+
+	/* both use the inline buffer */
+	v1.assign(large.begin(), large.begin() + N - 1);
+	v1.swap(v2);
+	check_sequence(v1, 2);
+	check_sequence(v2, N - 1);
+
+	v2.clear();
+	v1.swap(v2);
+	UT_ASSERT(v1.empty());
+	check_sequence(v2, 2);
+
+	v1.free_data();
+	v2.free_data();
+}
+
+/*
+ * test_non_trivial -- checks if elements which are not trivially copyable
+ * are correctly moved between the inline buffer and the heap
+ */
+static void
+test_non_trivial(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+
+	for (size_t i = 0; i < 3 * N; ++i)
+		s.emplace_back(std::to_string(i));
+
+	UT_ASSERTeq(s.size(), 3 * N);
+	for (size_t i = 0; i < 3 * N; ++i)
+		UT_ASSERT(s.const_at(i) == std::to_string(i));
+
+	s.erase(s.cbegin() + 1, s.cend());
+	s.shrink_to_fit();
+	UT_ASSERTeq(s.capacity(), N);
+	UT_ASSERT(s.cfront() == "0");
+
+	s.emplace(s.cbegin(), "first");
+	UT_ASSERT(s.cfront() == "first");
+	UT_ASSERT(s.cback() == "0");
+
+	auto &other = *pop.root()->s_other;
+	for (size_t i = 0; i < 3 * N; ++i)
+		other.emplace_back("heap");
+
+	s.swap(other);
+	UT_ASSERTeq(s.size(), 3 * N);
+	UT_ASSERT(s.cfront() == "heap");
+	UT_ASSERTeq(other.size(), 2);
+	UT_ASSERT(other.cfront() == "first");
+	UT_ASSERTeq(other.capacity(), N);
+
+	other.swap(s);
+	UT_ASSERTeq(s.size(), 2);
+	UT_ASSERT(s.cback() == "0");
+
+	other.resize(1);
+	other.shrink_to_fit();
+	s.swap(other);
+	UT_ASSERTeq(s.size(), 1);
+	UT_ASSERT(s.cfront() == "heap");
+	UT_ASSERTeq(other.size(), 2);
+	UT_ASSERT(other.cfront() == "first");
+	UT_ASSERT(other.cback() == "0");
+
+	s.clear();
+	UT_ASSERT(s.empty());
+	other.clear();
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(
+		path, "SmallVectorTest: modifiers", PMEMOBJ_MIN_POOL,
+		S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->v1 = nvobj::make_persistent<C>();
+			r->v2 = nvobj::make_persistent<C>();
+			r->s = nvobj::make_persistent<S>();
+			r->s_other = nvobj::make_persistent<S>();
+		});
+
+		test_push_pop(pop);
+		test_insert_erase(pop);
+		test_resize_reserve(pop);
+		test_assign_swap(pop);
+		test_non_trivial(pop);
+
+		nvobj::transaction::run(pop, [&] {
+			nvobj::delete_persistent<C>(r->v1);
+			nvobj::delete_persistent<C>(r->v2);
+			nvobj::delete_persistent<S>(r->s);
+			nvobj::delete_persistent<S>(r->s_other);
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
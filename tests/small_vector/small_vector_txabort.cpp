@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * small_vector_txabort.cpp -- checks if pmem::obj::small_vector state is
+ * reverted when transaction aborts, also when elements were moved between
+ * the inline buffer and the heap
+ */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/container/small_vector.hpp>
+#include <libpmemobj++/container/string.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <functional>
+
+namespace nvobj = pmem::obj;
+
+static constexpr size_t N = 4;
+
+using C = nvobj::small_vector<int, N>;
+using S = nvobj::small_vector<nvobj::string, N>;
+
+struct root {
+	nvobj::persistent_ptr<C> v;
+	nvobj::persistent_ptr<C> v_other;
+	nvobj::persistent_ptr<S> s;
+};
+
+static void
+check_vector(const C &v, size_t count, int value)
+{
+	UT_ASSERTeq(v.size(), count);
+
+	for (size_t i = 0; i < count; ++i)
+		UT_ASSERTeq(v.const_at(i), value);
+}
+
+static void
+check_strings(const S &s, size_t count, const char *value)
+{
+	UT_ASSERTeq(s.size(), count);
+
+	for (size_t i = 0; i < count; ++i)
+		UT_ASSERT(s.const_at(i) == value);
+}
+
+static void
+abort_tx(nvobj::pool<struct root> &pop, std::function<void()> f)
+{
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			f();
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+}
+
+/*
+ * test_inline -- aborts modifications of a container which uses the inline
+ * buffer
+ */
+static void
+test_inline(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	nvobj::transaction::run(pop, [&] { v.assign(2, 1); });
+
+	abort_tx(pop, [&] {
+		v.push_back(2);
+		v[0] = 2;
+		v.erase(v.cbegin() + 1);
+		check_vector(v, 2, 2);
+	});
+	check_vector(v, 2, 1);
+	UT_ASSERTeq(v.capacity(), N);
+
+	/* spill to the heap */
+	abort_tx(pop, [&] {
+		v.assign(3 * N, 2);
+		check_vector(v, 3 * N, 2);
+	});
+	check_vector(v, 2, 1);
+	UT_ASSERTeq(v.capacity(), N);
+
+	abort_tx(pop, [&] {
+		v.resize(N, 1);
+		v.push_back(1);
+		v.insert(v.cbegin(), 1);
+		check_vector(v, N + 2, 1);
+	});
+	check_vector(v, 2, 1);
+	UT_ASSERTeq(v.capacity(), N);
+}
+
+/*
+ * test_heap -- aborts modifications of a container which uses the heap
+ */
+static void
+test_heap(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	nvobj::transaction::run(pop, [&] { v.assign(2 * N, 1); });
+	auto capacity = v.capacity();
+
+	/* move back to the inline buffer */
+	abort_tx(pop, [&] {
+		v.resize(1);
+		v.shrink_to_fit();
+		UT_ASSERTeq(v.capacity(), N);
+		v.push_back(2);
+	});
+	check_vector(v, 2 * N, 1);
+	UT_ASSERTeq(v.capacity(), capacity);
+
+	abort_tx(pop, [&] {
+		v.free_data();
+		v.assign(N, 2);
+		check_vector(v, N, 2);
+	});
+	check_vector(v, 2 * N, 1);
+	UT_ASSERTeq(v.capacity(), capacity);
+
+	nvobj::transaction::run(pop, [&] { v.free_data(); });
+}
+
+/*
+ * test_non_trivial -- aborts modifications of a container holding elements
+ * which are not trivially copyable
+ */
+static void
+test_non_trivial(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+
+	nvobj::transaction::run(pop, [&] {
+		for (size_t i = 0; i < N; ++i)
+			s.emplace_back("abc");
+	});
+
+	abort_tx(pop, [&] {
+		s.emplace_back("def");
+		s.erase(s.cbegin());
+		s.shrink_to_fit();
+		s.clear();
+		UT_ASSERT(s.empty());
+	});
+	check_strings(s, N, "abc");
+	UT_ASSERTeq(s.capacity(), N);
+}
+
+/*
+ * test_swap -- aborts swap of containers using the inline buffer and the
+ * heap
+ */
+static void
+test_swap(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+	auto &other = *pop.root()->v_other;
+
+	nvobj::transaction::run(pop, [&] {
+		v.assign(2, 1);
+		other.assign(3, 2);
+	});
+
+	/* both use the inline buffer */
+	abort_tx(pop, [&] {
+		v.swap(other);
+		check_vector(v, 3, 2);
+		check_vector(other, 2, 1);
+	});
+	check_vector(v, 2, 1);
+	check_vector(other, 3, 2);
+
+	nvobj::transaction::run(pop, [&] { other.assign(3 * N, 2); });
+	auto capacity = other.capacity();
+
+	abort_tx(pop, [&] {
+		v.swap(other);
+		check_vector(v, 3 * N, 2);
+		check_vector(other, 2, 1);
+		UT_ASSERTeq(other.capacity(), N);
+	});
+	check_vector(v, 2, 1);
+	UT_ASSERTeq(v.capacity(), N);
+	check_vector(other, 3 * N, 2);
+	UT_ASSERTeq(other.capacity(), capacity);
+
+	abort_tx(pop, [&] {
+		other.swap(v);
+		check_vector(v, 3 * N, 2);
+		check_vector(other, 2, 1);
+	});
+	check_vector(v, 2, 1);
+	check_vector(other, 3 * N, 2);
+
+	nvobj::transaction::run(pop, [&] {
+		v.free_data();
+		other.free_data();
+	});
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(
+		path, "SmallVectorTest: txabort", PMEMOBJ_MIN_POOL,
+		S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->v = nvobj::make_persistent<C>();
+			r->v_other = nvobj::make_persistent<C>();
+			r->s = nvobj::make_persistent<S>();
+		});
+
+		test_inline(pop);
+		test_heap(pop);
+		test_non_trivial(pop);
+		test_swap(pop);
+
+		nvobj::transaction::run(pop, [&] {
+			nvobj::delete_persistent<C>(r->v);
+			nvobj::delete_persistent<C>(r->v_other);
+			nvobj::delete_persistent<S>(r->s);
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * string_sso_capacity.cpp -- tests for basic_string with user-defined
+ * SSO capacity
+ */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/container/string.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <string>
+
+namespace nvobj = pmem::obj;
+
+/* whole object fits in a single cache line */
+using S = nvobj::basic_string<char, std::char_traits<char>, 55>;
+using W = nvobj::basic_string<char32_t, std::char_traits<char32_t>, 13>;
+
+static_assert(sizeof(S) == 64, "");
+static_assert(sizeof(W) == 64, "");
+static_assert(std::is_standard_layout<S>::value, "");
+static_assert(std::is_standard_layout<W>::value, "");
+static_assert(S::sso_capacity == 55, "");
+static_assert(nvobj::string::sso_capacity == 23, "");
+
+struct root {
+	nvobj::persistent_ptr<S> s;
+	nvobj::persistent_ptr<W> w;
+};
+
+/*
+ * test_sso -- checks if strings up to sso_capacity are kept inline and
+ * longer ones are moved to (and back from) the external buffer
+ */
+static void
+test_sso(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+
+	UT_ASSERTeq(s.capacity(), 55);
+
+	std::string key(55, 'a');
+	nvobj::transaction::run(pop, [&] { s = key; });
+	UT_ASSERTeq(s.size(), 55);
+	UT_ASSERTeq(s.capacity(), 55);
+	UT_ASSERT(s.cdata() >= reinterpret_cast<const char *>(&s) &&
+		  s.cdata() < reinterpret_cast<const char *>(&s + 1));
+	UT_ASSERT(s == key);
+
+	nvobj::transaction::run(pop, [&] { s.append(1, 'b'); });
+	key.append(1, 'b');
+	UT_ASSERTeq(s.size(), 56);
+	UT_ASSERT(s.capacity() > 55);
+	UT_ASSERT(s == key);
+
+	nvobj::transaction::run(pop, [&] {
+		s.erase(40);
+		s.shrink_to_fit();
+	});
+	key.erase(40);
+	UT_ASSERTeq(s.capacity(), 55);
+	UT_ASSERT(s == key);
+
+	auto &w = *pop.root()->w;
+	std::u32string wkey(13, U'x');
+	nvobj::transaction::run(pop,
+				[&] { w.assign(wkey.begin(), wkey.end()); });
+	UT_ASSERTeq(w.capacity(), 13);
+	UT_ASSERT(w.compare(wkey) == 0);
+
+	nvobj::transaction::run(pop, [&] { w.push_back(U'y'); });
+	UT_ASSERT(w.capacity() > 13);
+	UT_ASSERTeq(w.size(), 14);
+}
+
+/*
+ * test_tx_abort -- checks if switching between inline and external
+ * storage is reverted on abort
+ */
+static void
+test_tx_abort(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+	std::string key(50, 'c');
+
+	nvobj::transaction::run(pop, [&] { s = key; });
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			s.append(100, 'd');
+			UT_ASSERTeq(s.size(), 150);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(s.capacity(), 55);
+	UT_ASSERT(s == key);
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(
+		path, "StringTest", PMEMOBJ_MIN_POOL, S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->s = nvobj::make_persistent<S>();
+			r->w = nvobj::make_persistent<W>();
+		});
+
+		test_sso(pop);
+		test_tx_abort(pop);
+
+		nvobj::transaction::run(pop, [&] {
+			nvobj::delete_persistent<S>(r->s);
+			nvobj::delete_persistent<W>(r->w);
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * string_builder.cpp -- tests for experimental::string_builder
+ */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/string_builder.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <string>
+
+namespace nvobj = pmem::obj;
+
+using S = nvobj::experimental::string_builder;
+
+struct root {
+	nvobj::persistent_ptr<S> s;
+};
+
+static void
+check(const S &s, const std::string &expected)
+{
+	UT_ASSERTeq(s.size(), expected.size());
+	UT_ASSERT(s.size() <= s.capacity());
+	UT_ASSERT(std::string(s.cbegin(), s.cend()) == expected);
+	UT_ASSERT(s.view().compare(nvobj::string_view(expected.data(),
+						      expected.size())) == 0);
+}
+
+/*
+ * test_append -- appends many small pieces and checks that buffer is
+ * reallocated only a logarithmic number of times
+ */
+static void
+test_append(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+	std::string expected;
+
+	UT_ASSERT(s.empty());
+	UT_ASSERTeq(s.capacity(), 0);
+
+	size_t reallocations = 0;
+	for (size_t i = 0; i < 1000; ++i) {
+		auto capacity = s.capacity();
+
+		std::string line = "line " + std::to_string(i) + "\n";
+		s.append(line.c_str());
+		expected += line;
+
+		if (s.capacity() != capacity)
+			++reallocations;
+	}
+	check(s, expected);
+	UT_ASSERT(reallocations <= 10);
+
+	s.push_back('x');
+	s += 'y';
+	s.append(3, 'z');
+	s += "abc";
+	s += nvobj::string_view("def");
+	expected += "xyzzzabcdef";
+	check(s, expected);
+
+	/* appending part of itself */
+	auto sv = s.view().substr(0, 100);
+	s.reserve(s.size() + 10);
+	s.append(sv);
+	expected += expected.substr(0, 100);
+	check(s, expected);
+
+	s.append(s.data(), s.size());
+	expected += expected;
+	check(s, expected);
+
+	UT_ASSERTeq(s.at(1), 'i');
+	UT_ASSERTeq(s[2], 'n');
+
+	try {
+		(void)s.at(s.size());
+		UT_ASSERT(0);
+	} catch (std::out_of_range &) {
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+}
+
+/*
+ * test_tx_abort -- checks if appends are reverted when enclosing
+ * transaction aborts
+ */
+static void
+test_tx_abort(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+	std::string expected(s.cbegin(), s.cend());
+	auto capacity = s.capacity();
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			s.append("abc");
+			s.append(capacity, 'x');
+			UT_ASSERTeq(s.size(), expected.size() + 3 + capacity);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(s.capacity(), capacity);
+	check(s, expected);
+
+	exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			s.clear();
+			UT_ASSERT(s.empty());
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	check(s, expected);
+
+	/* appends after clear() overwrite the cleared characters */
+	UT_ASSERT(expected.size() > 3);
+
+	exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			s.clear();
+			s.append("abc");
+			s.append(expected.size() - 3, 'y');
+			UT_ASSERTeq(s.size(), expected.size());
+			UT_ASSERTeq(s.capacity(), capacity);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	check(s, expected);
+}
+
+/*
+ * test_clear -- checks clear() and free_data()
+ */
+static void
+test_clear(nvobj::pool<struct root> &pop)
+{
+	auto &s = *pop.root()->s;
+	auto capacity = s.capacity();
+
+	s.clear();
+	UT_ASSERT(s.empty());
+	UT_ASSERTeq(s.capacity(), capacity);
+
+	s.append("abc");
+	check(s, "abc");
+
+	s.free_data();
+	UT_ASSERT(s.empty());
+	UT_ASSERTeq(s.capacity(), 0);
+	UT_ASSERT(s.data() == nullptr);
+
+	s.append("def");
+	check(s, "def");
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "StringBuilderTest",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(
+			pop, [&] { r->s = nvobj::make_persistent<S>(); });
+
+		test_append(pop);
+		test_tx_abort(pop);
+
+		/* content must survive reopening the pool */
+		std::string expected(r->s->cbegin(), r->s->cend());
+		pop.close();
+		pop = nvobj::pool<root>::open(path, "StringBuilderTest");
+		r = pop.root();
+		check(*r->s, expected);
+
+		test_clear(pop);
+
+		nvobj::transaction::run(
+			pop, [&] { nvobj::delete_persistent<S>(r->s); });
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
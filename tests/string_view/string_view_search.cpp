@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * string_view_search.cpp -- compares results of string_view search methods
+ * (and of underlying vectorized byte string search) with std::string
+ */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/detail/string_search.hpp>
+#include <libpmemobj++/string_view.hpp>
+
+#include <random>
+#include <string>
+
+static std::mt19937_64 generator;
+
+/*
+ * random_string -- generates string over a small alphabet, so that there
+ * are many partial matches
+ */
+static std::string
+random_string(size_t length, char alphabet_size)
+{
+	std::uniform_int_distribution<int> dist(0, alphabet_size - 1);
+
+	std::string s(length, 'a');
+	for (auto &c : s)
+		c = static_cast<char>('a' + dist(generator));
+
+	return s;
+}
+
+/*
+ * check_substr -- checks find and rfind of needle in every position of str
+ */
+static void
+check_substr(const std::string &str, const std::string &needle)
+{
+	pmem::obj::string_view v(str.data(), str.size());
+	pmem::obj::string_view n(needle.data(), needle.size());
+
+	for (size_t pos = 0; pos <= str.size() + 1; ++pos) {
+		UT_ASSERTeq(v.find(n, pos), str.find(needle, pos));
+		UT_ASSERTeq(v.rfind(n, pos), str.rfind(needle, pos));
+		UT_ASSERTeq(pmem::detail::byte_string_find(
+				    str.data(), str.size(), needle.data(), pos,
+				    needle.size()),
+			    str.find(needle, pos));
+		UT_ASSERTeq(pmem::detail::byte_string_rfind(
+				    str.data(), str.size(), needle.data(), pos,
+				    needle.size()),
+			    str.rfind(needle, pos));
+	}
+	UT_ASSERTeq(v.rfind(n), str.rfind(needle));
+
+	if (needle.empty() || needle.size() > str.size())
+		return;
+
+	/* check all available kernels, not only the dispatched one */
+	size_t last_pos = str.size() - needle.size();
+	UT_ASSERTeq(pmem::detail::byte_string_find_scalar(
+			    str.data(), 0, last_pos, needle.data(),
+			    needle.size()),
+		    str.find(needle));
+	UT_ASSERTeq(pmem::detail::byte_string_rfind_scalar(
+			    str.data(), last_pos, needle.data(), needle.size()),
+		    str.rfind(needle));
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_SSE2
+	UT_ASSERTeq(pmem::detail::byte_string_find_sse2(str.data(), 0,
+							last_pos, needle.data(),
+							needle.size()),
+		    str.find(needle));
+	UT_ASSERTeq(pmem::detail::byte_string_rfind_sse2(
+			    str.data(), last_pos, needle.data(), needle.size()),
+		    str.rfind(needle));
+#endif
+#if LIBPMEMOBJ_CPP_STRING_SEARCH_AVX2
+	if (pmem::detail::cpu_has_avx2()) {
+		UT_ASSERTeq(pmem::detail::byte_string_find_avx2(
+				    str.data(), 0, last_pos, needle.data(),
+				    needle.size()),
+			    str.find(needle));
+		UT_ASSERTeq(pmem::detail::byte_string_rfind_avx2(
+				    str.data(), last_pos, needle.data(),
+				    needle.size()),
+			    str.rfind(needle));
+	}
+#endif
+}
+
+/*
+ * check_set -- checks find_*_of family for set of characters in every
+ * position of str
+ */
+static void
+check_set(const std::string &str, const std::string &set)
+{
+	pmem::obj::string_view v(str.data(), str.size());
+	pmem::obj::string_view s(set.data(), set.size());
+
+	for (size_t pos = 0; pos <= str.size() + 1; ++pos) {
+		UT_ASSERTeq(v.find_first_of(s, pos),
+			    str.find_first_of(set, pos));
+		UT_ASSERTeq(v.find_first_not_of(s, pos),
+			    str.find_first_not_of(set, pos));
+		UT_ASSERTeq(v.find_last_of(s, pos), str.find_last_of(set, pos));
+		UT_ASSERTeq(v.find_last_not_of(s, pos),
+			    str.find_last_not_of(set, pos));
+	}
+	UT_ASSERTeq(v.find_last_of(s), str.find_last_of(set));
+	UT_ASSERTeq(v.find_last_not_of(s), str.find_last_not_of(set));
+}
+
+static void
+test_substr()
+{
+	for (size_t length :
+	     {0U, 1U, 15U, 16U, 17U, 31U, 32U, 33U, 100U, 300U}) {
+		for (char alphabet : {2, 4, 26}) {
+			auto str = random_string(length, alphabet);
+
+			for (size_t n : {0U, 1U, 2U, 3U, 5U, 8U, 20U}) {
+				check_substr(str, random_string(n, alphabet));
+
+				/* needle which is always found */
+				if (n <= length)
+					check_substr(
+						str,
+						str.substr(length - n, n));
+			}
+		}
+	}
+
+	/* bytes with MSB set */
+	std::string str(100, '\xff');
+	str[70] = '\x80';
+	check_substr(str, std::string("\xff\x80"));
+	check_substr(str, std::string("\x80\xff"));
+}
+
+static void
+test_set()
+{
+	for (size_t length : {0U, 1U, 16U, 33U, 100U}) {
+		auto str = random_string(length, 8);
+
+		for (size_t n : {0U, 1U, 2U, 5U, 8U}) {
+			check_set(str, random_string(n, 8));
+		}
+	}
+
+	std::string str("ab\0c\xff", 5);
+	check_set(str, std::string("\0", 1));
+	check_set(str, std::string("\xff"));
+}
+
+static void
+test(int argc, char *argv[])
+{
+	test_substr();
+	test_set();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
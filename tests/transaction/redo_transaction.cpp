@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/redo_transaction.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <cstring>
+
+namespace nvobj = pmem::obj;
+namespace nvobje = pmem::obj::experimental;
+
+struct small {
+	char c[6];
+};
+
+struct root {
+	nvobj::p<int> a;
+	nvobj::p<int> b;
+	nvobj::p<uint64_t> c;
+	char pad[5];
+	/* crosses an 8-byte boundary */
+	nvobj::p<small> s;
+	nvobj::p<uint64_t> arr[64];
+	/* share one word */
+	nvobj::p<uint32_t> x;
+	nvobj::p<uint32_t> y;
+};
+
+namespace
+{
+void
+test_commit(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobje::redo_transaction tx(pop);
+
+	tx.set(r->a, 1);
+	tx.set(r->b, 2);
+	tx.set(r->c, uint64_t(3));
+
+	/* a and b share one word */
+	UT_ASSERTeq(tx.size(), 2);
+
+	/* nothing is written before commit */
+	UT_ASSERTeq(r->a, 0);
+	UT_ASSERTeq(r->b, 0);
+	UT_ASSERTeq(r->c, 0);
+
+	UT_ASSERTeq(tx.get(r->a), 1);
+	UT_ASSERTeq(tx.get(r->b), 2);
+	UT_ASSERTeq(tx.get(r->c), 3);
+
+	tx.commit();
+
+	UT_ASSERT(tx.empty());
+	UT_ASSERTeq(r->a, 1);
+	UT_ASSERTeq(r->b, 2);
+	UT_ASSERTeq(r->c, 3);
+}
+
+void
+test_unaligned(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	std::memset(r->pad, 'x', sizeof(r->pad));
+	pop.persist(r->pad, sizeof(r->pad));
+
+	small value;
+	std::memcpy(value.c, "abcdef", sizeof(value.c));
+
+	nvobje::redo_transaction::run(pop, [&](nvobje::redo_transaction &tx) {
+		tx.set(r->s, value);
+		UT_ASSERT(std::memcmp(tx.get(r->s).c, "abcdef", 6) == 0);
+	});
+
+	UT_ASSERT(std::memcmp(r->s.get_ro().c, "abcdef", 6) == 0);
+
+	/* neighbouring bytes are preserved */
+	for (auto c : r->pad)
+		UT_ASSERTeq(c, 'x');
+	UT_ASSERTeq(r->c, 3);
+}
+
+void
+test_coalesce(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobje::redo_transaction tx(pop);
+
+	for (uint64_t i = 0; i < 1000; ++i)
+		tx.set(r->arr[i % 64], i);
+
+	UT_ASSERTeq(tx.size(), 64);
+
+	tx.commit();
+
+	/* the last value written to each element wins */
+	for (uint64_t i = 0; i < 64; ++i)
+		UT_ASSERTeq(r->arr[i], i + 64 * ((999 - i) / 64));
+}
+
+void
+test_discard(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	{
+		nvobje::redo_transaction tx(pop);
+		tx.set(r->a, 10);
+	}
+
+	UT_ASSERTeq(r->a, 1);
+
+	nvobje::redo_transaction tx(pop);
+	tx.set(r->a, 10);
+	tx.abort();
+	tx.commit();
+
+	UT_ASSERTeq(r->a, 1);
+
+	try {
+		nvobje::redo_transaction::run(
+			pop, [&](nvobje::redo_transaction &tx) {
+				tx.set(r->a, 10);
+				throw std::runtime_error("error");
+			});
+		UT_ASSERT(0);
+	} catch (std::runtime_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(r->a, 1);
+}
+
+void
+test_not_in_pool(nvobj::pool<struct root> &pop)
+{
+	int volatile_int = 0;
+
+	nvobje::redo_transaction tx(pop);
+
+	try {
+		tx.set(&volatile_int, 1);
+		UT_ASSERT(0);
+	} catch (pmem::pool_invalid_argument &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(tx.empty());
+}
+
+/*
+ * Committed inside of a transaction, writes are rolled back with it.
+ */
+void
+test_inside_tx(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			nvobje::redo_transaction tx(pop);
+			tx.set(r->a, 20);
+			tx.commit();
+
+			UT_ASSERTeq(r->a, 20);
+
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(r->a, 1);
+}
+
+/*
+ * Neighbouring field, which shares a word with the modified one and is
+ * changed between set() and commit(), keeps its new value.
+ */
+void
+test_neighbour(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobje::redo_transaction tx(pop);
+	tx.set(r->x, uint32_t(1));
+
+	/* directly */
+	r->y = 2;
+	pop.persist(r->y);
+
+	UT_ASSERTeq(tx.get(r->x), 1);
+	UT_ASSERTeq(tx.get(r->y), 2);
+
+	tx.commit();
+
+	UT_ASSERTeq(r->x, 1);
+	UT_ASSERTeq(r->y, 2);
+
+	/* in the enclosing transaction */
+	nvobj::transaction::run(pop, [&] {
+		nvobje::redo_transaction tx(pop);
+		tx.set(r->x, uint32_t(3));
+
+		r->y = 4;
+
+		tx.commit();
+	});
+
+	UT_ASSERTeq(r->x, 3);
+	UT_ASSERTeq(r->y, 4);
+
+	/* bytes which were set win over changes made after set() */
+	tx.set(r->y, uint32_t(5));
+	tx.set(r->x, uint32_t(6));
+
+	r->x = 7;
+	r->y = 8;
+	pop.persist(&r->x, 2 * sizeof(uint32_t));
+
+	tx.commit();
+
+	UT_ASSERTeq(r->x, 6);
+	UT_ASSERTeq(r->y, 5);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "redo_transaction",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	test_commit(pop);
+	test_unaligned(pop);
+	test_coalesce(pop);
+	test_discard(pop);
+	test_not_in_pool(pop);
+	test_inside_tx(pop);
+	test_neighbour(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2016-2020, Intel Corporation */
+/* Copyright 2016-2021, Intel Corporation */
 
 /*
  * obj_cpp_transaction.cpp -- cpp transaction test
@@ -999,6 +999,60 @@ test_tx_callback_outside_tx()
 	}
 }
 
+/*
+ * Non-copyable transaction worker.
+ */
+class move_only_worker {
+public:
+	move_only_worker(nvobj::pool<root> &pop_, int value_)
+	    : pop(pop_), value(value_)
+	{
+	}
+
+	move_only_worker(const move_only_worker &) = delete;
+	move_only_worker(move_only_worker &&) = default;
+
+	void
+	operator()() const
+	{
+		pop.root()->pfoo->bar = value;
+	}
+
+private:
+	nvobj::pool<root> &pop;
+	int value;
+};
+
+/*
+ * test_tx_run_callable -- test run() with callables which cannot be
+ * stored in an std::function
+ */
+void
+test_tx_run_callable(nvobj::pool<root> &pop)
+{
+	auto rootp = pop.root();
+
+	if (rootp->pfoo == nullptr)
+		nvobj::transaction::run(pop, [&] {
+			rootp->pfoo = nvobj::make_persistent<foo>();
+		});
+
+	nvobj::transaction::run(pop, move_only_worker(pop, 1));
+	UT_ASSERTeq(rootp->pfoo->bar, 1);
+
+	move_only_worker worker(pop, 2);
+	nvobj::transaction::run(pop, worker, rootp->mtx);
+	UT_ASSERTeq(rootp->pfoo->bar, 2);
+
+	const move_only_worker const_worker(pop, 3);
+	nvobj::flat_transaction::run(pop, const_worker);
+	UT_ASSERTeq(rootp->pfoo->bar, 3);
+
+	std::function<void()> func = [&] { rootp->pfoo->bar = 4; };
+	nvobj::transaction::run(pop, func);
+	UT_ASSERTeq(rootp->pfoo->bar, 4);
+}
+
 void
 test_tx_run_in_wrong_stage(nvobj::pool<root> &pop)
 {
@@ -1059,6 +1113,7 @@ test(int argc, char *argv[])
 	test_tx_callback_outside_tx();
 
 	test_tx_run_in_wrong_stage(pop);
+	test_tx_run_callable(pop);
 
 	pop.close();
 }
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/tx_log_buffer.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/make_persistent_array.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+namespace nvobj = pmem::obj;
+namespace nvobje = pmem::obj::experimental;
+
+using log_type = nvobj::transaction::log_type;
+
+static constexpr size_t concurrency = 4;
+static constexpr size_t arr_size = 1024;
+
+struct root {
+	nvobj::persistent_ptr<nvobje::tx_log_buffer> log_buffer;
+	nvobj::persistent_ptr<char[]> raw_buffer;
+	nvobj::p<size_t> arr[concurrency][arr_size];
+};
+
+namespace
+{
+size_t
+count_objects(nvobj::pool<struct root> &pop)
+{
+	size_t n = 0;
+	for (auto oid = pmemobj_first(pop.handle()); !OID_IS_NULL(oid);
+	     oid = pmemobj_next(oid))
+		++n;
+
+	return n;
+}
+
+size_t
+snapshot_log_size()
+{
+	return nvobj::transaction::log_snapshots_max_size(
+		{sizeof(root::arr[0])});
+}
+
+void
+test_max_size()
+{
+	auto one = nvobj::transaction::log_snapshots_max_size({64});
+	auto two = nvobj::transaction::log_snapshots_max_size({64, 64});
+	UT_ASSERT(one >= 64);
+	UT_ASSERT(two >= one + 64);
+
+	auto intents = nvobj::transaction::log_intents_max_size(10);
+	UT_ASSERT(nvobj::transaction::log_intents_max_size(20) > intents);
+}
+
+void
+test_append_buffer(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto size = snapshot_log_size();
+
+	nvobj::transaction::run(pop, [&] {
+		r->raw_buffer = nvobj::make_persistent<char[]>(size);
+	});
+
+	try {
+		nvobj::transaction::log_append_buffer(
+			log_type::snapshot, r->raw_buffer.get(), size);
+		UT_ASSERT(0);
+	} catch (pmem::transaction_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	nvobj::transaction::run(pop, [&] {
+		nvobj::transaction::log_append_buffer(
+			log_type::snapshot, r->raw_buffer.get(), size);
+		nvobj::transaction::log_auto_alloc(log_type::snapshot, false);
+
+		for (size_t i = 0; i < arr_size; ++i)
+			r->arr[0][i] = i;
+	});
+
+	for (size_t i = 0; i < arr_size; ++i)
+		UT_ASSERTeq(r->arr[0][i], i);
+
+	/* the buffer must be in the pool */
+	char volatile_buffer[256];
+	try {
+		nvobj::transaction::run(pop, [&] {
+			nvobj::transaction::log_append_buffer(
+				log_type::snapshot, volatile_buffer,
+				sizeof(volatile_buffer));
+		});
+		UT_ASSERT(0);
+	} catch (pmem::transaction_error &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	nvobj::transaction::run(pop, [&] {
+		nvobj::delete_persistent<char[]>(r->raw_buffer, size);
+		r->raw_buffer = nullptr;
+	});
+}
+
+void
+test_reserve_and_run(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto size = snapshot_log_size();
+
+	nvobj::transaction::run(pop, [&] {
+		r->log_buffer = nvobj::make_persistent<nvobje::tx_log_buffer>();
+	});
+
+	UT_ASSERTeq(r->log_buffer->size(log_type::snapshot), 0);
+
+	r->log_buffer->reserve(log_type::snapshot, size);
+	r->log_buffer->reserve(log_type::intent,
+			       nvobj::transaction::log_intents_max_size(4));
+	UT_ASSERTeq(r->log_buffer->size(log_type::snapshot), size);
+
+	/* buffers only grow and are reused */
+	auto objects = count_objects(pop);
+	r->log_buffer->reserve(log_type::snapshot, size / 2);
+	UT_ASSERTeq(r->log_buffer->size(log_type::snapshot), size);
+	UT_ASSERTeq(count_objects(pop), objects);
+
+	for (size_t n = 0; n < 3; ++n) {
+		r->log_buffer->run([&] {
+			for (size_t i = 0; i < arr_size; ++i)
+				r->arr[0][i] = i + n;
+		});
+	}
+
+	for (size_t i = 0; i < arr_size; ++i)
+		UT_ASSERTeq(r->arr[0][i], i + 2);
+
+	try {
+		r->log_buffer->run([&] {
+			for (size_t i = 0; i < arr_size; ++i)
+				r->arr[0][i] = 0;
+
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	for (size_t i = 0; i < arr_size; ++i)
+		UT_ASSERTeq(r->arr[0][i], i + 2);
+
+	UT_ASSERTeq(count_objects(pop), objects);
+
+	nvobj::transaction::run(pop, [&] {
+		try {
+			r->log_buffer->reserve(log_type::snapshot, size);
+			UT_ASSERT(0);
+		} catch (pmem::transaction_scope_error &) {
+		} catch (...) {
+			UT_ASSERT(0);
+		}
+	});
+}
+
+void
+test_threads(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto size = snapshot_log_size();
+
+	parallel_exec(concurrency, [&](size_t tid) {
+		r->log_buffer->reserve(log_type::snapshot, size);
+
+		for (size_t n = 0; n < 10; ++n) {
+			r->log_buffer->run([&] {
+				for (size_t i = 0; i < arr_size; ++i)
+					r->arr[tid][i] = tid + n;
+			});
+		}
+	});
+
+	for (size_t tid = 0; tid < concurrency; ++tid)
+		for (size_t i = 0; i < arr_size; ++i)
+			UT_ASSERTeq(r->arr[tid][i], tid + 9);
+}
+
+void
+test_clear(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	auto objects = count_objects(pop);
+
+	nvobj::transaction::run(pop, [&] {
+		nvobj::delete_persistent<nvobje::tx_log_buffer>(r->log_buffer);
+		r->log_buffer = nullptr;
+	});
+
+	/* the object and at least two buffers of the main thread are gone */
+	UT_ASSERT(count_objects(pop) <= objects - 3);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "transaction_log_buffer",
+					     PMEMOBJ_MIN_POOL * 2,
+					     S_IWUSR | S_IRUSR);
+
+	test_max_size();
+	test_append_buffer(pop);
+	test_reserve_and_run(pop);
+	test_threads(pop);
+	test_clear(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
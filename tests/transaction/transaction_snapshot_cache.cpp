@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+#include "unittest.hpp"
+
+#include <libpmemobj++/detail/common.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+namespace nvobj = pmem::obj;
+
+using cache_type = pmem::detail::tx_snapshot_cache;
+
+struct root {
+	nvobj::p<int> a;
+	nvobj::p<int> b;
+	nvobj::p<int> arr[16];
+};
+
+namespace
+{
+void
+init(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		r->a = 1;
+		r->b = 2;
+		for (int i = 0; i < 16; ++i)
+			r->arr[i] = i;
+	});
+}
+
+/*
+ * Repeated writes must not break rollback of the first snapshot.
+ */
+void
+test_repeated_writes_abort(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			for (int i = 0; i < 100; ++i) {
+				r->a = r->a + 1;
+				r->b = r->b + 2;
+			}
+
+			UT_ASSERTeq(r->a, 101);
+			UT_ASSERTeq(r->b, 202);
+
+			auto &cache = cache_type::get();
+			UT_ASSERT(cache.enabled());
+			UT_ASSERT(cache.contains(&r->a, sizeof(r->a)));
+			UT_ASSERT(cache.contains(&r->b, sizeof(r->b)));
+
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(!cache_type::get().enabled());
+	UT_ASSERTeq(r->a, 1);
+	UT_ASSERTeq(r->b, 2);
+}
+
+/*
+ * Ranges snapshotted in one transaction must be snapshotted again in
+ * the next one.
+ */
+void
+test_next_tx_snapshots_again(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] { r->a = 10; });
+
+	UT_ASSERT(!cache_type::get().enabled());
+	UT_ASSERTeq(r->a, 10);
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			UT_ASSERT(!cache_type::get().contains(&r->a,
+							      sizeof(r->a)));
+			r->a = 20;
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(r->a, 10);
+
+	nvobj::transaction::run(pop, [&] { r->a = 1; });
+}
+
+/*
+ * A range added in a nested transaction stays in the undo log of the
+ * outermost one.
+ */
+void
+test_nested(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			nvobj::flat_transaction::run(pop,
+						     [&] { r->arr[3] = 100; });
+
+			UT_ASSERT(cache_type::get().enabled());
+			r->arr[3] = 200;
+
+			nvobj::transaction::abort(EINVAL);
+		});
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(r->arr[3], 3);
+}
+
+/*
+ * Only plain snapshots are cached and a covering range satisfies
+ * smaller lookups.
+ */
+void
+test_flags_and_coverage(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		auto &cache = cache_type::get();
+
+		pmem::detail::conditional_add_to_tx(&r->a, 1,
+						    POBJ_XADD_NO_SNAPSHOT);
+		UT_ASSERT(!cache.contains(&r->a, sizeof(r->a)));
+
+		pmem::detail::conditional_add_to_tx(&r->arr[0], 16);
+		UT_ASSERT(cache.contains(&r->arr[0], sizeof(r->arr[0])));
+		UT_ASSERT(cache.contains(&r->arr[0], sizeof(r->arr)));
+		UT_ASSERT(!cache.contains(&r->arr[0], sizeof(r->arr) + 1));
+	});
+}
+
+/*
+ * Objects allocated in the transaction need no snapshots; freeing an
+ * object drops the cache.
+ */
+void
+test_allocations(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		auto &cache = cache_type::get();
+
+		r->a = 2;
+		UT_ASSERT(cache.contains(&r->a, sizeof(r->a)));
+
+		auto ptr = nvobj::make_persistent<root>();
+		UT_ASSERT(cache.contains(ptr.get(), sizeof(root)));
+		UT_ASSERT(cache.contains(&ptr->arr[5], sizeof(ptr->arr[5])));
+
+		nvobj::delete_persistent<root>(ptr);
+		UT_ASSERT(!cache.contains(ptr.get(), sizeof(root)));
+		UT_ASSERT(!cache.contains(&r->a, sizeof(r->a)));
+
+		r->a = 1;
+	});
+
+	UT_ASSERTeq(r->a, 1);
+}
+
+/*
+ * Transactions started through the C API do not use the cache.
+ */
+void
+test_c_api_tx(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	int ret = pmemobj_tx_begin(pop.handle(), nullptr, TX_PARAM_NONE);
+	UT_ASSERTeq(ret, 0);
+
+	r->a = 5;
+	UT_ASSERT(!cache_type::get().enabled());
+	UT_ASSERT(!cache_type::get().contains(&r->a, sizeof(r->a)));
+
+	pmemobj_tx_abort(EINVAL);
+	(void)pmemobj_tx_end();
+
+	UT_ASSERTeq(r->a, 1);
+}
+
+/*
+ * The cache is disabled while stage callbacks run.
+ */
+void
+test_stage_callback(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	nvobj::transaction::run(pop, [&] {
+		r->b = 3;
+		nvobj::transaction::register_callback(
+			nvobj::transaction::stage::oncommit, [&] {
+				UT_ASSERT(!cache_type::get().enabled());
+			});
+	});
+
+	UT_ASSERTeq(r->b, 3);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "transaction_snapshot_cache",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	init(pop);
+
+	test_repeated_writes_abort(pop);
+	test_next_tx_snapshots_again(pop);
+	test_nested(pop);
+	test_flags_and_coverage(pop);
+	test_allocations(pop);
+	test_c_api_tx(pop);
+	test_stage_callback(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
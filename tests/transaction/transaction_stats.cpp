@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+#include "thread_helpers.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/experimental/tx_stats.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+namespace nvobj = pmem::obj;
+namespace nvobje = pmem::obj::experimental;
+
+using stats = nvobje::tx_stats;
+
+static constexpr size_t concurrency = 4;
+
+struct root {
+	nvobj::p<int> a;
+	nvobj::p<int> b;
+	nvobj::p<int> arr[concurrency];
+	int raw[concurrency];
+};
+
+namespace
+{
+/*
+ * Returns counters of the site summed over all threads.
+ */
+stats::counters
+site_counters(const std::string &site)
+{
+	stats::counters ret;
+	for (auto &e : stats::collect()) {
+		if (e.site != site)
+			continue;
+
+		ret.transactions += e.values.transactions;
+		ret.commits += e.values.commits;
+		ret.aborts += e.values.aborts;
+		ret.snapshots += e.values.snapshots;
+		ret.snapshot_bytes += e.values.snapshot_bytes;
+		ret.redundant_snapshots += e.values.redundant_snapshots;
+		ret.allocations += e.values.allocations;
+		ret.allocation_bytes += e.values.allocation_bytes;
+		ret.frees += e.values.frees;
+		ret.free_bytes += e.values.free_bytes;
+		ret.duration += e.values.duration;
+	}
+
+	return ret;
+}
+
+void
+test_run(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	auto tx = [&] {
+		r->a = 1;
+		r->b = 2;
+		r->a = 3;
+
+		/* nested transactions are accounted to the outermost one */
+		nvobj::transaction::run(pop, [&] { r->b = 4; });
+
+		auto ptr = nvobj::make_persistent<root>();
+		nvobj::delete_persistent<root>(ptr);
+	};
+
+	nvobj::transaction::run(pop, tx);
+	nvobj::transaction::run(pop, tx);
+
+	auto c = site_counters(typeid(tx).name());
+	UT_ASSERTeq(c.transactions, 2);
+	UT_ASSERTeq(c.commits, 2);
+	UT_ASSERTeq(c.aborts, 0);
+	UT_ASSERTeq(c.snapshots, 4);
+	UT_ASSERTeq(c.snapshot_bytes, 4 * sizeof(int));
+	UT_ASSERT(c.redundant_snapshots >= 2);
+	UT_ASSERTeq(c.allocations, 2);
+	UT_ASSERTeq(c.allocation_bytes, 2 * sizeof(root));
+	UT_ASSERTeq(c.frees, 2);
+	UT_ASSERT(c.free_bytes >= 2 * sizeof(root));
+	UT_ASSERT(c.duration.count() > 0);
+}
+
+void
+test_abort(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	auto tx = [&] {
+		r->a = 10;
+		nvobj::transaction::abort(EINVAL);
+	};
+
+	try {
+		nvobj::transaction::run(pop, tx);
+		UT_ASSERT(0);
+	} catch (pmem::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	auto c = site_counters(typeid(tx).name());
+	UT_ASSERTeq(c.transactions, 1);
+	UT_ASSERTeq(c.commits, 0);
+	UT_ASSERTeq(c.aborts, 1);
+	UT_ASSERTeq(r->a, 3);
+}
+
+void
+test_site_scope(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	{
+		stats::site_scope site("manual_site");
+
+		nvobj::transaction::manual tx(pop);
+		nvobj::transaction::snapshot(&r->raw[0], concurrency);
+		nvobj::transaction::commit();
+	}
+
+	auto c = site_counters("manual_site");
+	UT_ASSERTeq(c.transactions, 1);
+	UT_ASSERTeq(c.commits, 1);
+	UT_ASSERTeq(c.snapshots, 1);
+	UT_ASSERTeq(c.snapshot_bytes, sizeof(r->raw));
+
+	/* transactions started through the C API are not accounted */
+	int ret = pmemobj_tx_begin(pop.handle(), nullptr, TX_PARAM_NONE);
+	UT_ASSERTeq(ret, 0);
+	r->a = 5;
+	pmemobj_tx_abort(EINVAL);
+	(void)pmemobj_tx_end();
+
+	UT_ASSERTeq(site_counters("unknown").transactions, 0);
+}
+
+void
+test_threads(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	auto tx = [&](size_t tid) { r->arr[tid] = static_cast<int>(tid); };
+	auto thread_tx = [&](size_t tid) {
+		for (int i = 0; i < 10; ++i)
+			nvobj::transaction::run(pop, [&] { tx(tid); });
+	};
+
+	parallel_exec(concurrency, thread_tx);
+
+	size_t threads = 0;
+	uint64_t transactions = 0;
+	for (auto &e : stats::collect()) {
+		if (e.thread == std::this_thread::get_id())
+			continue;
+
+		++threads;
+		transactions += e.values.transactions;
+	}
+
+	UT_ASSERTeq(threads, concurrency);
+	UT_ASSERTeq(transactions, concurrency * 10);
+
+	std::ostringstream os;
+	stats::dump(os);
+	UT_ASSERT(os.str().find("manual_site") != std::string::npos);
+
+	stats::reset();
+
+	UT_ASSERTeq(site_counters("manual_site").transactions, 0);
+	for (auto &e : stats::collect())
+		UT_ASSERT(e.thread == std::this_thread::get_id());
+}
+
+void
+test_periodic_dump(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+	std::atomic<size_t> calls(0);
+
+	{
+		stats::periodic_dump dumper(
+			[&](const std::vector<stats::entry> &entries) {
+				for (auto &e : entries)
+					if (e.values.transactions != 0)
+						++calls;
+			},
+			std::chrono::milliseconds(1));
+
+		nvobj::transaction::run(pop, [&] { r->a = 6; });
+
+		for (int i = 0; i < 10000 && calls == 0; ++i)
+			std::this_thread::sleep_for(
+				std::chrono::milliseconds(1));
+	}
+
+	UT_ASSERT(calls > 0);
+}
+
+void
+test(int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	UT_ASSERT(stats::enabled());
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "transaction_stats",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	test_run(pop);
+	test_abort(pop);
+	test_site_scope(pop);
+	test_threads(pop);
+	test_periodic_dump(pop);
+
+	pop.close();
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * vector_append.cpp -- tests for segment_vector::append() and append_n()
+ */
+
+#include "list_wrapper.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <list>
+#include <vector>
+
+namespace nvobj = pmem::obj;
+
+using C = container_t<int>;
+
+struct root {
+	nvobj::persistent_ptr<C> v;
+};
+
+static void
+check_sequence(const C &v, size_t first, size_t last, int offset)
+{
+	for (size_t i = first; i < last; ++i)
+		UT_ASSERTeq(v.const_at(i), static_cast<int>(i) + offset);
+}
+
+/*
+ * test_append -- appends ranges spanning many segments, from contiguous
+ * and non-contiguous sources
+ */
+static void
+test_append(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	std::vector<int> values(5000);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = static_cast<int>(i);
+
+	auto it = v.append(values.begin(), values.begin() + 3);
+	UT_ASSERT(it == v.begin());
+	UT_ASSERTeq(v.size(), 3);
+
+	it = v.append(values.data() + 3, values.data() + values.size());
+	UT_ASSERTeq(static_cast<size_t>(it - v.begin()), 3);
+	UT_ASSERTeq(v.size(), values.size());
+	check_sequence(v, 0, values.size(), 0);
+
+	std::list<int> list;
+	for (size_t i = values.size(); i < 6000; ++i)
+		list.push_back(static_cast<int>(i));
+
+	v.append(list.begin(), list.end());
+	UT_ASSERTeq(v.size(), 6000);
+	check_sequence(v, 0, 6000, 0);
+
+	it = v.append(list.begin(), list.begin());
+	UT_ASSERT(it == v.end());
+	UT_ASSERTeq(v.size(), 6000);
+
+	/* insert() at the end appends as well */
+	v.insert(v.cend(), values.begin(), values.begin() + 10);
+	UT_ASSERTeq(v.size(), 6010);
+	check_sequence(v, 6000, 6010, -6000);
+
+	v.clear();
+}
+
+/*
+ * test_append_n -- appends copies of a value, also of an element of the
+ * container itself
+ */
+static void
+test_append_n(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	auto it = v.append_n(3000, 7);
+	UT_ASSERT(it == v.begin());
+	UT_ASSERTeq(v.size(), 3000);
+	for (auto &e : v)
+		UT_ASSERTeq(e, 7);
+
+	v.back() = 8;
+	v.append_n(1000, v.back());
+	UT_ASSERTeq(v.size(), 4000);
+	for (size_t i = 2999; i < 4000; ++i)
+		UT_ASSERTeq(v.const_at(i), 8);
+
+	v.clear();
+}
+
+/*
+ * test_append_txabort -- checks if appended elements and allocated
+ * segments are rolled back on abort
+ */
+static void
+test_append_txabort(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	v.free_data();
+	v.append_n(10, 1);
+	auto capacity = v.capacity();
+
+	std::vector<int> values(3000, 2);
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			v.append(values.begin(), values.end());
+			v.append_n(3000, 3);
+			UT_ASSERTeq(v.size(), 6010);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(v.size(), 10);
+	UT_ASSERTeq(v.capacity(), capacity);
+	for (auto &e : v)
+		UT_ASSERTeq(e, 1);
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "VectorTest: append",
+					     PMEMOBJ_MIN_POOL * 2,
+					     S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(
+			pop, [&] { r->v = nvobj::make_persistent<C>(); });
+
+		test_append(pop);
+		test_append_n(pop);
+		test_append_txabort(pop);
+
+		nvobj::transaction::run(
+			pop, [&] { nvobj::delete_persistent<C>(r->v); });
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -81,6 +81,43 @@ test(nvobj::pool<struct root> &pop)
 	UT_ASSERT(exception_thrown);
 	check_vector(pop, 10, 1);
 
+	/* assign() - range version, large contiguous range */
+	exception_thrown = false;
+	std::vector<int> v3(2048, 3);
+	std::vector<int> v4(1500, 4);
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->v->assign(v3.data(), v3.data() + v3.size());
+			check_vector(pop, 2048, 3);
+			r->v->assign(v4.data(), v4.data() + v4.size());
+			check_vector(pop, 1500, 4);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+	UT_ASSERT(exception_thrown);
+	check_vector(pop, 10, 1);
+
+	/* assign() - range version, large contiguous range, no reallocation */
+	exception_thrown = false;
+	try {
+		r->v->reserve(v3.size());
+		nvobj::transaction::run(pop, [&] {
+			r->v->assign(v3.data(), v3.data() + v3.size());
+			check_vector(pop, 2048, 3);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+	UT_ASSERT(exception_thrown);
+	check_vector(pop, 10, 1);
+
 	/* assign() - initializer list version */
 	exception_thrown = false;
 	try {
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2019-2020, Intel Corporation */
+/* Copyright 2019-2021, Intel Corporation */
 
 #include "helper_classes.hpp"
 #include "list_wrapper.hpp"
@@ -28,6 +28,9 @@ using C5 = container_t<c5>;
 using c6 = move_insertable;
 using C6 = container_t<c6>;
 
+using c7 = trivially_copy_insertable_copy_assignable;
+using C7 = container_t<c7>;
+
 struct root {
 	nvobj::persistent_ptr<C1> v1;
 	nvobj::persistent_ptr<C2> v2;
@@ -35,6 +38,7 @@ struct root {
 	nvobj::persistent_ptr<C4> v4;
 	nvobj::persistent_ptr<C5> v5;
 	nvobj::persistent_ptr<C6> v6;
+	nvobj::persistent_ptr<C7> v7;
 };
 
 #if defined(VECTOR)
@@ -260,6 +264,58 @@ test_move_insertable(nvobj::pool<struct root> &pop)
 	}
 }
 
+#if defined(VECTOR)
+void
+test_trivially_copy_insertable_copy_assignable(nvobj::pool<struct root> &pop)
+{
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(
+			pop, [&] { r->v7 = nvobj::make_persistent<C7>(); });
+
+		std::vector<c7> src = {c7(2), c7(3)};
+
+		{
+			/*
+			 * Test if assign(InputIt, InputIt) uses copy
+			 * assignment operator to replace existing elements.
+			 */
+			r->v7->assign(2, c7(1));
+			r->v7->assign(src.data(), src.data() + src.size());
+			UT_ASSERTeq(r->v7->size(), 2);
+			for (size_t i = 0; i < r->v7->size(); ++i) {
+				UT_ASSERTeq(r->v7->const_at(i).value,
+					    static_cast<int>(i) + 2);
+				UT_ASSERT(r->v7->const_at(i).assigned);
+			}
+		}
+
+		{
+			/*
+			 * Test if insert(const_iterator, InputIt, InputIt)
+			 * uses copy assignment operator to replace existing
+			 * elements.
+			 */
+			r->v7->reserve(4);
+			r->v7->insert(r->v7->cbegin(), src.data(),
+				      src.data() + src.size());
+			UT_ASSERTeq(r->v7->size(), 4);
+			for (size_t i = 0; i < 2; ++i) {
+				UT_ASSERTeq(r->v7->const_at(i).value,
+					    static_cast<int>(i) + 2);
+				UT_ASSERT(r->v7->const_at(i).assigned);
+			}
+		}
+
+		nvobj::transaction::run(
+			pop, [&] { nvobj::delete_persistent<C7>(r->v7); });
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+}
+#endif
+
 static void
 test(int argc, char *argv[])
 {
@@ -278,6 +334,7 @@ test(int argc, char *argv[])
 	test_emplace_constructible_moveable_and_assignable(pop);
 	test_move_assignable(pop);
 	test_copy_insertable(pop);
+	test_trivially_copy_insertable_copy_assignable(pop);
 #endif
 	test_move_insertable(pop);
 
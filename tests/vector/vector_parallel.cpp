@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * vector_parallel.cpp -- tests for segment access and parallel algorithms
+ * of segment_vector
+ */
+
+#include "list_wrapper.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+
+namespace nvobj = pmem::obj;
+
+using C = container_t<int>;
+
+static constexpr size_t SIZE = 10000;
+
+struct root {
+	nvobj::persistent_ptr<C> v;
+	nvobj::persistent_ptr<C> empty;
+};
+
+static long long
+expected_sum(int offset)
+{
+	long long n = static_cast<long long>(SIZE);
+
+	return n * (n - 1) / 2 + offset * n;
+}
+
+static long long
+sum(const C &v, size_t concurrency)
+{
+	return nvobj::parallel_transform_reduce(
+		v, 0LL, std::plus<long long>(),
+		[](const int &e) { return static_cast<long long>(e); },
+		concurrency);
+}
+
+/*
+ * test_segments -- checks if segments hold all elements in order
+ */
+static void
+test_segments(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+	const auto &cv = v;
+
+	UT_ASSERT(v.segment_count() > 1);
+
+	int expected = 0;
+	for (size_t i = 0; i < v.segment_count(); ++i) {
+		auto s = cv.segment(i);
+		UT_ASSERT(s.size() > 0);
+		for (auto &e : s)
+			UT_ASSERTeq(e, expected++);
+	}
+	UT_ASSERTeq(static_cast<size_t>(expected), SIZE);
+
+	bool exception_thrown = false;
+	try {
+		v.csegment(v.segment_count());
+	} catch (std::out_of_range &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+	UT_ASSERT(exception_thrown);
+
+	UT_ASSERTeq(pop.root()->empty->segment_count(), 0);
+}
+
+/*
+ * test_reduce -- checks parallel_transform_reduce with different number
+ * of threads
+ */
+static void
+test_reduce(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	UT_ASSERTeq(sum(v, 1), expected_sum(0));
+	UT_ASSERTeq(sum(v, 4), expected_sum(0));
+	UT_ASSERTeq(sum(v, 0), expected_sum(0));
+
+	auto r = nvobj::parallel_transform_reduce(
+		*pop.root()->empty, 5, std::plus<int>(),
+		[](const int &e) { return e; }, 4);
+	UT_ASSERTeq(r, 5);
+}
+
+/*
+ * test_for_each -- modifies elements in parallel, outside and inside of
+ * a transaction
+ */
+static void
+test_for_each(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	nvobj::parallel_for_each(v, [](int &e) { e += 1; }, 4);
+	UT_ASSERTeq(sum(v, 4), expected_sum(1));
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			nvobj::parallel_for_each(v, [](int &e) { e -= 1; }, 4);
+			UT_ASSERTeq(sum(v, 4), expected_sum(0));
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+	UT_ASSERTeq(sum(v, 4), expected_sum(0));
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			nvobj::parallel_for_each(v, [](int &e) { e = 0; }, 4);
+			UT_ASSERTeq(sum(v, 4), 0);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(sum(v, 4), expected_sum(0));
+
+	std::atomic<size_t> count(0);
+	const auto &cv = v;
+	nvobj::parallel_for_each(cv, [&](const int &) { ++count; }, 4);
+	UT_ASSERTeq(count.load(), SIZE);
+}
+
+/*
+ * test_exception -- checks if exception thrown by a functor is rethrown
+ */
+static void
+test_exception(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+	const auto &cv = v;
+
+	bool exception_thrown = false;
+	try {
+		nvobj::parallel_for_each(
+			cv,
+			[](const int &e) {
+				if (e == static_cast<int>(SIZE) / 2)
+					throw std::runtime_error("element");
+			},
+			4);
+	} catch (std::runtime_error &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+	UT_ASSERT(exception_thrown);
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "VectorTest: parallel",
+					     PMEMOBJ_MIN_POOL * 2,
+					     S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->v = nvobj::make_persistent<C>();
+			r->empty = nvobj::make_persistent<C>();
+			for (size_t i = 0; i < SIZE; ++i)
+				r->v->push_back(static_cast<int>(i));
+		});
+
+		test_segments(pop);
+		test_reduce(pop);
+		test_for_each(pop);
+		test_exception(pop);
+
+		nvobj::transaction::run(pop, [&] {
+			nvobj::delete_persistent<C>(r->v);
+			nvobj::delete_persistent<C>(r->empty);
+		});
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * vector_resize.cpp -- tests for resize() of a vector whose size is below
+ * its capacity
+ */
+
+#include "list_wrapper.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+namespace nvobj = pmem::obj;
+
+using C = container_t<int>;
+
+struct root {
+	nvobj::persistent_ptr<C> v;
+};
+
+/*
+ * test_resize_to_capacity -- resizes the container to its capacity, which
+ * must append elements even though no reallocation is needed
+ */
+static void
+test_resize_to_capacity(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	v.resize(10, 1);
+	v.reserve(100);
+	auto capacity = v.capacity();
+	UT_ASSERT(capacity >= 100);
+
+	v.resize(capacity, 2);
+	UT_ASSERTeq(v.size(), capacity);
+	UT_ASSERTeq(v.capacity(), capacity);
+	for (size_t i = 0; i < 10; ++i)
+		UT_ASSERTeq(v.const_at(i), 1);
+	for (size_t i = 10; i < capacity; ++i)
+		UT_ASSERTeq(v.const_at(i), 2);
+
+	v.resize(10, 3);
+	UT_ASSERTeq(v.size(), 10);
+
+	v.resize(capacity);
+	UT_ASSERTeq(v.size(), capacity);
+	for (size_t i = 10; i < capacity; ++i)
+		UT_ASSERTeq(v.const_at(i), 0);
+
+	v.clear();
+}
+
+/*
+ * test_resize_to_size -- resizing the container to its current size does
+ * not modify it
+ */
+static void
+test_resize_to_size(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	v.resize(10, 1);
+	v.reserve(100);
+	auto capacity = v.capacity();
+
+	v.resize(10, 2);
+	UT_ASSERTeq(v.size(), 10);
+	UT_ASSERTeq(v.capacity(), capacity);
+	for (auto &e : v)
+		UT_ASSERTeq(e, 1);
+
+	v.clear();
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "VectorTest: resize",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(
+			pop, [&] { r->v = nvobj::make_persistent<C>(); });
+
+		test_resize_to_capacity(pop);
+		test_resize_to_size(pop);
+
+		nvobj::transaction::run(
+			pop, [&] { nvobj::delete_persistent<C>(r->v); });
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}
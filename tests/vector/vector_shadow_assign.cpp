@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * vector_shadow_assign.cpp -- tests for segment_vector::shadow_assign()
+ */
+
+#include "list_wrapper.hpp"
+#include "unittest.hpp"
+
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#include <vector>
+
+namespace nvobj = pmem::obj;
+
+using C = container_t<int>;
+
+static constexpr size_t SIZE = 1000;
+
+struct root {
+	nvobj::persistent_ptr<C> v;
+};
+
+static void
+check_range(C &v, size_t first, size_t last, int value)
+{
+	for (size_t i = first; i < last; ++i)
+		UT_ASSERTeq(v.const_at(i), value);
+}
+
+/*
+ * test_shadow_assign -- replaces part of the container, spanning both
+ * partially and fully covered segments, and checks if size, capacity and
+ * remaining elements are left intact
+ */
+static void
+test_shadow_assign(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+	auto capacity = v.capacity();
+
+	std::vector<int> values(900, 2);
+
+	try {
+		v.shadow_assign(3, values.begin(), values.end());
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERTeq(v.size(), SIZE);
+	UT_ASSERTeq(v.capacity(), capacity);
+	check_range(v, 0, 3, 1);
+	check_range(v, 3, 903, 2);
+	check_range(v, 903, SIZE, 1);
+
+	values.assign(SIZE, 1);
+
+	try {
+		v.shadow_assign(0, values.data(), values.data() + SIZE);
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	check_range(v, 0, SIZE, 1);
+}
+
+/*
+ * test_shadow_assign_txabort -- checks if replaced segments are restored
+ * when transaction aborts
+ */
+static void
+test_shadow_assign_txabort(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	std::vector<int> values(SIZE, 3);
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::run(pop, [&] {
+			v.shadow_assign(0, values.begin(), values.end());
+			check_range(v, 0, SIZE, 3);
+
+			v.shadow_assign(1, values.begin(), values.end() - 2);
+			check_range(v, 0, SIZE, 3);
+
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (pmem::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(v.size(), SIZE);
+	check_range(v, 0, SIZE, 1);
+}
+
+/*
+ * test_shadow_assign_out_of_range -- checks if replacing elements outside
+ * of the container throws
+ */
+static void
+test_shadow_assign_out_of_range(nvobj::pool<struct root> &pop)
+{
+	auto &v = *pop.root()->v;
+
+	std::vector<int> values(2, 4);
+
+	bool exception_thrown = false;
+	try {
+		v.shadow_assign(SIZE - 1, values.begin(), values.end());
+	} catch (std::out_of_range &) {
+		exception_thrown = true;
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	UT_ASSERT(exception_thrown);
+	check_range(v, 0, SIZE, 1);
+}
+
+static void
+test(int argc, char *argv[])
+{
+	if (argc < 2) {
+		UT_FATAL("usage: %s file-name", argv[0]);
+	}
+
+	auto path = argv[1];
+	auto pop = nvobj::pool<root>::create(path, "VectorTest: shadow_assign",
+					     PMEMOBJ_MIN_POOL,
+					     S_IWUSR | S_IRUSR);
+
+	auto r = pop.root();
+
+	try {
+		nvobj::transaction::run(pop, [&] {
+			r->v = nvobj::make_persistent<C>(SIZE, 1);
+		});
+
+		test_shadow_assign(pop);
+		test_shadow_assign_txabort(pop);
+		test_shadow_assign_out_of_range(pop);
+
+		nvobj::transaction::run(
+			pop, [&] { nvobj::delete_persistent<C>(r->v); });
+	} catch (std::exception &e) {
+		UT_FATALexc(e);
+	}
+
+	pop.close();
+}
+
+int
+main(int argc, char *argv[])
+{
+	return run_test([&] { test(argc, argv); });
+}